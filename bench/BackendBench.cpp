@@ -0,0 +1,41 @@
+#include "Bench.h"
+
+#include "CPUBackend.h"
+#include "JobSystem.h"
+
+using namespace VoxelDataStructs;
+
+void Bench::runBackend(const Options& options)
+{
+    JobSystem jobs(options.threads);
+
+    World world = makeWorld(options, jobs);
+
+    // Same calls as the App frame loop, without window nor GPU
+    CPUBackend backend(world);
+    backend.renderer.jobSystem = &jobs;
+    backend.init(nullptr, options.quick ? 320 : 1024, options.quick ? 180 : 576);
+
+    const uint32_t frameCount = options.quick ? 16 : 120;
+
+    // Reused pixels only trace a validation segment, they are not counted as rays
+    uint64_t pixels = 0, rays = 0, steps = 0;
+    const auto start = Clock::now();
+    for(uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        backend.frame(orbitCamera(world, frame));
+        const CPURenderer::FrameStats& stats = backend.renderer.stats;
+        pixels += stats.pixelCount;
+        rays += stats.tracedPixels;
+        steps += stats.traversalSteps - stats.validationSteps;
+    }
+    const double seconds = secondsSince(start);
+    backend.flush();
+
+    report("backend", "cpu.frame", seconds * 1e3 / frameCount, "ms");
+    report("backend", "cpu.pixels", (double)pixels / seconds * 1e-6, "Mpix/s");
+    report("backend", "cpu.rays", (double)rays / seconds * 1e-6, "Mrays/s");
+    report("backend", "cpu.steps", rays ? (double)steps / (double)rays : 0.0, "steps/ray");
+    report("backend", "cpu.presented", (double)backend.presentedFrameCount, "frames");
+    reportMemory("backend");
+}
@@ -0,0 +1,267 @@
+#include "Bench.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CPURenderer.h"
+#include "CameraPath.h"
+#include "ImageIO.h"
+#include "JobSystem.h"
+
+using namespace Bench;
+using namespace VoxelDataStructs;
+
+// Renders a list of views of one world to images through the CPU renderer, for thumbnails and regression
+// images. The world is generated once, then the views are spread over the job system: a few of them render
+// at the same time, each splitting its tiles across the same workers.
+namespace
+{
+    struct View
+    {
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        CameraView camera;
+    };
+
+    struct BatchOptions
+    {
+        std::string viewsFile;
+        std::string pathFile;
+        std::filesystem::path outDir = "renders";
+        int32_t chunks[3] = {4, 2, 4};
+        uint32_t seed = 1;
+        // Job system workers, 0 is hardware_concurrency - 1
+        uint32_t threads = 0;
+        // Views rendered at the same time, each owning one renderer. 0 is one per thread
+        uint32_t concurrentViews = 0;
+        // Resolution of the views coming from --path or --orbit
+        uint32_t width = 640;
+        uint32_t height = 360;
+        // Every stride-th tick of --path
+        uint32_t stride = 1;
+        uint32_t orbitViews = 0;
+    };
+
+    void printUsage()
+    {
+        std::printf("Usage: RayVox_BatchRender (--views views.txt | --path file.rvcp | --orbit N) [--out-dir renders]\n"
+                    "                          [--resolution 640x360] [--stride N] [--chunks 4x2x4] [--seed S]\n"
+                    "                          [--threads N] [--concurrent-views N]\n"
+                    "A views file has one view per line, '#' starts a comment:\n"
+                    "  name width height pos.x pos.y pos.z forward.x forward.y forward.z [fov]\n"
+                    "Names are unique and contain no '/', '\\' or ':'. Images are written to <out-dir>/<name>.ppm.\n");
+    }
+
+    bool loadViews(const std::string& fileName, std::vector<View>& views)
+    {
+        std::ifstream in(fileName);
+        if (!in)
+            return false;
+
+        std::string line;
+        uint32_t lineNumber = 0;
+        std::set<std::string> names;
+        while (std::getline(in, line))
+        {
+            ++lineNumber;
+            line = line.substr(0, line.find('#'));
+            std::istringstream fields(line);
+            View view;
+            float3 pos;
+            float3 forward;
+            float fov = 80;
+            if (!(fields >> view.name))
+                continue;
+            if (!(fields >> view.width >> view.height >> pos.x >> pos.y >> pos.z >> forward.x >> forward.y >> forward.z) ||
+                view.width == 0 || view.height == 0 || dot(forward, forward) == 0)
+            {
+                std::fprintf(stderr, "%s:%u: expected name width height pos.x pos.y pos.z forward.x forward.y forward.z [fov]\n",
+                             fileName.c_str(), lineNumber);
+                return false;
+            }
+            // Names become file names in --out-dir, keep them there and one image per view
+            if (view.name.find_first_of("/\\:") != std::string::npos || view.name == "." || view.name == "..")
+            {
+                std::fprintf(stderr, "%s:%u: view name '%s' must not be a path\n", fileName.c_str(), lineNumber, view.name.c_str());
+                return false;
+            }
+            if (!names.insert(view.name).second)
+            {
+                std::fprintf(stderr, "%s:%u: duplicate view name '%s'\n", fileName.c_str(), lineNumber, view.name.c_str());
+                return false;
+            }
+            fields >> fov;
+            view.camera = lookAlong(pos, forward, fov);
+            views.push_back(view);
+        }
+        return true;
+    }
+
+    void pathViews(const CameraPath& path, const BatchOptions& options, std::vector<View>& views)
+    {
+        for(uint32_t tick = 0; tick < path.tickCount(); tick += options.stride)
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "tick_%05u", tick);
+            views.push_back({name, options.width, options.height, path.view(tick)});
+        }
+    }
+
+    // Same orbit as RayVox_FrameBench, spread over a full turn
+    void orbitViews(const World& world, const BatchOptions& options, std::vector<View>& views)
+    {
+        for(uint32_t i = 0; i < options.orbitViews; ++i)
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "orbit_%04u", i);
+            const float angle = 6.2831853f * (float)i / (float)options.orbitViews;
+            views.push_back({name, options.width, options.height, orbitCameraAt(world, angle)});
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BatchOptions options;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (!std::strcmp(argv[i], "--views") && hasValue)
+            options.viewsFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--path") && hasValue)
+            options.pathFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--orbit") && hasValue)
+            valid = std::sscanf(argv[++i], "%u", &options.orbitViews) == 1 && options.orbitViews > 0;
+        else if (!std::strcmp(argv[i], "--out-dir") && hasValue)
+            options.outDir = argv[++i];
+        else if (!std::strcmp(argv[i], "--resolution") && hasValue)
+            valid = std::sscanf(argv[++i], "%ux%u", &options.width, &options.height) == 2 && options.width > 0 && options.height > 0;
+        else if (!std::strcmp(argv[i], "--stride") && hasValue)
+            valid = std::sscanf(argv[++i], "%u", &options.stride) == 1 && options.stride > 0;
+        else if (!std::strcmp(argv[i], "--chunks") && hasValue)
+            valid = std::sscanf(argv[++i], "%dx%dx%d", &options.chunks[0], &options.chunks[1], &options.chunks[2]) == 3 &&
+                    options.chunks[0] > 0 && options.chunks[1] > 0 && options.chunks[2] > 0;
+        else if (!std::strcmp(argv[i], "--seed") && hasValue)
+            valid = std::sscanf(argv[++i], "%u", &options.seed) == 1;
+        else if (!std::strcmp(argv[i], "--threads") && hasValue)
+            valid = std::sscanf(argv[++i], "%u", &options.threads) == 1;
+        else if (!std::strcmp(argv[i], "--concurrent-views") && hasValue)
+            valid = std::sscanf(argv[++i], "%u", &options.concurrentViews) == 1;
+        else if (!std::strcmp(argv[i], "--help"))
+        {
+            printUsage();
+            return 0;
+        }
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    const int sources = !options.viewsFile.empty() + !options.pathFile.empty() + (options.orbitViews > 0);
+    if (sources != 1)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<View> views;
+    if (!options.viewsFile.empty() && !loadViews(options.viewsFile, views))
+    {
+        std::fprintf(stderr, "Failed to read views from %s\n", options.viewsFile.c_str());
+        return 1;
+    }
+    if (!options.pathFile.empty())
+    {
+        CameraPath path;
+        if (!path.load(options.pathFile))
+        {
+            std::fprintf(stderr, "Failed to load camera path %s\n", options.pathFile.c_str());
+            return 1;
+        }
+        pathViews(path, options, views);
+    }
+    // --orbit views are added once the world is built, they cannot be empty
+    if (views.empty() && !options.orbitViews)
+    {
+        std::fprintf(stderr, "No view to render\n");
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.outDir, error);
+    if (error)
+    {
+        std::fprintf(stderr, "Failed to create %s\n", options.outDir.string().c_str());
+        return 1;
+    }
+
+    // The expensive part, paid once for every view and only once every input was read
+    JobSystem jobs(options.threads);
+    const auto buildStart = Clock::now();
+    World world;
+    world.init(options.chunks[0], options.chunks[1], options.chunks[2]);
+    generateTerrain(world, options.seed, &jobs);
+    const double buildSeconds = secondsSince(buildStart);
+
+    // Orbit views only depend on the size of the world
+    if (options.orbitViews)
+        orbitViews(world, options, views);
+
+    // Each slot owns a renderer and keeps taking the next view, so buffers are only reallocated on a resolution
+    // change. Slots waiting on their tiles run the tiles of the other slots, which keeps every worker busy even
+    // when fewer views than threads are left.
+    const uint32_t slotCount = std::min<uint32_t>(options.concurrentViews ? options.concurrentViews : jobs.workerCount() + 1,
+                                                  (uint32_t)views.size());
+    std::atomic<uint32_t> nextView{0};
+    std::atomic<uint32_t> failures{0};
+    std::atomic<uint64_t> pixels{0};
+
+    const auto renderStart = Clock::now();
+    jobs.parallelFor(slotCount, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for(uint32_t slot = begin; slot < end; ++slot)
+        {
+            CPURenderer renderer;
+            renderer.jobSystem = &jobs;
+            // Views are unrelated, no history to reuse
+            renderer.useTemporalReprojection = false;
+
+            for(uint32_t v = nextView++; v < views.size(); v = nextView++)
+            {
+                const View& view = views[v];
+                renderer.resize(view.width, view.height);
+                renderer.render(world, view.camera);
+                pixels += uint64_t(view.width) * view.height;
+
+                const std::filesystem::path fileName = options.outDir / (view.name + ".ppm");
+                if (!writePPM(fileName, view.width, view.height, renderer.framebuffer))
+                {
+                    std::fprintf(stderr, "Failed to write %s\n", fileName.string().c_str());
+                    ++failures;
+                }
+            }
+        }
+    });
+    const double renderSeconds = secondsSince(renderStart);
+
+    std::printf("World built in %.3f s, %zu views rendered in %.3f s by %u slots on %u threads\n", buildSeconds, views.size(),
+                renderSeconds, slotCount, jobs.workerCount() + 1);
+    std::printf("%.2f views/s, %.2f Mpixels/s, %.3f s per view with the world build amortized\n",
+                (double)views.size() / renderSeconds, (double)pixels / renderSeconds * 1e-6,
+                (buildSeconds + renderSeconds) / (double)views.size());
+    return failures ? 1 : 0;
+}
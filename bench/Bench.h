@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "CPURaytracer.h"
+#include "MemoryTracker.h"
+#include "VoxelDataStructs.h"
+
+class JobSystem;
+
+// Shared helpers of the RayVox_Bench suites. Every result is printed as one
+// "suite.name value unit" line so runs can be diffed or grepped.
+namespace Bench
+{
+    struct Options
+    {
+        // 0 lets the job system pick hardware_concurrency - 1 workers
+        uint32_t threads = 0;
+        uint32_t seed = 1;
+        // Smaller problem sizes, for a quick sanity run
+        bool quick = false;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    inline double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    inline void report(const char* suite, const char* name, double value, const char* unit)
+    {
+        std::printf("%-8s %-40s %14.3f %s\n", suite, name, value, unit);
+    }
+
+    // Current and peak bytes of every memory tag, as "memory.<tag>.current" and "memory.<tag>.peak" in MB.
+    inline void reportMemory(const char* suite)
+    {
+        for(uint32_t tag = 0; tag < (uint32_t)MemoryTag::Count; ++tag)
+        {
+            const MemoryTracker::TagStats stats = MemoryTracker::stats((MemoryTag)tag);
+            char name[64];
+            std::snprintf(name, sizeof(name), "memory.%s.current", MemoryTracker::tagName((MemoryTag)tag));
+            report(suite, name, (double)stats.currentBytes / (1024.0 * 1024.0), "MB");
+            std::snprintf(name, sizeof(name), "memory.%s.peak", MemoryTracker::tagName((MemoryTag)tag));
+            report(suite, name, (double)stats.peakBytes / (1024.0 * 1024.0), "MB");
+        }
+    }
+
+    // Terrain most suites run on: 2x1x2 chunks with quick, 4x2x4 otherwise.
+    inline VoxelDataStructs::World makeWorld(const Options& options, JobSystem& jobs)
+    {
+        VoxelDataStructs::World world;
+        if (options.quick)
+            world.init(2, 1, 2);
+        else
+            world.init(4, 2, 4);
+        VoxelDataStructs::generateTerrain(world, options.seed, &jobs);
+        return world;
+    }
+
+    // Camera at pos looking along forward with a horizontal right vector, any one when looking straight up or down.
+    inline CameraView lookAlong(const float3& pos, const float3& forward, float fov = 80)
+    {
+        CameraView camera{};
+        camera.pos = pos;
+        camera.forward = normalize(forward);
+        const float3 side = cross(float3(0, 1, 0), camera.forward);
+        camera.right = dot(side, side) > 1e-6f ? normalize(side) : float3(1, 0, 0);
+        camera.fov = fov;
+        camera.Znear = 0.1f;
+        camera.Zfar = 1000;
+        return camera;
+    }
+
+    // On a circle above the world, looking down at its centre.
+    inline CameraView orbitCameraAt(const VoxelDataStructs::World& world, float angle)
+    {
+        const float3 center((float)world.sizeInVoxels(0) * 0.5f, (float)world.sizeInVoxels(1) * 0.3f, (float)world.sizeInVoxels(2) * 0.5f);
+        const float radius = (float)world.sizeInVoxels(0) * 0.6f;
+        const float3 pos = center + float3(std::cos(angle) * radius, (float)world.sizeInVoxels(1) * 0.5f, std::sin(angle) * radius);
+        return lookAlong(pos, center - pos);
+    }
+
+    // Slow orbit, a few degrees per tick like a camera driven by the mouse.
+    inline CameraView orbitCamera(const VoxelDataStructs::World& world, uint32_t tick)
+    {
+        return orbitCameraAt(world, (float)tick * 0.02f);
+    }
+
+    void runSDF(const Options& options);
+    void runRays(const Options& options);
+    void runBackend(const Options& options);
+    void runFramePacing(const Options& options);
+    void runUploadRing(const Options& options);
+    void runDescriptors(const Options& options);
+    void runShaderCache(const Options& options);
+    void runKernels(const Options& options);
+    void runDelta(const Options& options);
+    void runResidency(const Options& options);
+    void runInput(const Options& options);
+    void runLoop(const Options& options);
+    void runCameraPath(const Options& options);
+    void runProfiler(const Options& options);
+    void runPrimitives(const Options& options);
+    void runMemory(const Options& options);
+    void runHeatmap(const Options& options);
+}
@@ -0,0 +1,116 @@
+#include "Bench.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+#include "CPUBackend.h"
+#include "CameraPath.h"
+#include "EngineLoop.h"
+#include "JobSystem.h"
+
+using namespace Bench;
+using namespace VoxelDataStructs;
+
+namespace
+{
+    struct ReplayResult
+    {
+        uint64_t frameHash = 0xcbf29ce484222325ull;
+        uint64_t frames = 0;
+        double seconds = 0;
+    };
+
+    // Plays the path through the engine loop in lockstep and hashes every presented frame.
+    // jitterMs adds a random delay to each frame, which must not change what is rendered.
+    ReplayResult replay(const CameraPath& path, CPUBackend& backend, double jitterMs, uint32_t seed)
+    {
+        ReplayResult result;
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> jitter(0.0, jitterMs);
+        uint32_t tick = 0;
+
+        EngineLoop loop(60.0, [&](double) { ++tick; },
+                        [&](FrameSnapshot& snapshot) { snapshot.camera = path.view(tick - 1); },
+                        [&](const FrameSnapshot& snapshot)
+                        {
+                            // stop() may let the loop run a tick past the end
+                            if (snapshot.tick > path.tickCount())
+                                return;
+                            if (jitterMs > 0)
+                                std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(jitter(rng)));
+                            backend.frame(snapshot.camera);
+                            for (uint32_t pixel : backend.presentedFrame)
+                            {
+                                result.frameHash ^= pixel;
+                                result.frameHash *= 0x100000001b3ull;
+                            }
+                            ++result.frames;
+                        });
+        loop.lockstep = true;
+
+        const auto start = Clock::now();
+        loop.start();
+        while (loop.stats().frames < path.tickCount())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        loop.stop();
+        result.seconds = secondsSince(start);
+        return result;
+    }
+}
+
+void Bench::runCameraPath(const Options& options)
+{
+    JobSystem jobs(options.threads);
+
+    World world = makeWorld(options, jobs);
+
+    // Orbit like BackendBench, recorded one pose per tick
+    const uint32_t tickCount = options.quick ? 24 : 240;
+
+    CameraPath recorded;
+    for (uint32_t tick = 0; tick < tickCount; ++tick)
+        recorded.record(orbitCamera(world, tick));
+
+    // File round trip is bit exact
+    const std::filesystem::path file = std::filesystem::temp_directory_path() / "rayvox_bench_path.rvcp";
+    CameraPath path;
+    bool ok = recorded.save(file) && path.load(file) && path.tickCount() == tickCount;
+    for (uint32_t tick = 0; ok && tick < tickCount; ++tick)
+        ok = std::memcmp(&path.poses[tick], &recorded.poses[tick], sizeof(CameraPath::Pose)) == 0;
+    ok &= path.fov == 80 && path.Zfar == 1000 && std::filesystem::file_size(file) == path.fileBytes();
+    // Truncated, or a tick count larger than the file, fails without touching the path
+    std::filesystem::resize_file(file, path.fileBytes() - 1);
+    ok &= !path.load(file) && path.tickCount() == tickCount;
+    {
+        std::fstream corrupt(file, std::ios::binary | std::ios::in | std::ios::out);
+        const uint32_t hugeCount = 0xFFFFFFF0u;
+        corrupt.seekp(8);
+        corrupt.write(reinterpret_cast<const char*>(&hugeCount), sizeof(hugeCount));
+    }
+    ok &= !path.load(file) && path.tickCount() == tickCount;
+    std::filesystem::remove(file);
+    ok &= !path.load(file) && path.tickCount() == tickCount;
+    report("path", "file.check", ok ? 1.0 : 0.0, "ok");
+    report("path", "file.size", (double)path.fileBytes() / tickCount, "bytes/tick");
+
+    // Two replays with different frame timings render the same frames, every tick shown once
+    const uint32_t width = options.quick ? 160 : 640;
+    const uint32_t height = options.quick ? 90 : 360;
+    ReplayResult results[2];
+    for (uint32_t run = 0; run < 2; ++run)
+    {
+        CPUBackend backend(world);
+        backend.renderer.jobSystem = &jobs;
+        backend.init(nullptr, width, height);
+        results[run] = replay(path, backend, run == 0 ? 0.0 : 4.0, options.seed + run);
+    }
+    const bool deterministic = results[0].frameHash == results[1].frameHash &&
+                               results[0].frames == tickCount && results[1].frames == tickCount;
+    report("path", "replay.check", deterministic ? 1.0 : 0.0, "ok");
+    report("path", "replay.frame", results[0].seconds * 1e3 / tickCount, "ms");
+    report("path", "replay.frames", (double)results[0].frames, "frames");
+}
@@ -0,0 +1,86 @@
+#include "Bench.h"
+
+#include <random>
+#include <vector>
+
+#include "DeltaPacker.h"
+#include "JobSystem.h"
+
+using namespace VoxelDataStructs;
+using namespace Bench;
+
+void Bench::runDelta(const Options& options)
+{
+    JobSystem jobs(options.threads);
+
+    World world = makeWorld(options, jobs);
+
+    std::vector<uint8_t> stagingMemory(8 * 1024 * 1024);
+    ManualTimeline timeline;
+    UploadRing staging(stagingMemory.data(), stagingMemory.size(), timeline);
+    DeltaPacker packer;
+    std::vector<DeltaPacker::CopyRange> copies;
+
+    // Initial upload, every chunk once, spread over frames by the budget
+    for(uint32_t c = 0; c < world.chunks.size(); ++c)
+        packer.markChunk(c);
+    uint32_t initialFrames = 0;
+    while (packer.hasDirtyRanges())
+    {
+        packer.pack(world, staging, copies);
+        staging.finishFrame(timeline.signal());
+        timeline.complete(timeline.signaled);
+        ++initialFrames;
+    }
+    report("delta", "initial.frames", initialFrames, "frames");
+
+    // Gameplay edits: a digging brush and a few scattered block placements every frame
+    std::mt19937 gen(options.seed);
+    std::uniform_int_distribution<int32_t> px(0, world.sizeInVoxels(0) - 1);
+    std::uniform_int_distribution<int32_t> py(0, world.sizeInVoxels(1) - 1);
+    std::uniform_int_distribution<int32_t> pz(0, world.sizeInVoxels(2) - 1);
+    constexpr int32_t brushRadius = 4;
+
+    const uint32_t frameCount = options.quick ? 60 : 600;
+    uint64_t payload = 0, chunkUpload = 0, copyCount = 0, marked = 0;
+    double packSeconds = 0;
+    for(uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        const int32_t cx = px(gen), cy = py(gen), cz = pz(gen);
+        for(int32_t z = -brushRadius; z <= brushRadius; ++z)
+            for(int32_t y = -brushRadius; y <= brushRadius; ++y)
+                for(int32_t x = -brushRadius; x <= brushRadius; ++x)
+                {
+                    if (x * x + y * y + z * z > brushRadius * brushRadius)
+                        continue;
+                    world.setVoxel(cx + x, cy + y, cz + z, 0);
+                    packer.markVoxel(world, cx + x, cy + y, cz + z);
+                }
+        for(int i = 0; i < 8; ++i)
+        {
+            const int32_t x = px(gen), y = py(gen), z = pz(gen);
+            world.setVoxel(x, y, z, 0xFF3366CCu);
+            packer.markVoxel(world, x, y, z);
+        }
+
+        const auto start = Clock::now();
+        packer.pack(world, staging, copies);
+        packSeconds += secondsSince(start);
+        staging.finishFrame(timeline.signal());
+        timeline.complete(timeline.signaled);
+
+        const DeltaPacker::FrameStats& stats = packer.lastFrame();
+        payload += stats.payloadBytes;
+        chunkUpload += stats.chunkUploadBytes;
+        copyCount += stats.copies;
+        marked += stats.markedRanges;
+    }
+
+    report("delta", "pack", packSeconds * 1e6 / frameCount, "us/frame");
+    report("delta", "marked", (double)marked / frameCount, "ranges/frame");
+    report("delta", "copies", (double)copyCount / frameCount, "copies/frame");
+    report("delta", "payload", (double)payload / frameCount / 1024.0, "KiB/frame");
+    report("delta", "chunk.reupload", (double)chunkUpload / frameCount / 1024.0, "KiB/frame");
+    report("delta", "world.reupload", (double)packer.lastFrame().worldUploadBytes / 1024.0, "KiB/frame");
+    report("delta", "saving", (double)chunkUpload / (double)std::max<uint64_t>(payload, 1), "x chunk re-upload");
+}
@@ -0,0 +1,104 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "DescriptorAllocator.h"
+#include "FrameScheduler.h"
+#include "SimulatedGpuQueue.h"
+
+namespace
+{
+    using Range = DescriptorAllocator::Range;
+}
+
+void Bench::runDescriptors(const Options& options)
+{
+    // Chunk SRVs streamed in and out with random lifetimes, plus a couple of descriptor tables every frame
+    SimulatedGpuQueue queue;
+    FrameScheduler scheduler(queue, 3);
+    DescriptorAllocator allocator(1024, 1024, queue);
+
+    struct Live
+    {
+        Range range;
+        uint32_t expires;
+    };
+    std::vector<Live> live;
+
+    std::mt19937 gen(options.seed);
+    std::uniform_int_distribution<uint32_t> lifetime(1, 120);
+    std::uniform_int_distribution<uint32_t> rangeSize(1, 4);
+    std::uniform_int_distribution<uint32_t> streamed(0, 16);
+    std::uniform_int_distribution<uint32_t> tableSize(8, 64);
+
+    const uint32_t frameCount = options.quick ? 200 : 2000;
+    uint64_t operations = 0;
+    uint32_t grows = 0;
+    float peakFragmentation = 0;
+    double fragmentationSum = 0;
+    double allocSeconds = 0;
+    for(uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        scheduler.beginFrame();
+        const auto allocStart = Clock::now();
+
+        for(size_t i = 0; i < live.size();)
+        {
+            if (live[i].expires == frame)
+            {
+                allocator.release(live[i].range);
+                live[i] = live.back();
+                live.pop_back();
+                ++operations;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        const uint32_t count = streamed(gen);
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t size = rangeSize(gen);
+            Range range = allocator.allocate(size);
+            if (!range)
+            {
+                allocator.grow(allocator.persistentCapacity() * 2);
+                range = allocator.allocate(size);
+                ++grows;
+            }
+            live.push_back({range, frame + lifetime(gen)});
+            ++operations;
+        }
+
+        for(int table = 0; table < 2; ++table)
+        {
+            allocator.allocateTransient(tableSize(gen));
+            ++operations;
+        }
+        allocSeconds += secondsSince(allocStart);
+
+        const float fragmentation = allocator.fragmentation();
+        peakFragmentation = std::max(peakFragmentation, fragmentation);
+        fragmentationSum += fragmentation;
+
+        queue.submit(std::chrono::microseconds(200));
+        allocator.finishFrame(scheduler.endFrame());
+    }
+    scheduler.waitIdle();
+
+    const DescriptorAllocator::Stats stats = allocator.stats();
+    report("desc", "op", allocSeconds * 1e9 / (double)operations, "ns/op");
+    report("desc", "persistent.used", (double)stats.persistentUsed, "descriptors");
+    report("desc", "persistent.capacity", (double)allocator.persistentCapacity(), "descriptors");
+    report("desc", "grows", (double)grows, "times");
+    report("desc", "fragmentation.mean", fragmentationSum / frameCount, "ratio");
+    report("desc", "fragmentation.peak", (double)peakFragmentation, "ratio");
+    report("desc", "free.blocks", (double)stats.freeBlocks, "blocks");
+    report("desc", "transient.peak", (double)stats.transientPeak, "descriptors");
+    report("desc", "stalls", (double)stats.stalls, "allocations");
+    report("desc", "failures", (double)stats.failures, "allocations");
+}
@@ -0,0 +1,559 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "CPURenderer.h"
+#include "CameraPath.h"
+#include "ImageIO.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+using namespace Bench;
+using namespace VoxelDataStructs;
+
+// Replays a camera path through the CPU renderer for every resolution and thread count asked, and writes
+// the results as JSON. Meant to run unattended, from a script or CI, to compare two builds.
+namespace
+{
+    struct Resolution
+    {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct FrameBenchOptions
+    {
+        std::string pathFile;
+        std::string outFile;
+        // Chrome trace of the profiler zones of the whole run
+        std::string traceFile;
+        int32_t chunks[3] = {4, 2, 4};
+        uint32_t seed = 1;
+        std::vector<Resolution> resolutions;
+        // Job system workers, 0 is hardware_concurrency - 1 like RayVox_Bench --threads
+        std::vector<uint32_t> threads;
+        // Renders of the first pose before timing, history is reset afterwards
+        uint32_t warmupFrames = 2;
+        // 0 replays the whole path
+        uint32_t maxFrames = 0;
+        // Every run is measured this many times, the repeats of all runs interleaved so drift hits them alike
+        uint32_t repeat = 1;
+        bool temporalReprojection = true;
+        CPURenderer::SamplingMode sampling = CPURenderer::SamplingMode::Full;
+        // Diffs every frame against a full rate render without history, timings include that render
+        bool reference = false;
+        // Fails the run when its PSNR against the reference is lower, 0 disables the check
+        double minPsnr = 0;
+        bool quick = false;
+        // Per pixel cost histograms, timings include the measurement overhead
+        CPURenderer::CostView costView = CPURenderer::CostView::None;
+        // Last frame of each run as <prefix>_<run>.f32 (raw costs, row major) and <prefix>_<run>.ppm (heatmap)
+        std::string heatmapPrefix;
+    };
+
+    struct RunResult
+    {
+        Resolution resolution;
+        uint32_t threads;
+        std::vector<double> frameMs;
+        // Pixels written, full traces, validation segments around reprojected hits, and the steps of each kind
+        uint64_t pixels = 0;
+        uint64_t tracedRays = 0;
+        uint64_t segments = 0;
+        uint64_t tracedSteps = 0;
+        uint64_t segmentSteps = 0;
+        double reusedPercent = 0;
+        double seconds = 0;
+        size_t rendererBytes = 0;
+        // Whole process, highest so far: runs are in order of the command line, each repeat after the first
+        // sees the peak of the largest run
+        uint64_t peakResidentBytes = 0;
+        // Tracked bytes per tag at the end of the run, peaks over the run
+        MemoryTracker::TagStats tags[(size_t)MemoryTag::Count];
+        // Summed over the frames, percentiles are the mean of the per frame ones
+        CostHistogram cost;
+        // Against the reference: mean over the frames, worst frame for the PSNR and channel error
+        double mse = 0;
+        double worstFramePsnr = std::numeric_limits<double>::infinity();
+        double differingPercent = 0;
+        uint32_t maxChannelError = 0;
+
+        // Of the mean squared error, infinite when every frame matched the reference
+        double psnr() const { return mse > 0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity(); }
+    };
+
+    void printUsage()
+    {
+        std::printf("Usage: RayVox_FrameBench [--path file.rvcp] [--out results.json] [--resolutions 1280x720,1920x1080]\n"
+                    "                         [--threads 0,3,7] [--chunks 4x2x4] [--seed S] [--frames N] [--warmup N]\n"
+                    "                         [--no-reprojection] [--sampling full|checkerboard|interleaved4]\n"
+                    "                         [--reference] [--min-psnr dB] [--cost steps|time] [--heatmap prefix]\n"
+                    "                         [--trace trace.json] [--repeat N] [--quick]\n"
+                    "Without --path an orbit around the world is replayed, without --out the JSON goes to stdout.\n"
+                    "--repeat writes every run N times under the same name, the samples RayVox_PerfGate needs\n"
+                    "for its median and MAD.\n"
+                    "--reference diffs every frame against a full rate render without history (timings include it),\n"
+                    "--min-psnr implies it and exits with 1 when a run is below that PSNR.\n");
+    }
+
+    template <typename T, typename Parse>
+    bool parseList(const char* text, std::vector<T>& values, Parse parse)
+    {
+        values.clear();
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            T value;
+            if (!parse(item, value))
+                return false;
+            values.push_back(value);
+        }
+        return !values.empty();
+    }
+
+    bool parseResolution(const std::string& text, Resolution& resolution)
+    {
+        return std::sscanf(text.c_str(), "%ux%u", &resolution.width, &resolution.height) == 2 &&
+               resolution.width > 0 && resolution.height > 0;
+    }
+
+    bool parseCount(const std::string& text, uint32_t& value)
+    {
+        char* end = nullptr;
+        value = (uint32_t)std::strtoul(text.c_str(), &end, 10);
+        return end && *end == 0 && end != text.c_str();
+    }
+
+    // Same orbit as the backend suite, one pose per tick
+    CameraPath orbitPath(const World& world, uint32_t tickCount)
+    {
+        CameraPath path;
+        for(uint32_t tick = 0; tick < tickCount; ++tick)
+            path.record(orbitCamera(world, tick));
+        return path;
+    }
+
+    uint64_t queryPeakResidentBytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize;
+        return 0;
+#else
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#if defined(__APPLE__)
+        return (uint64_t)usage.ru_maxrss;
+#else
+        return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+    }
+
+    bool parseCostView(const std::string& text, CPURenderer::CostView& view)
+    {
+        if (text == "steps")
+            view = CPURenderer::CostView::TraversalSteps;
+        else if (text == "time")
+            view = CPURenderer::CostView::Time;
+        else
+            return false;
+        return true;
+    }
+
+    bool parseSampling(const std::string& text, CPURenderer::SamplingMode& mode)
+    {
+        if (text == "full")
+            mode = CPURenderer::SamplingMode::Full;
+        else if (text == "checkerboard")
+            mode = CPURenderer::SamplingMode::Checkerboard;
+        else if (text == "interleaved4")
+            mode = CPURenderer::SamplingMode::Interleaved4;
+        else
+            return false;
+        return true;
+    }
+
+    const char* samplingName(CPURenderer::SamplingMode mode)
+    {
+        switch(mode)
+        {
+            case CPURenderer::SamplingMode::Checkerboard: return "checkerboard";
+            case CPURenderer::SamplingMode::Interleaved4: return "interleaved4";
+            default: return "full";
+        }
+    }
+
+    // JSON has no infinity, an exact match is written as null
+    std::string jsonNumber(double value)
+    {
+        if (!std::isfinite(value))
+            return "null";
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.4f", value);
+        return text;
+    }
+
+    const char* costViewName(CPURenderer::CostView view)
+    {
+        switch(view)
+        {
+            case CPURenderer::CostView::TraversalSteps: return "steps";
+            case CPURenderer::CostView::Time: return "time";
+            default: return "none";
+        }
+    }
+
+    std::string runName(const RunResult& r)
+    {
+        return std::to_string(r.resolution.width) + "x" + std::to_string(r.resolution.height) + "_t" + std::to_string(r.threads);
+    }
+
+    bool writeHeatmap(const std::string& prefix, const RunResult& result, const CPURenderer& renderer)
+    {
+        const std::string name = prefix + "_" + runName(result);
+        std::ofstream raw(name + ".f32", std::ios::binary | std::ios::trunc);
+        raw.write(reinterpret_cast<const char*>(renderer.costBuffer.data()), std::streamsize(renderer.costBuffer.size() * sizeof(float)));
+
+        return raw.good() && writePPM(name + ".ppm", renderer.width, renderer.height, renderer.framebuffer);
+    }
+
+    // Nearest rank on sorted values
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+        const size_t rank = (size_t)std::ceil(p / 100.0 * (double)sorted.size());
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    RunResult runOne(const World& world, const CameraPath& path, const FrameBenchOptions& options,
+                     Resolution resolution, uint32_t threads)
+    {
+        JobSystem jobs(threads);
+        MemoryTracker::resetPeaks();
+
+        RunResult result;
+        result.resolution = resolution;
+        result.threads = jobs.workerCount() + 1;
+
+        CPURenderer renderer;
+        renderer.jobSystem = &jobs;
+        renderer.useTemporalReprojection = options.temporalReprojection;
+        renderer.samplingMode = options.sampling;
+        renderer.costView = options.costView;
+        renderer.resize(resolution.width, resolution.height);
+
+        for(uint32_t i = 0; i < options.warmupFrames; ++i)
+            renderer.render(world, path.view(0));
+        renderer.invalidateHistory();
+        renderer.measureAgainstReference = options.reference;
+
+        const uint32_t frameCount = options.maxFrames ? std::min(options.maxFrames, path.tickCount()) : path.tickCount();
+        result.frameMs.reserve(frameCount);
+        double reused = 0;
+
+        const auto start = Clock::now();
+        for(uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            const auto frameStart = Clock::now();
+            renderer.render(world, path.view(frame));
+            result.frameMs.push_back(secondsSince(frameStart) * 1e3);
+
+            result.pixels += renderer.stats.pixelCount;
+            result.tracedRays += renderer.stats.tracedPixels;
+            result.segments += renderer.stats.validationSegments;
+            result.tracedSteps += renderer.stats.traversalSteps - renderer.stats.validationSteps;
+            result.segmentSteps += renderer.stats.validationSteps;
+            reused += renderer.stats.reusedPercent();
+
+            if (options.reference)
+            {
+                const ImageDiff& diff = renderer.stats.referenceDiff;
+                result.mse += diff.mse;
+                result.worstFramePsnr = std::min(result.worstFramePsnr, diff.psnr);
+                result.differingPercent += diff.differingPercent;
+                result.maxChannelError = std::max(result.maxChannelError, diff.maxChannelError);
+            }
+
+            if (options.costView != CPURenderer::CostView::None)
+            {
+                const CostHistogram& frameCost = renderer.costHistogram;
+                for(uint32_t bin = 0; bin < CostHistogram::binCount; ++bin)
+                    result.cost.bins[bin] += frameCost.bins[bin];
+                result.cost.samples += frameCost.samples;
+                result.cost.mean += frameCost.mean * frameCost.samples;
+                result.cost.p50 += frameCost.p50;
+                result.cost.p95 += frameCost.p95;
+                result.cost.p99 += frameCost.p99;
+                result.cost.max = std::max(result.cost.max, frameCost.max);
+            }
+        }
+        if (frameCount && result.cost.samples)
+        {
+            result.cost.mean /= result.cost.samples;
+            result.cost.p50 /= frameCount;
+            result.cost.p95 /= frameCount;
+            result.cost.p99 /= frameCount;
+        }
+        result.seconds = secondsSince(start);
+        result.reusedPercent = frameCount ? reused / frameCount : 0;
+        if (frameCount)
+        {
+            result.mse /= frameCount;
+            result.differingPercent /= frameCount;
+        }
+        result.rendererBytes = renderer.memoryBytes();
+        result.peakResidentBytes = queryPeakResidentBytes();
+        for(uint32_t tag = 0; tag < (uint32_t)MemoryTag::Count; ++tag)
+            result.tags[tag] = MemoryTracker::stats((MemoryTag)tag);
+
+        if (options.costView != CPURenderer::CostView::None && !options.heatmapPrefix.empty() &&
+            !writeHeatmap(options.heatmapPrefix, result, renderer))
+            std::fprintf(stderr, "Failed to write heatmap %s_%s\n", options.heatmapPrefix.c_str(), runName(result).c_str());
+        return result;
+    }
+
+    void writeJson(std::ostream& out, const FrameBenchOptions& options, const World& world, const CameraPath& path,
+                   const std::vector<RunResult>& results)
+    {
+        out.setf(std::ios::fixed);
+        out.precision(4);
+
+        out << "{\n";
+        out << "  \"benchmark\": \"frame\",\n";
+        out << "  \"scene\": {\"generator\": \"terrain\", \"seed\": " << options.seed
+            << ", \"chunks\": [" << world.chunkCount[0] << ", " << world.chunkCount[1] << ", " << world.chunkCount[2] << "]"
+            << ", \"voxelBytes\": " << world.memoryBytes() << "},\n";
+        out << "  \"path\": {\"source\": \"" << (options.pathFile.empty() ? "orbit" : "file")
+            << "\", \"ticks\": " << path.tickCount() << "},\n";
+        out << "  \"temporalReprojection\": " << (options.temporalReprojection ? "true" : "false") << ",\n";
+        out << "  \"sampling\": \"" << samplingName(options.sampling) << "\",\n";
+        out << "  \"reference\": " << (options.reference ? "true" : "false") << ",\n";
+        out << "  \"cost\": \"" << costViewName(options.costView) << "\",\n";
+        out << "  \"repeat\": " << options.repeat << ",\n";
+        out << "  \"runs\": [\n";
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            const RunResult& r = results[i];
+            std::vector<double> sorted = r.frameMs;
+            std::sort(sorted.begin(), sorted.end());
+            double mean = 0;
+            for(double ms : sorted)
+                mean += ms;
+            mean = sorted.empty() ? 0 : mean / (double)sorted.size();
+
+            out << "    {\"name\": \"" << runName(r) << "\""
+                << ", \"width\": " << r.resolution.width << ", \"height\": " << r.resolution.height
+                << ", \"threads\": " << r.threads << ", \"frames\": " << r.frameMs.size() << ",\n";
+            out << "     \"frameMs\": {\"mean\": " << mean << ", \"p50\": " << percentile(sorted, 50)
+                << ", \"p95\": " << percentile(sorted, 95) << ", \"p99\": " << percentile(sorted, 99)
+                << ", \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << "},\n";
+            const auto perSecond = [&](uint64_t count) { return r.seconds > 0 ? (double)count / r.seconds : 0.0; };
+            const auto ratio = [](uint64_t a, uint64_t b) { return b ? (double)a / (double)b : 0.0; };
+            out << "     \"pixelsPerSecond\": " << perSecond(r.pixels)
+                << ", \"tracedRaysPerSecond\": " << perSecond(r.tracedRays)
+                << ", \"segmentsPerSecond\": " << perSecond(r.segments) << ",\n";
+            out << "     \"stepsPerTracedRay\": " << ratio(r.tracedSteps, r.tracedRays)
+                << ", \"stepsPerSegment\": " << ratio(r.segmentSteps, r.segments)
+                << ", \"reusedPercent\": " << r.reusedPercent << ",\n";
+            if (options.reference)
+            {
+                // PSNR of the mean squared error over the frames, null when every frame matched
+                out << "     \"reference\": {\"mse\": " << r.mse << ", \"psnr\": " << jsonNumber(r.psnr())
+                    << ", \"worstFramePsnr\": " << jsonNumber(r.worstFramePsnr)
+                    << ", \"differingPercent\": " << r.differingPercent
+                    << ", \"maxChannelError\": " << r.maxChannelError << "},\n";
+            }
+            out << "     \"memory\": {\"rendererBytes\": " << r.rendererBytes
+                << ", \"peakResidentBytes\": " << r.peakResidentBytes << ",\n      \"tags\": {";
+            for(uint32_t tag = 0; tag < (uint32_t)MemoryTag::Count; ++tag)
+            {
+                out << (tag ? ", " : "") << "\"" << MemoryTracker::tagName((MemoryTag)tag) << "\": {\"currentBytes\": "
+                    << r.tags[tag].currentBytes << ", \"peakBytes\": " << r.tags[tag].peakBytes << "}";
+            }
+            out << "}}";
+            if (options.costView != CPURenderer::CostView::None)
+            {
+                // Bin 0 counts the zero costs, bin b the costs in [2^(b-1), 2^b)
+                out << ",\n     \"cost\": {\"samples\": " << r.cost.samples << ", \"mean\": " << r.cost.mean
+                    << ", \"p50\": " << r.cost.p50 << ", \"p95\": " << r.cost.p95 << ", \"p99\": " << r.cost.p99
+                    << ", \"max\": " << r.cost.max << ", \"log2Bins\": [";
+                for(uint32_t bin = 0; bin < CostHistogram::binCount; ++bin)
+                    out << (bin ? ", " : "") << r.cost.bins[bin];
+                out << "]}";
+            }
+            out << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    FrameBenchOptions options;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (!std::strcmp(argv[i], "--path") && hasValue)
+            options.pathFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--out") && hasValue)
+            options.outFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--resolutions") && hasValue)
+            valid = parseList(argv[++i], options.resolutions, parseResolution);
+        else if (!std::strcmp(argv[i], "--threads") && hasValue)
+            valid = parseList(argv[++i], options.threads, parseCount);
+        else if (!std::strcmp(argv[i], "--chunks") && hasValue)
+            valid = std::sscanf(argv[++i], "%dx%dx%d", &options.chunks[0], &options.chunks[1], &options.chunks[2]) == 3 &&
+                    options.chunks[0] > 0 && options.chunks[1] > 0 && options.chunks[2] > 0;
+        else if (!std::strcmp(argv[i], "--seed") && hasValue)
+            valid = parseCount(argv[++i], options.seed);
+        else if (!std::strcmp(argv[i], "--frames") && hasValue)
+            valid = parseCount(argv[++i], options.maxFrames);
+        else if (!std::strcmp(argv[i], "--repeat") && hasValue)
+            valid = parseCount(argv[++i], options.repeat) && options.repeat > 0;
+        else if (!std::strcmp(argv[i], "--warmup") && hasValue)
+            valid = parseCount(argv[++i], options.warmupFrames);
+        else if (!std::strcmp(argv[i], "--cost") && hasValue)
+            valid = parseCostView(argv[++i], options.costView);
+        else if (!std::strcmp(argv[i], "--heatmap") && hasValue)
+            options.heatmapPrefix = argv[++i];
+        else if (!std::strcmp(argv[i], "--trace") && hasValue)
+            options.traceFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--no-reprojection"))
+            options.temporalReprojection = false;
+        else if (!std::strcmp(argv[i], "--sampling") && hasValue)
+            valid = parseSampling(argv[++i], options.sampling);
+        else if (!std::strcmp(argv[i], "--reference"))
+            options.reference = true;
+        else if (!std::strcmp(argv[i], "--min-psnr") && hasValue)
+        {
+            char* end = nullptr;
+            options.minPsnr = std::strtod(argv[++i], &end);
+            valid = *end == 0 && options.minPsnr > 0;
+        }
+        else if (!std::strcmp(argv[i], "--quick"))
+            options.quick = true;
+        else if (!std::strcmp(argv[i], "--help"))
+        {
+            printUsage();
+            return 0;
+        }
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (options.resolutions.empty())
+        options.resolutions = options.quick ? std::vector<Resolution>{{320, 180}} : std::vector<Resolution>{{1280, 720}};
+    if (options.threads.empty())
+        options.threads = {0};
+    if (!options.heatmapPrefix.empty() && options.costView == CPURenderer::CostView::None)
+        options.costView = CPURenderer::CostView::TraversalSteps;
+    if (options.minPsnr > 0)
+        options.reference = true;
+    if (options.quick)
+    {
+        options.chunks[0] = std::min(options.chunks[0], 2);
+        options.chunks[1] = 1;
+        options.chunks[2] = std::min(options.chunks[2], 2);
+    }
+
+    if (!options.traceFile.empty())
+        Profiler::get().beginCapture();
+
+    World world;
+    world.init(options.chunks[0], options.chunks[1], options.chunks[2]);
+    generateTerrain(world, options.seed);
+
+    CameraPath path;
+    if (options.pathFile.empty())
+        path = orbitPath(world, options.quick ? 16 : 240);
+    else if (!path.load(options.pathFile) || path.tickCount() == 0)
+    {
+        std::fprintf(stderr, "Failed to load camera path %s\n", options.pathFile.c_str());
+        return 1;
+    }
+
+    std::vector<RunResult> results;
+    for(uint32_t repeat = 0; repeat < options.repeat; ++repeat)
+    {
+        for(uint32_t threads : options.threads)
+        {
+            for(const Resolution& resolution : options.resolutions)
+            {
+                results.push_back(runOne(world, path, options, resolution, threads));
+                const RunResult& r = results.back();
+                std::fprintf(stderr, "%ux%u, %u threads: %zu frames in %.3f s\n", resolution.width, resolution.height,
+                             r.threads, r.frameMs.size(), r.seconds);
+                if (options.reference)
+                    std::fprintf(stderr, "  %.2f dB PSNR, worst frame %.2f dB, %.2f%% of the pixels differ\n", r.psnr(),
+                                 r.worstFramePsnr, r.differingPercent);
+            }
+        }
+    }
+
+    if (!options.traceFile.empty())
+    {
+        Profiler::get().endCapture();
+        if (!Profiler::get().writeChromeTrace(options.traceFile))
+            std::fprintf(stderr, "Failed to write %s\n", options.traceFile.c_str());
+    }
+
+    // Checked after the results are written so a failing run can still be looked at
+    int status = 0;
+    for(const RunResult& r : results)
+    {
+        if (options.minPsnr > 0 && r.psnr() < options.minPsnr)
+        {
+            std::fprintf(stderr, "%s: %.2f dB PSNR against the reference, below the %.2f dB floor\n", runName(r).c_str(),
+                         r.psnr(), options.minPsnr);
+            status = 1;
+        }
+    }
+
+    if (options.outFile.empty())
+    {
+        writeJson(std::cout, options, world, path, results);
+        return status;
+    }
+
+    std::ofstream out(options.outFile, std::ios::trunc);
+    if (out)
+        writeJson(out, options, world, path, results);
+    if (!out)
+    {
+        std::fprintf(stderr, "Failed to write %s\n", options.outFile.c_str());
+        return 1;
+    }
+    return status;
+}
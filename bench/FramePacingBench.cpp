@@ -0,0 +1,64 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <string>
+
+#include "FrameScheduler.h"
+#include "SimulatedGpuQueue.h"
+
+namespace
+{
+    // Burns CPU time instead of sleeping, like recording a frame would
+    void spinFor(std::chrono::microseconds duration)
+    {
+        const auto end = Bench::Clock::now() + duration;
+        while (Bench::Clock::now() < end)
+        {
+        }
+    }
+}
+
+void Bench::runFramePacing(const Options& options)
+{
+    using std::chrono::microseconds;
+
+    struct Case
+    {
+        const char* name;
+        microseconds cpu;
+        microseconds gpu;
+    };
+    const Case cases[] = {
+        {"gpu_bound", microseconds(3000), microseconds(5000)},
+        {"cpu_bound", microseconds(5000), microseconds(3000)},
+        {"balanced", microseconds(4000), microseconds(4000)},
+    };
+    const uint32_t frameCount = options.quick ? 20 : 120;
+
+    for(const Case& c : cases)
+    {
+        for(uint32_t framesInFlight = 1; framesInFlight <= 3; ++framesInFlight)
+        {
+            SimulatedGpuQueue queue;
+            FrameScheduler scheduler(queue, framesInFlight);
+
+            const auto start = Clock::now();
+            for(uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                scheduler.beginFrame();
+                spinFor(c.cpu);
+                queue.submit(c.gpu);
+                scheduler.endFrame();
+            }
+            scheduler.waitIdle();
+            const double seconds = secondsSince(start);
+
+            const std::string label = std::string(c.name) + ".inflight" + std::to_string(framesInFlight);
+            report("frames", label.c_str(), seconds * 1e3 / frameCount, "ms/frame");
+            report("frames", (label + ".stalls").c_str(), (double)scheduler.stats().stalledFrames, "frames");
+        }
+
+        report("frames", (std::string(c.name) + ".sum").c_str(), (double)(c.cpu + c.gpu).count() * 1e-3, "ms");
+        report("frames", (std::string(c.name) + ".max").c_str(), (double)std::max(c.cpu, c.gpu).count() * 1e-3, "ms");
+    }
+}
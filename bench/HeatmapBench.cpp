@@ -0,0 +1,90 @@
+#include "Bench.h"
+
+#include "CPURenderer.h"
+#include "JobSystem.h"
+
+using namespace Bench;
+using namespace VoxelDataStructs;
+
+namespace
+{
+    bool sameStats(const CPURenderer::FrameStats& a, const CPURenderer::FrameStats& b)
+    {
+        return a.traversalSteps == b.traversalSteps && a.tracedPixels == b.tracedPixels && a.reusedPixels == b.reusedPixels;
+    }
+
+    // Steps view: the raw buffer adds up to the frame counters, one histogram sample per traced pixel,
+    // the image is replaced but nothing else the renderer computes changes.
+    bool checkCostView(const World& world, JobSystem& jobs)
+    {
+        CPURenderer plain;
+        CPURenderer measured;
+        plain.jobSystem = &jobs;
+        measured.jobSystem = &jobs;
+        measured.costView = CPURenderer::CostView::TraversalSteps;
+        plain.resize(160, 90);
+        measured.resize(160, 90);
+
+        bool ok = true;
+        for(uint32_t frame = 0; frame < 4; ++frame)
+        {
+            // Checkerboard on the last frames so untraced pixels are covered too
+            plain.samplingMode = frame >= 2 ? CPURenderer::SamplingMode::Checkerboard : CPURenderer::SamplingMode::Full;
+            measured.samplingMode = plain.samplingMode;
+            plain.render(world, orbitCamera(world, frame));
+            measured.render(world, orbitCamera(world, frame));
+
+            double steps = 0;
+            for(float cost : measured.costBuffer)
+                steps += cost;
+            uint64_t binned = 0;
+            for(uint64_t count : measured.costHistogram.bins)
+                binned += count;
+
+            const CostHistogram& h = measured.costHistogram;
+            ok &= sameStats(plain.stats, measured.stats);
+            ok &= (uint64_t)steps == measured.stats.traversalSteps;
+            ok &= h.samples == measured.stats.tracedPixels + measured.stats.reusedPixels && binned == h.samples;
+            ok &= h.p50 <= h.p95 && h.p95 <= h.p99 && h.p99 <= h.max && h.mean <= h.max;
+            ok &= measured.framebuffer != plain.framebuffer;
+        }
+        return ok;
+    }
+
+    double msPerFrame(const World& world, JobSystem& jobs, CPURenderer::CostView view, uint32_t width, uint32_t height,
+                      uint32_t frames)
+    {
+        CPURenderer renderer;
+        renderer.jobSystem = &jobs;
+        renderer.costView = view;
+        renderer.resize(width, height);
+        renderer.render(world, orbitCamera(world, 0));
+
+        const auto start = Clock::now();
+        for(uint32_t frame = 1; frame <= frames; ++frame)
+            renderer.render(world, orbitCamera(world, frame));
+        return secondsSince(start) * 1e3 / frames;
+    }
+}
+
+void Bench::runHeatmap(const Options& options)
+{
+    JobSystem jobs(options.threads);
+
+    World world = makeWorld(options, jobs);
+
+    report("heatmap", "check", checkCostView(world, jobs) ? 1.0 : 0.0, "ok");
+
+    const uint32_t width = options.quick ? 320 : 1280;
+    const uint32_t height = options.quick ? 180 : 720;
+    const uint32_t frames = options.quick ? 8 : 32;
+
+    const double none = msPerFrame(world, jobs, CPURenderer::CostView::None, width, height, frames);
+    const double steps = msPerFrame(world, jobs, CPURenderer::CostView::TraversalSteps, width, height, frames);
+    const double time = msPerFrame(world, jobs, CPURenderer::CostView::Time, width, height, frames);
+    report("heatmap", "frame.none", none, "ms");
+    report("heatmap", "frame.steps", steps, "ms");
+    report("heatmap", "frame.time", time, "ms");
+    report("heatmap", "overhead.steps", 100.0 * (steps - none) / none, "%");
+    report("heatmap", "overhead.time", 100.0 * (time - none) / none, "%");
+}
@@ -0,0 +1,54 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "InputQueue.h"
+
+using namespace Bench;
+
+void Bench::runInput(const Options& options)
+{
+    // A 1000 Hz mouse sends a packet every millisecond, here the window thread pushes as fast as it can while
+    // the simulation drains on its own
+    const uint32_t eventCount = options.quick ? 200000 : 2000000;
+    InputQueue queue;
+    std::atomic<bool> done{false};
+
+    const auto start = Clock::now();
+    std::thread producer([&]
+    {
+        for(uint32_t i = 0; i < eventCount; ++i)
+        {
+            InputEvent event{InputEvent::MouseMove, 0, 1, (int32_t)(i & 1)};
+            queue.push(event);
+            if ((i & 255) == 0)
+                std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t ticks = 0;
+    uint32_t maxPerTick = 0;
+    while (true)
+    {
+        const bool finished = done.load(std::memory_order_acquire);
+        const FrameInput input = queue.drain();
+        if (input.eventCount)
+        {
+            ++ticks;
+            maxPerTick = std::max(maxPerTick, input.eventCount);
+        }
+        if (finished && input.eventCount == 0)
+            break;
+        std::this_thread::yield();
+    }
+    producer.join();
+    const double seconds = secondsSince(start);
+
+    report("input", "throughput", eventCount / seconds * 1e-6, "Mevents/s");
+    report("input", "coalesced", (double)eventCount / (double)std::max<uint64_t>(ticks, 1), "events/tick");
+    report("input", "coalesced.max", maxPerTick, "events/tick");
+    report("input", "dropped", (double)queue.droppedEvents(), "events");
+}
@@ -0,0 +1,166 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "CPURenderer.h"
+#include "JobSystem.h"
+#include "TraversalKernels.h"
+
+using namespace VoxelDataStructs;
+using namespace Bench;
+
+namespace
+{
+    std::vector<Ray> makeRays(const World& world, uint32_t count)
+    {
+        const float3 center((float)world.sizeInVoxels(0) * 0.5f, 0, (float)world.sizeInVoxels(2) * 0.5f);
+        const float3 pos(center.x, (float)world.sizeInVoxels(1), -10);
+        const CameraView camera = lookAlong(pos, center - pos);
+
+        // Scanline order, as a tile of the renderer would trace them
+        const uint32_t side = (uint32_t)std::sqrt((double)count);
+        std::vector<Ray> rays;
+        rays.reserve(side * side);
+        for(uint32_t y = 0; y < side; ++y)
+            for(uint32_t x = 0; x < side; ++x)
+                rays.push_back(CPURaytracer::generateRay((float)x + 0.5f, (float)y + 0.5f, (float)side, (float)side, camera));
+        return rays;
+    }
+
+    // Same cells and distances as the reference traversal
+    uint32_t countMismatches(std::span<const Hit> reference, std::span<const Hit> hits)
+    {
+        uint32_t mismatches = 0;
+        for(size_t i = 0; i < hits.size(); ++i)
+        {
+            const Hit& a = reference[i];
+            const Hit& b = hits[i];
+            mismatches += a.hit != b.hit || (a.hit && (a.voxel != b.voxel || a.distance != b.distance ||
+                                                       a.normal.x != b.normal.x || a.normal.y != b.normal.y ||
+                                                       a.normal.z != b.normal.z || a.steps != b.steps));
+        }
+        return mismatches;
+    }
+
+    // Returns the traversal rate in Mrays/s
+    double measure(const TraversalKernel& kernel, const World& world, KernelConfig config, std::span<const Ray> rays,
+                 std::span<const Hit> reference, JobSystem& jobs, double genericRate)
+    {
+        OccupancyGrid grid;
+        auto start = Clock::now();
+        kernel.build(world, config.chunkDim, config.layout, grid, &jobs);
+        const double buildSeconds = secondsSince(start);
+
+        // Best of a few runs, the first one also pulls the grid in cache
+        std::vector<Hit> hits(rays.size());
+        double traceSeconds = 1e30;
+        for(int run = 0; run < 3; ++run)
+        {
+            start = Clock::now();
+            kernel.trace(grid, rays, 0.0f, 1000.0f, hits);
+            traceSeconds = std::min(traceSeconds, secondsSince(start));
+        }
+        const double rate = (double)rays.size() / traceSeconds * 1e-6;
+
+        std::string label = kernel.generic ? std::string("generic.d") + std::to_string(config.chunkDim) +
+                                             (config.layout == VoxelLayout::Morton ? ".morton" : ".linear")
+                                           : std::string(kernel.name);
+        report("kernels", (label + ".build").c_str(), buildSeconds * 1e3, "ms");
+        report("kernels", (label + ".trace").c_str(), rate, "Mrays/s");
+        if (genericRate > 0)
+            report("kernels", (label + ".speedup").c_str(), rate / genericRate, "x generic");
+
+        if (const uint32_t mismatches = countMismatches(reference, hits))
+            std::printf("kernels  %s: %u rays differ from CPURaytracer::traceClosest\n", label.c_str(), mismatches);
+        return rate;
+    }
+
+    // The renderer through a kernel draws the same frames, with the same counters, as through CPURaytracer
+    bool checkRenderer(const World& world, JobSystem& jobs, const KernelConfig& config, double& referenceMs, double& cullingMs,
+                       double& kernelMs)
+    {
+        CPURenderer reference;
+        CPURenderer kernel;
+        reference.jobSystem = &jobs;
+        kernel.jobSystem = &jobs;
+        reference.useChunkCulling = false;
+        kernel.useTraversalKernel = true;
+        kernel.kernelConfig = config;
+        reference.resize(320, 180);
+        kernel.resize(320, 180);
+
+        CPURenderer culling;
+        culling.jobSystem = &jobs;
+        culling.resize(320, 180);
+
+        bool ok = true;
+        referenceMs = 0;
+        cullingMs = 0;
+        kernelMs = 0;
+        constexpr uint32_t frames = 8;
+        for(uint32_t frame = 0; frame < frames; ++frame)
+        {
+            const CameraView camera = orbitCamera(world, frame);
+            auto start = Clock::now();
+            reference.render(world, camera);
+            referenceMs += secondsSince(start) * 1e3 / frames;
+            start = Clock::now();
+            kernel.render(world, camera);
+            kernelMs += secondsSince(start) * 1e3 / frames;
+            start = Clock::now();
+            culling.render(world, camera);
+            cullingMs += secondsSince(start) * 1e3 / frames;
+
+            ok &= kernel.framebuffer == reference.framebuffer;
+            ok &= kernel.stats.traversalSteps == reference.stats.traversalSteps &&
+                  kernel.stats.reusedPixels == reference.stats.reusedPixels;
+        }
+        return ok;
+    }
+}
+
+void Bench::runKernels(const Options& options)
+{
+    JobSystem jobs(options.threads);
+
+    World world = makeWorld(options, jobs);
+
+    const std::vector<Ray> rays = makeRays(world, options.quick ? 65536 : 262144);
+    std::vector<Hit> reference(rays.size());
+    for(size_t i = 0; i < rays.size(); ++i)
+    {
+        reference[i] = CPURaytracer::traceClosest(world, rays[i], 0.0f, 1000.0f);
+        reference[i].color = 0;
+        reference[i].hitPoint = float3();
+    }
+
+    // The generic kernel on every grid configuration, then each specialisation against it
+    double genericRates[2][3] = {};
+    const int32_t dims[3] = {16, 32, 64};
+    for(int l = 0; l < 2; ++l)
+    {
+        for(int d = 0; d < 3; ++d)
+        {
+            const KernelConfig config = {dims[d], l ? VoxelLayout::Morton : VoxelLayout::Linear, 1};
+            genericRates[l][d] = measure(TraversalKernels::generic(), world, config, rays, reference, jobs, 0);
+        }
+    }
+
+    for(const TraversalKernel& kernel : TraversalKernels::registry())
+    {
+        const int d = kernel.config.chunkDim == 16 ? 0 : kernel.config.chunkDim == 32 ? 1 : 2;
+        const int l = kernel.config.layout == VoxelLayout::Morton;
+        measure(kernel, world, kernel.config, rays, reference, jobs, genericRates[l][d]);
+    }
+
+    // The renderer's default kernel against its CPURaytracer path, with and without chunk culling
+    double referenceMs = 0, cullingMs = 0, kernelMs = 0;
+    const bool rendererOk = checkRenderer(world, jobs, CPURenderer().kernelConfig, referenceMs, cullingMs, kernelMs);
+    report("kernels", "renderer.check", rendererOk ? 1.0 : 0.0, "ok");
+    report("kernels", "renderer.raytracer", referenceMs, "ms/frame");
+    report("kernels", "renderer.culling", cullingMs, "ms/frame");
+    report("kernels", "renderer.kernel", kernelMs, "ms/frame");
+}
@@ -0,0 +1,100 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <thread>
+
+#include "EngineLoop.h"
+#include "SnapshotExchange.h"
+
+using namespace Bench;
+
+namespace
+{
+    bool checkExchange()
+    {
+        bool ok = true;
+
+        // Nothing published yet, then only the latest of several publishes is seen
+        SnapshotExchange<uint32_t> exchange;
+        ok &= !exchange.fetch();
+        for(uint32_t i = 1; i <= 3; ++i)
+        {
+            exchange.writeBuffer() = i;
+            exchange.publish();
+        }
+        ok &= exchange.fetch() && exchange.readBuffer() == 3;
+        ok &= !exchange.fetch() && exchange.readBuffer() == 3;
+
+        // The writer never gets back the buffer the reader holds
+        exchange.writeBuffer() = 4;
+        exchange.publish();
+        exchange.writeBuffer() = 5;
+        ok &= exchange.readBuffer() == 3;
+        exchange.publish();
+        ok &= exchange.fetch() && exchange.readBuffer() == 5;
+
+        // Long hitches drop time instead of bursting
+        FixedTimestep timestep;
+        timestep.step = 0.01;
+        timestep.maxStepsPerAdvance = 4;
+        ok &= timestep.advance(0.025) == 2;
+        ok &= timestep.advance(0.006) == 1;
+        ok &= timestep.advance(1.0) == 4 && timestep.droppedSteps > 90 && timestep.accumulator == 0;
+        return ok;
+    }
+}
+
+void Bench::runLoop(const Options& options)
+{
+    report("loop", "exchange.check", checkExchange() ? 1.0 : 0.0, "ok");
+
+    // The render callback stands for a frame far slower than a tick; the simulation has to keep its rate,
+    // every snapshot the renderer sees has to be complete, and no thread may spin while waiting
+    const double tickRate = 120.0;
+    const double renderMs = 25.0;
+    const double runSeconds = options.quick ? 0.5 : 2.0;
+
+    std::atomic<uint64_t> simulated{0};
+    std::atomic<bool> torn{false};
+    uint64_t lastSeenTick = 0;
+    bool ordered = true;
+
+    EngineLoop loop(tickRate,
+                    [&](double) { simulated.fetch_add(1, std::memory_order_relaxed); },
+                    [&](FrameSnapshot& snapshot)
+                    {
+                        // Every field tells the same tick so a torn read is visible
+                        const float t = (float)simulated.load(std::memory_order_relaxed);
+                        snapshot.camera.pos = {t, t, t};
+                        snapshot.camera.fov = t;
+                    },
+                    [&](const FrameSnapshot& snapshot)
+                    {
+                        const CameraView& c = snapshot.camera;
+                        if (c.pos.x != c.fov || c.pos.y != c.fov || c.pos.z != c.fov || (float)snapshot.tick != c.fov)
+                            torn.store(true, std::memory_order_relaxed);
+                        ordered &= snapshot.tick > lastSeenTick;
+                        lastSeenTick = snapshot.tick;
+                        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(renderMs));
+                    });
+
+    const std::clock_t cpuStart = std::clock();
+    const auto start = Clock::now();
+    loop.start();
+    std::this_thread::sleep_for(std::chrono::duration<double>(runSeconds));
+    loop.stop();
+    const double wall = secondsSince(start);
+    const double cpu = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    const EngineLoop::Stats stats = loop.stats();
+    report("loop", "decoupled.check", !torn.load() && ordered && stats.ticks == simulated.load() ? 1.0 : 0.0, "ok");
+    report("loop", "tick.rate", (double)stats.ticks / wall, "Hz");
+    report("loop", "tick.target", tickRate, "Hz");
+    report("loop", "frame.rate", (double)stats.frames / wall, "Hz");
+    report("loop", "snapshots.skipped", (double)stats.skippedSnapshots, "snapshots");
+    report("loop", "steps.dropped", (double)stats.droppedSteps, "steps");
+    // Close to 0 when both threads sleep while waiting, 100 per spinning thread
+    report("loop", "cpu", 100.0 * cpu / std::max(wall, 1e-9), "%");
+}
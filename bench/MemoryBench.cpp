@@ -0,0 +1,77 @@
+#include "Bench.h"
+
+#include <vector>
+
+#include "CPUBackend.h"
+#include "JobSystem.h"
+#include "SDFBrickVolume.h"
+#include "TraversalKernels.h"
+
+using namespace Bench;
+using namespace VoxelDataStructs;
+
+namespace
+{
+    bool checkTracker()
+    {
+        // Growth, copies and frees are all seen, the peak stays after the free
+        const MemoryTracker::TagStats before = MemoryTracker::stats(MemoryTag::Staging);
+        {
+            TrackedVector<uint64_t, MemoryTag::Staging> a(1000);
+            TrackedVector<uint64_t, MemoryTag::Staging> b = a;
+            b.resize(3000);
+            if (MemoryTracker::stats(MemoryTag::Staging).currentBytes - before.currentBytes != 4000 * sizeof(uint64_t))
+                return false;
+        }
+        const MemoryTracker::TagStats after = MemoryTracker::stats(MemoryTag::Staging);
+        bool ok = after.currentBytes == before.currentBytes;
+        ok &= after.peakBytes >= before.currentBytes + 4000 * sizeof(uint64_t);
+        ok &= after.allocations >= before.allocations + 3;
+
+        MemoryTracker::resetPeaks();
+        ok &= MemoryTracker::stats(MemoryTag::Staging).peakBytes == after.currentBytes;
+        return ok;
+    }
+}
+
+void Bench::runMemory(const Options& options)
+{
+    report("memory", "check", checkTracker() ? 1.0 : 0.0, "ok");
+
+    JobSystem jobs(options.threads);
+    MemoryTracker::resetPeaks();
+    const uint64_t baseline = MemoryTracker::totalCurrentBytes();
+
+    // What a world costs, then what each structure built from it adds
+    World world = makeWorld(options, jobs);
+
+    uint64_t solidVoxels = 0;
+    for(const Chunk& chunk : world.chunks)
+        solidVoxels += chunk.solidCount;
+    const uint64_t voxelBytes = MemoryTracker::stats(MemoryTag::Voxels).currentBytes;
+    report("memory", "world.voxels", (double)voxelBytes / (1024.0 * 1024.0), "MB");
+    report("memory", "world.bytes_per_solid", (double)voxelBytes / (double)std::max<uint64_t>(solidVoxels, 1), "B/voxel");
+    // The Voxel list format stores explicit positions
+    report("memory", "world.voxel_list", (double)(solidVoxels * sizeof(Voxel)) / (1024.0 * 1024.0), "MB");
+
+    SDFBrickVolume sdf;
+    sdf.build(world, &jobs);
+    OccupancyGrid grid;
+    TraversalKernels::select({16, VoxelLayout::Morton, 4}).build(world, 16, VoxelLayout::Morton, grid, &jobs);
+
+    CPUBackend backend(world);
+    backend.renderer.jobSystem = &jobs;
+    backend.init(nullptr, options.quick ? 320 : 1280, options.quick ? 180 : 720);
+    CameraView camera{};
+    camera.pos = float3((float)world.sizeInVoxels(0) * 0.5f, (float)world.sizeInVoxels(1), -10.0f);
+    camera.forward = normalize(float3(0, -0.4f, 1));
+    camera.right = float3(1, 0, 0);
+    camera.fov = 80;
+    camera.Znear = 0.1f;
+    camera.Zfar = 1000;
+    for(uint32_t frame = 0; frame < 2; ++frame)
+        backend.frame(camera);
+
+    reportMemory("memory");
+    report("memory", "total", (double)(MemoryTracker::totalCurrentBytes() - baseline) / (1024.0 * 1024.0), "MB");
+}
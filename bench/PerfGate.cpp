@@ -0,0 +1,777 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+// Compares RayVox_FrameBench results against a baseline and fails when a metric regressed beyond tolerance.
+// Both sides can hold repeated runs: each metric is summarized by its median, and the median absolute
+// deviation of the runs widens the threshold so noisy metrics do not fail on noise alone.
+namespace
+{
+    // Just enough JSON for the files written by RayVox_FrameBench and --save-baseline
+    struct JsonValue
+    {
+        enum class Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        Type type = Type::Null;
+        double number = 0;
+        std::string string;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        const JsonValue* find(const char* key) const
+        {
+            for(const auto& member : members)
+            {
+                if (member.first == key)
+                    return &member.second;
+            }
+            return nullptr;
+        }
+
+        double numberOr(const char* key, double fallback) const
+        {
+            const JsonValue* value = find(key);
+            return value && value->type == Type::Number ? value->number : fallback;
+        }
+
+        std::string stringOr(const char* key, const char* fallback) const
+        {
+            const JsonValue* value = find(key);
+            return value && value->type == Type::String ? value->string : fallback;
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(const std::string& text) : text(text) {}
+
+        bool parse(JsonValue& value)
+        {
+            return parseValue(value, 0) && (skipSpaces(), pos == text.size());
+        }
+
+    private:
+        const std::string& text;
+        size_t pos = 0;
+
+        void skipSpaces()
+        {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t'))
+                ++pos;
+        }
+
+        bool consume(char c)
+        {
+            skipSpaces();
+            if (pos < text.size() && text[pos] == c)
+            {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool parseLiteral(const char* literal)
+        {
+            const size_t length = std::strlen(literal);
+            if (text.compare(pos, length, literal) != 0)
+                return false;
+            pos += length;
+            return true;
+        }
+
+        bool parseHex4(uint32_t& value)
+        {
+            if (pos + 4 > text.size())
+                return false;
+            value = 0;
+            for(size_t end = pos + 4; pos < end; ++pos)
+            {
+                const char c = text[pos];
+                const uint32_t digit = c >= '0' && c <= '9' ? uint32_t(c - '0')
+                                     : c >= 'a' && c <= 'f' ? uint32_t(c - 'a' + 10)
+                                     : c >= 'A' && c <= 'F' ? uint32_t(c - 'A' + 10) : 16u;
+                if (digit == 16)
+                    return false;
+                value = value * 16 + digit;
+            }
+            return true;
+        }
+
+        // After "\u": decodes the code point, surrogate pairs included, and appends it as UTF-8
+        bool parseCodePoint(std::string& out)
+        {
+            uint32_t code;
+            if (!parseHex4(code) || (code >= 0xDC00 && code <= 0xDFFF))
+                return false;
+            if (code >= 0xD800 && code <= 0xDBFF)
+            {
+                uint32_t low;
+                if (text.compare(pos, 2, "\\u") != 0 || (pos += 2, !parseHex4(low)) || low < 0xDC00 || low > 0xDFFF)
+                    return false;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            if (code < 0x80)
+                out += char(code);
+            else if (code < 0x800)
+            {
+                out += char(0xC0 | (code >> 6));
+                out += char(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                out += char(0xE0 | (code >> 12));
+                out += char(0x80 | ((code >> 6) & 0x3F));
+                out += char(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                out += char(0xF0 | (code >> 18));
+                out += char(0x80 | ((code >> 12) & 0x3F));
+                out += char(0x80 | ((code >> 6) & 0x3F));
+                out += char(0x80 | (code & 0x3F));
+            }
+            return true;
+        }
+
+        bool parseString(std::string& out)
+        {
+            if (!consume('"'))
+                return false;
+            out.clear();
+            while (pos < text.size() && text[pos] != '"')
+            {
+                char c = text[pos++];
+                if (c == '\\')
+                {
+                    if (pos >= text.size())
+                        return false;
+                    c = text[pos++];
+                    switch(c)
+                    {
+                        case 'n': c = '\n'; break;
+                        case 't': c = '\t'; break;
+                        case 'r': c = '\r'; break;
+                        case 'b': c = '\b'; break;
+                        case 'f': c = '\f'; break;
+                        case 'u':
+                            if (!parseCodePoint(out))
+                                return false;
+                            continue;
+                        default: break;
+                    }
+                }
+                out += c;
+            }
+            return pos++ < text.size();
+        }
+
+        bool parseValue(JsonValue& value, uint32_t depth)
+        {
+            if (depth > 64)
+                return false;
+            skipSpaces();
+            if (pos >= text.size())
+                return false;
+
+            const char c = text[pos];
+            if (c == '{')
+            {
+                ++pos;
+                value.type = JsonValue::Type::Object;
+                if (consume('}'))
+                    return true;
+                do
+                {
+                    std::pair<std::string, JsonValue> member;
+                    if (!parseString(member.first) || !consume(':') || !parseValue(member.second, depth + 1))
+                        return false;
+                    value.members.push_back(std::move(member));
+                }
+                while (consume(','));
+                return consume('}');
+            }
+            if (c == '[')
+            {
+                ++pos;
+                value.type = JsonValue::Type::Array;
+                if (consume(']'))
+                    return true;
+                do
+                {
+                    value.items.emplace_back();
+                    if (!parseValue(value.items.back(), depth + 1))
+                        return false;
+                }
+                while (consume(','));
+                return consume(']');
+            }
+            if (c == '"')
+            {
+                value.type = JsonValue::Type::String;
+                return parseString(value.string);
+            }
+            if (c == 't' || c == 'f')
+            {
+                value.type = JsonValue::Type::Bool;
+                value.number = c == 't';
+                return parseLiteral(c == 't' ? "true" : "false");
+            }
+            if (c == 'n')
+                return parseLiteral("null");
+
+            char* end = nullptr;
+            value.type = JsonValue::Type::Number;
+            value.number = std::strtod(text.c_str() + pos, &end);
+            if (end == text.c_str() + pos)
+                return false;
+            pos = size_t(end - text.c_str());
+            return true;
+        }
+    };
+
+    enum class Category
+    {
+        FrameTime,
+        Throughput,
+        Memory,
+        Count
+    };
+
+    const char* categoryName(Category category)
+    {
+        switch(category)
+        {
+            case Category::FrameTime: return "frame";
+            case Category::Throughput: return "rays";
+            default: return "memory";
+        }
+    }
+
+    struct MetricInfo
+    {
+        Category category;
+        bool higherIsBetter;
+        // Display unit and the factor from the JSON value to it
+        const char* unit;
+        double scale;
+    };
+
+    MetricInfo metricInfo(const std::string& name)
+    {
+        if (name.rfind("frameMs.", 0) == 0)
+            return {Category::FrameTime, false, "ms", 1.0};
+        if (name == "pixelsPerSecond")
+            return {Category::Throughput, true, "Mpix/s", 1e-6};
+        if (name == "tracedRaysPerSecond")
+            return {Category::Throughput, true, "Mrays/s", 1e-6};
+        return {Category::Memory, false, "MB", 1.0 / (1024.0 * 1024.0)};
+    }
+
+    // Metric name -> one sample per run of the benchmark
+    using RunSamples = std::map<std::string, std::vector<double>>;
+    // Run name ("1280x720_t8") -> its metrics
+    using Samples = std::map<std::string, RunSamples>;
+
+    struct LoadedFile
+    {
+        std::string scene;
+        Samples samples;
+    };
+
+    // Identifies the setup a result was measured on, two files are only compared when it matches
+    std::string describeScene(const JsonValue& root)
+    {
+        std::string scene;
+        if (const JsonValue* s = root.find("scene"))
+        {
+            scene = s->stringOr("generator", "?") + " seed " + std::to_string((long long)s->numberOr("seed", 0));
+            if (const JsonValue* chunks = s->find("chunks"); chunks && chunks->items.size() == 3)
+            {
+                scene += ", chunks " + std::to_string((int)chunks->items[0].number) + "x" +
+                         std::to_string((int)chunks->items[1].number) + "x" + std::to_string((int)chunks->items[2].number);
+            }
+        }
+        if (const JsonValue* path = root.find("path"))
+            scene += ", path " + path->stringOr("source", "?") + " " + std::to_string((long long)path->numberOr("ticks", 0));
+        if (const JsonValue* reprojection = root.find("temporalReprojection"))
+            scene += reprojection->number != 0 ? ", reprojection" : ", no reprojection";
+        if (const std::string sampling = root.stringOr("sampling", "full"); sampling != "full")
+            scene += ", " + sampling + " sampling";
+        return scene;
+    }
+
+    void addFrameRun(const JsonValue& run, RunSamples& metrics)
+    {
+        if (const JsonValue* frameMs = run.find("frameMs"))
+        {
+            for(const char* stat : {"p50", "p95", "p99"})
+            {
+                if (const JsonValue* value = frameMs->find(stat))
+                    metrics[std::string("frameMs.") + stat].push_back(value->number);
+            }
+        }
+        for(const char* key : {"pixelsPerSecond", "tracedRaysPerSecond"})
+        {
+            if (const JsonValue* value = run.find(key))
+                metrics[key].push_back(value->number);
+        }
+
+        if (const JsonValue* memory = run.find("memory"))
+        {
+            for(const char* key : {"rendererBytes", "peakResidentBytes"})
+            {
+                if (const JsonValue* value = memory->find(key))
+                    metrics[std::string("memory.") + key].push_back(value->number);
+            }
+            if (const JsonValue* tags = memory->find("tags"))
+            {
+                for(const auto& tag : tags->members)
+                {
+                    if (const JsonValue* peak = tag.second.find("peakBytes"))
+                        metrics["memory." + tag.first + ".peakBytes"].push_back(peak->number);
+                }
+            }
+        }
+    }
+
+    bool loadFile(const std::string& fileName, LoadedFile& file)
+    {
+        std::ifstream in(fileName, std::ios::binary);
+        if (!in)
+            return false;
+        const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        JsonValue root;
+        if (!JsonParser(text).parse(root) || root.type != JsonValue::Type::Object)
+        {
+            std::fprintf(stderr, "%s: not valid JSON\n", fileName.c_str());
+            return false;
+        }
+
+        const std::string benchmark = root.stringOr("benchmark", "");
+        const JsonValue* runs = root.find("runs");
+        if (benchmark == "frame" && runs && runs->type == JsonValue::Type::Array)
+        {
+            file.scene = describeScene(root);
+            for(const JsonValue& run : runs->items)
+                addFrameRun(run, file.samples[run.stringOr("name", "?")]);
+            return true;
+        }
+        if (benchmark == "frame-baseline" && runs && runs->type == JsonValue::Type::Object)
+        {
+            file.scene = root.stringOr("scene", "");
+            for(const auto& run : runs->members)
+            {
+                for(const auto& metric : run.second.members)
+                {
+                    std::vector<double>& values = file.samples[run.first][metric.first];
+                    for(const JsonValue& value : metric.second.items)
+                        values.push_back(value.number);
+                }
+            }
+            return true;
+        }
+
+        std::fprintf(stderr, "%s: neither RayVox_FrameBench results nor a baseline\n", fileName.c_str());
+        return false;
+    }
+
+    // Merges the files of one side, false when they were not measured on the same setup
+    bool loadSide(const std::vector<std::string>& fileNames, std::string& scene, Samples& samples)
+    {
+        for(const std::string& fileName : fileNames)
+        {
+            LoadedFile file;
+            if (!loadFile(fileName, file))
+            {
+                std::fprintf(stderr, "Failed to read %s\n", fileName.c_str());
+                return false;
+            }
+            if (!scene.empty() && file.scene != scene)
+            {
+                std::fprintf(stderr, "%s was measured on \"%s\", expected \"%s\"\n", fileName.c_str(), file.scene.c_str(), scene.c_str());
+                return false;
+            }
+            scene = file.scene;
+            for(auto& run : file.samples)
+            {
+                for(auto& metric : run.second)
+                {
+                    std::vector<double>& values = samples[run.first][metric.first];
+                    values.insert(values.end(), metric.second.begin(), metric.second.end());
+                }
+            }
+        }
+        return true;
+    }
+
+    // False when a metric of the side has fewer than minSamples samples
+    bool checkSampleCount(const char* side, const Samples& samples, uint32_t minSamples)
+    {
+        for(const auto& run : samples)
+        {
+            for(const auto& metric : run.second)
+            {
+                if (metric.second.size() < minSamples)
+                {
+                    std::fprintf(stderr, "%s %s %s has %zu sample(s), at least %u are needed to estimate the noise.\n"
+                                 "Pass more result files or run RayVox_FrameBench --repeat %u.\n", side,
+                                 run.first.c_str(), metric.first.c_str(), metric.second.size(), minSamples, minSamples);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0;
+        std::sort(values.begin(), values.end());
+        const size_t half = values.size() / 2;
+        return values.size() % 2 ? values[half] : 0.5 * (values[half - 1] + values[half]);
+    }
+
+    double medianAbsoluteDeviation(const std::vector<double>& values, double center)
+    {
+        std::vector<double> deviations;
+        deviations.reserve(values.size());
+        for(double value : values)
+            deviations.push_back(std::fabs(value - center));
+        return median(std::move(deviations));
+    }
+
+    struct GateOptions
+    {
+        std::vector<std::string> baselineFiles;
+        std::vector<std::string> currentFiles;
+        std::string saveBaseline;
+        // Smallest relative change that counts, per category, in percent
+        double tolerance[(size_t)Category::Count] = {5.0, 5.0, 3.0};
+        // A change must also exceed madK standard deviations, estimated from the MADs of both sides
+        double madK = 3.0;
+        // Fewest runs of a metric on each side: the MAD of one or two samples is 0 and hides the noise
+        uint32_t minSamples = 3;
+        bool verbose = false;
+    };
+
+    enum class Verdict
+    {
+        Ok,
+        Improved,
+        Regressed,
+        Missing,
+        New
+    };
+
+    const char* verdictName(Verdict verdict)
+    {
+        switch(verdict)
+        {
+            case Verdict::Improved: return "improved";
+            case Verdict::Regressed: return "REGRESSED";
+            case Verdict::Missing: return "MISSING";
+            case Verdict::New: return "new";
+            default: return "ok";
+        }
+    }
+
+    std::string formatSide(const std::vector<double>& values, const MetricInfo& info)
+    {
+        if (values.empty())
+            return "-";
+        const double center = median(values);
+        char text[64];
+        std::snprintf(text, sizeof(text), "%.3f +-%.3f (%zu)", center * info.scale,
+                      medianAbsoluteDeviation(values, center) * info.scale, values.size());
+        return text;
+    }
+
+    // Prints one row per metric and returns how many regressed or went missing
+    uint32_t compare(const Samples& baseline, const Samples& current, const GateOptions& options)
+    {
+        // Scaled MAD of a normal distribution is its standard deviation
+        constexpr double madToSigma = 1.4826;
+
+        std::printf("%-16s %-28s %-9s %26s %26s %9s %8s  %s\n", "run", "metric", "unit", "baseline median +-MAD (n)",
+                    "current median +-MAD (n)", "change", "limit", "status");
+
+        uint32_t failures = 0;
+        const auto row = [&](const std::string& run, const std::string& metric, const std::vector<double>* before,
+                             const std::vector<double>* after)
+        {
+            const MetricInfo info = metricInfo(metric);
+            const std::vector<double> none;
+            const std::vector<double>& b = before ? *before : none;
+            const std::vector<double>& a = after ? *after : none;
+
+            Verdict verdict = Verdict::Ok;
+            double change = 0;
+            double limit = options.tolerance[(size_t)info.category];
+            if (b.empty())
+                verdict = Verdict::New;
+            else if (a.empty())
+                verdict = Verdict::Missing;
+            else
+            {
+                const double medianBefore = median(b);
+                const double medianAfter = median(a);
+                const double madBefore = medianAbsoluteDeviation(b, medianBefore);
+                const double madAfter = medianAbsoluteDeviation(a, medianAfter);
+                const double noise = options.madK * madToSigma * std::sqrt(madBefore * madBefore + madAfter * madAfter);
+
+                // Both in percent of the baseline, a zero baseline (an unused memory tag) compares in absolute terms
+                const double reference = std::fabs(medianBefore) > 0 ? std::fabs(medianBefore) : 1.0;
+                change = 100.0 * (medianAfter - medianBefore) / reference;
+                limit = std::max(limit, 100.0 * noise / reference);
+
+                const double worse = info.higherIsBetter ? -change : change;
+                if (worse > limit)
+                    verdict = Verdict::Regressed;
+                else if (-worse > limit)
+                    verdict = Verdict::Improved;
+            }
+
+            if (verdict == Verdict::Regressed || verdict == Verdict::Missing)
+                ++failures;
+            else if (!options.verbose && verdict == Verdict::Ok)
+                return;
+
+            std::printf("%-16s %-28s %-9s %26s %26s %+8.2f%% %7.2f%%  %s\n", run.c_str(), metric.c_str(), info.unit,
+                        formatSide(b, info).c_str(), formatSide(a, info).c_str(), change, limit, verdictName(verdict));
+        };
+
+        for(const auto& run : baseline)
+        {
+            const auto currentRun = current.find(run.first);
+            for(const auto& metric : run.second)
+            {
+                const std::vector<double>* after = nullptr;
+                if (currentRun != current.end())
+                {
+                    const auto found = currentRun->second.find(metric.first);
+                    if (found != currentRun->second.end())
+                        after = &found->second;
+                }
+                row(run.first, metric.first, &metric.second, after);
+            }
+        }
+        for(const auto& run : current)
+        {
+            const auto baselineRun = baseline.find(run.first);
+            for(const auto& metric : run.second)
+            {
+                if (baselineRun == baseline.end() || !baselineRun->second.count(metric.first))
+                    row(run.first, metric.first, nullptr, &metric.second);
+            }
+        }
+        return failures;
+    }
+
+    // Quoted JSON string, UTF-8 passes through and control characters are escaped
+    std::string jsonString(const std::string& text)
+    {
+        std::string out = "\"";
+        for(const char c : text)
+        {
+            switch(c)
+            {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                case '\r': out += "\\r"; break;
+                default:
+                    if ((unsigned char)c < 0x20)
+                    {
+                        char code[8];
+                        std::snprintf(code, sizeof(code), "\\u%04x", (unsigned)c);
+                        out += code;
+                    }
+                    else
+                        out += c;
+            }
+        }
+        return out + "\"";
+    }
+
+    bool saveBaseline(const std::string& fileName, const std::string& scene, const Samples& samples)
+    {
+        std::ofstream out(fileName, std::ios::trunc);
+        out.precision(10);
+        out << "{\n  \"benchmark\": \"frame-baseline\",\n  \"scene\": " << jsonString(scene) << ",\n  \"runs\": {";
+        bool firstRun = true;
+        for(const auto& run : samples)
+        {
+            out << (firstRun ? "\n" : ",\n") << "    " << jsonString(run.first) << ": {";
+            firstRun = false;
+            bool firstMetric = true;
+            for(const auto& metric : run.second)
+            {
+                out << (firstMetric ? "\n" : ",\n") << "      " << jsonString(metric.first) << ": [";
+                firstMetric = false;
+                for(size_t i = 0; i < metric.second.size(); ++i)
+                    out << (i ? ", " : "") << metric.second[i];
+                out << "]";
+            }
+            out << "\n    }";
+        }
+        out << "\n  }\n}\n";
+        return out.good();
+    }
+
+    void printUsage()
+    {
+        std::printf("Usage: RayVox_PerfGate --baseline base.json [--baseline ...] --current results.json [--current ...]\n"
+                    "                       [--tolerance frame=5,rays=5,memory=3] [--mad-k 3] [--min-samples 3] [--verbose]\n"
+                    "       RayVox_PerfGate --current results.json [--current ...] --save-baseline base.json\n"
+                    "Inputs are RayVox_FrameBench results, written with --repeat or one file per repeated run, or\n"
+                    "baselines saved by --save-baseline. Every metric needs min-samples runs on each side.\n"
+                    "A metric regresses when its median moved the wrong way by more than both the category tolerance\n"
+                    "(percent of the baseline) and mad-k standard deviations estimated from the MADs.\n"
+                    "Exits with 0 when nothing regressed, 1 on a regression or missing metric, 2 on bad input.\n"
+                    "Reference configuration, baseline and results from the same machine:\n"
+                    "  RayVox_FrameBench --repeat 5 --out results.json (orbit, terrain seed 1, 4x2x4 chunks, 1280x720)\n");
+    }
+
+    bool parseTolerances(const char* text, GateOptions& options)
+    {
+        std::string list = text;
+        size_t start = 0;
+        while (start <= list.size())
+        {
+            const size_t end = std::min(list.find(',', start), list.size());
+            const std::string item = list.substr(start, end - start);
+            const size_t equal = item.find('=');
+            if (equal == std::string::npos)
+                return false;
+
+            const std::string name = item.substr(0, equal);
+            char* valueEnd = nullptr;
+            const double value = std::strtod(item.c_str() + equal + 1, &valueEnd);
+            if (*valueEnd != 0 || value < 0)
+                return false;
+
+            bool known = false;
+            for(uint32_t category = 0; category < (uint32_t)Category::Count; ++category)
+            {
+                if (name == categoryName((Category)category))
+                {
+                    options.tolerance[category] = value;
+                    known = true;
+                }
+            }
+            if (!known)
+                return false;
+            start = end + 1;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    GateOptions options;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (!std::strcmp(argv[i], "--baseline") && hasValue)
+            options.baselineFiles.push_back(argv[++i]);
+        else if (!std::strcmp(argv[i], "--current") && hasValue)
+            options.currentFiles.push_back(argv[++i]);
+        else if (!std::strcmp(argv[i], "--save-baseline") && hasValue)
+            options.saveBaseline = argv[++i];
+        else if (!std::strcmp(argv[i], "--tolerance") && hasValue)
+            valid = parseTolerances(argv[++i], options);
+        else if (!std::strcmp(argv[i], "--mad-k") && hasValue)
+        {
+            char* end = nullptr;
+            options.madK = std::strtod(argv[++i], &end);
+            valid = *end == 0 && options.madK >= 0;
+        }
+        else if (!std::strcmp(argv[i], "--min-samples") && hasValue)
+        {
+            char* end = nullptr;
+            const long count = std::strtol(argv[++i], &end, 10);
+            valid = *end == 0 && count >= 1;
+            options.minSamples = (uint32_t)count;
+        }
+        else if (!std::strcmp(argv[i], "--verbose"))
+            options.verbose = true;
+        else if (!std::strcmp(argv[i], "--help"))
+        {
+            printUsage();
+            return 0;
+        }
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (options.currentFiles.empty() || (options.baselineFiles.empty() && options.saveBaseline.empty()))
+    {
+        printUsage();
+        return 2;
+    }
+
+    std::string scene;
+    Samples current;
+    if (!loadSide(options.currentFiles, scene, current) || !checkSampleCount("Current", current, options.minSamples))
+        return 2;
+
+    if (!options.saveBaseline.empty())
+    {
+        if (!saveBaseline(options.saveBaseline, scene, current))
+        {
+            std::fprintf(stderr, "Failed to write %s\n", options.saveBaseline.c_str());
+            return 2;
+        }
+        std::printf("Saved %zu runs of %zu files to %s\n", current.size(), options.currentFiles.size(), options.saveBaseline.c_str());
+        if (options.baselineFiles.empty())
+            return 0;
+    }
+
+    std::string baselineScene;
+    Samples baseline;
+    if (!loadSide(options.baselineFiles, baselineScene, baseline) || !checkSampleCount("Baseline", baseline, options.minSamples))
+        return 2;
+    if (baselineScene != scene)
+    {
+        std::fprintf(stderr, "Baseline was measured on \"%s\", results on \"%s\"\n", baselineScene.c_str(), scene.c_str());
+        return 2;
+    }
+
+    const uint32_t failures = compare(baseline, current, options);
+    if (failures)
+    {
+        std::printf("%u metric(s) regressed\n", failures);
+        return 1;
+    }
+    std::printf("No regression\n");
+    return 0;
+}
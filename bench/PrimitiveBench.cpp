@@ -0,0 +1,233 @@
+#include "Bench.h"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RayPrimitives.h"
+
+using namespace Bench;
+using namespace RayPrimitives;
+
+namespace
+{
+    // Rays from 10 units away aimed at a 2x2 square through the origin, facing them. Shapes are sized so that
+    // about hitRatio of that square is covered, which sets the hit ratio.
+    // Coherent rays share their origin and sweep the square in raster order, random rays come from any
+    // direction and aim anywhere in the square. points holds the aimed points, for the distance functions.
+    struct Workload
+    {
+        RayBatch rays;
+        RayBatch points;
+        float sphereRadius;
+        float boxHalfExtent;
+    };
+
+    Workload makeWorkload(uint32_t count, bool coherent, float hitRatio, uint32_t seed)
+    {
+        Workload w;
+        w.rays.resize(count);
+        w.points.resize(count);
+        w.sphereRadius = 2.0f * std::sqrt(hitRatio / 3.14159265f);
+        w.boxHalfExtent = std::sqrt(hitRatio);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        const uint32_t side = (uint32_t)std::ceil(std::sqrt((float)count));
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float3 origin(0, 0, -10);
+            float3 u(1, 0, 0), v(0, 1, 0);
+            float a, b;
+            if (coherent)
+            {
+                a = ((float)(i % side) + 0.5f) / (float)side * 2.0f - 1.0f;
+                b = ((float)(i / side) + 0.5f) / (float)side * 2.0f - 1.0f;
+            }
+            else
+            {
+                float3 direction;
+                do
+                    direction = float3(unit(rng), unit(rng), unit(rng));
+                while (dot(direction, direction) > 1.0f || dot(direction, direction) < 1e-4f);
+                direction = normalize(direction);
+                origin = direction * 10.0f;
+                const float3 helper = std::fabs(direction.y) < 0.9f ? float3(0, 1, 0) : float3(1, 0, 0);
+                u = normalize(cross(helper, direction));
+                v = cross(direction, u);
+                a = unit(rng);
+                b = unit(rng);
+            }
+
+            const float3 target = u * a + v * b;
+            w.rays.set(i, {origin, normalize(target - origin)});
+            w.points.set(i, {target, float3(0, 0, 1)});
+        }
+        return w;
+    }
+
+    struct Outputs
+    {
+        std::vector<float> sphere, slab, sdf;
+        std::vector<uint8_t> line;
+    };
+
+    Outputs runAll(const BatchKernels& kernels, const Workload& w)
+    {
+        const uint32_t count = w.rays.size();
+        const float e = w.boxHalfExtent;
+        Outputs out{std::vector<float>(count), std::vector<float>(count), std::vector<float>(count), std::vector<uint8_t>(count)};
+        kernels.sphere(w.rays, float3(0, 0, 0), w.sphereRadius, out.sphere.data());
+        kernels.slabBox(w.rays, float3(-e, -e, -e), float3(e, e, e), out.slab.data());
+        kernels.sdBox(w.points, float3(e, e, e), out.sdf.data());
+        kernels.lineBox(w.rays, float3(0, 0, 0), float3(e, e, e), out.line.data());
+        return out;
+    }
+
+    // Equal hits, distances within FMA rounding; a handful of grazing rays may flip
+    bool sameDistances(const std::vector<float>& a, const std::vector<float>& b, uint32_t& flips)
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (std::isinf(a[i]) != std::isinf(b[i]))
+                ++flips;
+            else if (!std::isinf(a[i]) && std::fabs(a[i] - b[i]) > 1e-4f * std::max(1.0f, std::fabs(a[i])))
+                return false;
+        }
+        return true;
+    }
+
+    bool checkPrimitives(uint32_t seed)
+    {
+        bool ok = true;
+        const Workload w = makeWorkload(1003, false, 0.5f, seed);
+        const float e = w.boxHalfExtent;
+        const Outputs scalar = runAll(*batchKernels(Isa::Scalar), w);
+
+        // Batch scalar against the one ray ports
+        uint32_t hits = 0;
+        for (uint32_t i = 0; i < w.rays.size(); ++i)
+        {
+            const Ray ray{float3(w.rays.ox[i], w.rays.oy[i], w.rays.oz[i]), float3(w.rays.dx[i], w.rays.dy[i], w.rays.dz[i])};
+            const Hit sphere = intersectSphere(ray, float3(0, 0, 0), w.sphereRadius);
+            const Hit box = intersectBox(ray, float3(-e, -e, -e), float3(e, e, e));
+            ok &= sphere.hit == !std::isinf(scalar.sphere[i]) && (!sphere.hit || sphere.distance == scalar.sphere[i]);
+            ok &= box.hit == !std::isinf(scalar.slab[i]) && (!box.hit || box.distance == scalar.slab[i]);
+            // Rays start outside of the box: the line test and the slab test agree
+            ok &= (scalar.line[i] != 0) == box.hit;
+            hits += box.hit;
+        }
+        ok &= hits > 0 && hits < w.rays.size();
+
+        // Known values
+        ok &= sdBox(float3(3, 0, 0), float3(1, 1, 1)) == 2.0f && sdBox(float3(0, 0, 0), float3(1, 2, 3)) == -1.0f;
+        const Hit sphere = intersectSphere({float3(0, 0, -5), float3(0, 0, 1)}, float3(0, 0, 0), 1.0f);
+        ok &= sphere.hit && sphere.distance == 4.0f && sphere.normal.z == -1.0f;
+        ok &= !intersectSphere({float3(0, 0, 0), float3(0, 0, 1)}, float3(0, 0, 0), 1.0f).hit;
+        const Hit box = intersectBox({float3(-5, 0.5f, 0.5f), float3(1, 0, 0)}, float3(0, 0, 0), float3(1, 1, 1));
+        ok &= box.hit && box.distance == 5.0f && box.normal.x == -1.0f;
+        // Passing below the box: rejected only with |WxD|, the shader accepts it
+        ok &= !lineIntersectsBox(float3(-5, -3, 0), float3(1, 0, 0), float3(0, 0, 0), float3(1, 1, 1));
+
+        // Every SIMD variant against scalar; 1003 rays leave a tail in both widths
+        for (uint32_t isa = (uint32_t)Isa::SSE; isa < (uint32_t)Isa::Count; ++isa)
+        {
+            const BatchKernels* kernels = batchKernels((Isa)isa);
+            if (!kernels)
+                continue;
+            const Outputs simd = runAll(*kernels, w);
+            uint32_t flips = 0;
+            ok &= sameDistances(scalar.sphere, simd.sphere, flips) && sameDistances(scalar.slab, simd.slab, flips);
+            for (size_t i = 0; i < scalar.sdf.size(); ++i)
+                ok &= std::fabs(scalar.sdf[i] - simd.sdf[i]) <= 1e-5f;
+            for (size_t i = 0; i < scalar.line.size(); ++i)
+                flips += scalar.line[i] != simd.line[i];
+            ok &= flips <= 2;
+        }
+        return ok;
+    }
+
+    template <typename Run>
+    double nsPerTest(uint32_t count, uint64_t minTests, Run run)
+    {
+        const uint32_t repeats = (uint32_t)std::max<uint64_t>(1, minTests / count);
+        run();
+        const auto start = Clock::now();
+        for (uint32_t r = 0; r < repeats; ++r)
+            run();
+        return secondsSince(start) * 1e9 / ((double)repeats * count);
+    }
+}
+
+void Bench::runPrimitives(const Options& options)
+{
+    report("prims", "check", checkPrimitives(options.seed) ? 1.0 : 0.0, "ok");
+
+    // Batch small enough to stay in L2, the cost measured is the test and not memory
+    const uint32_t count = 4096;
+    const uint64_t minTests = options.quick ? 1u << 20 : 1u << 24;
+    const float hitRatios[] = {0.1f, 0.5f, 0.9f};
+
+    std::vector<float> distance(count);
+    std::vector<uint8_t> hit(count);
+    double sink = 0;
+
+    for (bool coherent : {true, false})
+    {
+        for (float hitRatio : hitRatios)
+        {
+            const Workload w = makeWorkload(count, coherent, hitRatio, options.seed);
+            const float e = w.boxHalfExtent;
+            const std::string suffix = std::string(coherent ? ".coherent." : ".random.") + std::to_string((int)(hitRatio * 100));
+
+            // Measured hit ratio of each shape, the box one depends on the ray directions
+            const Outputs reference = runAll(*batchKernels(Isa::Scalar), w);
+            uint32_t sphereHits = 0, boxHits = 0, inside = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                sphereHits += !std::isinf(reference.sphere[i]);
+                boxHits += !std::isinf(reference.slab[i]);
+                inside += reference.sdf[i] < 0.0f;
+            }
+            report("prims", ("sphere" + suffix + ".hits").c_str(), 100.0 * sphereHits / count, "%");
+            report("prims", ("box" + suffix + ".hits").c_str(), 100.0 * boxHits / count, "%");
+            report("prims", ("sdbox" + suffix + ".inside").c_str(), 100.0 * inside / count, "%");
+
+            for (uint32_t isa = 0; isa < (uint32_t)Isa::Count; ++isa)
+            {
+                const BatchKernels* kernels = batchKernels((Isa)isa);
+                if (!kernels)
+                    continue;
+                const std::string name = std::string(".") + isaName((Isa)isa) + suffix;
+
+                report("prims", ("sphere" + name).c_str(), nsPerTest(count, minTests, [&]
+                {
+                    kernels->sphere(w.rays, float3(0, 0, 0), w.sphereRadius, distance.data());
+                    sink += distance[count / 2];
+                }), "ns/test");
+                report("prims", ("aabb.line" + name).c_str(), nsPerTest(count, minTests, [&]
+                {
+                    kernels->lineBox(w.rays, float3(0, 0, 0), float3(e, e, e), hit.data());
+                    sink += hit[count / 2];
+                }), "ns/test");
+                report("prims", ("aabb.slab" + name).c_str(), nsPerTest(count, minTests, [&]
+                {
+                    kernels->slabBox(w.rays, float3(-e, -e, -e), float3(e, e, e), distance.data());
+                    sink += distance[count / 2];
+                }), "ns/test");
+                report("prims", ("sdbox" + name).c_str(), nsPerTest(count, minTests, [&]
+                {
+                    kernels->sdBox(w.points, float3(e, e, e), distance.data());
+                    sink += distance[count / 2];
+                }), "ns/test");
+            }
+        }
+    }
+
+    for (uint32_t isa = 0; isa < (uint32_t)Isa::Count; ++isa)
+        report("prims", (std::string("available.") + isaName((Isa)isa)).c_str(), isAvailable((Isa)isa) ? 1.0 : 0.0, "bool");
+    if (sink == 0.123)
+        std::printf("%f\n", sink);
+}
@@ -0,0 +1,117 @@
+#include "Bench.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Profiler.h"
+
+using namespace Bench;
+
+namespace
+{
+    size_t countOf(const std::string& text, const char* pattern)
+    {
+        size_t count = 0;
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+            ++count;
+        return count;
+    }
+
+    bool checkProfiler()
+    {
+        // Zones are recorded between begin and end capture only, per thread, and ordered inside a thread
+        Profiler profiler;
+
+        // Naming threads allocates no event buffer, capturing or not
+        std::thread named([&profiler] { profiler.setThreadName("named"); });
+        named.join();
+        bool ok = profiler.memoryBytes() == 0;
+
+        profiler.recordZone("before", profiler.now(), profiler.now());
+
+        profiler.beginCapture();
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < 3; ++t)
+        {
+            threads.emplace_back([&profiler, t]
+            {
+                profiler.setThreadName(t == 0 ? "first" : "other");
+                for (uint32_t i = 0; i < 100; ++i)
+                {
+                    const uint64_t start = profiler.now();
+                    profiler.recordCounter("iteration", i);
+                    profiler.recordZone("work", start, profiler.now());
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        profiler.endCapture();
+
+        // "before" was recorded directly, capture only gates the macros and ProfileZone
+        ok &= profiler.recordedEvents() == 1 + 3 * 200 && profiler.droppedEvents() == 0;
+
+        const std::string trace = profiler.chromeTrace();
+        ok &= countOf(trace, "\"ph\":\"X\"") == 1 + 300 && countOf(trace, "\"ph\":\"C\"") == 300;
+        ok &= countOf(trace, "\"thread_name\"") == 4 && countOf(trace, "\"first\"") == 1;
+        ok &= trace.front() == '{' && trace.find("\"traceEvents\":[") != std::string::npos;
+
+        // A full buffer drops instead of growing
+        std::thread flood([&profiler]
+        {
+            for (uint32_t i = 0; i < Profiler::eventsPerThread + 5; ++i)
+                profiler.recordCounter("flood", i);
+        });
+        flood.join();
+        ok &= profiler.droppedEvents() == 5;
+
+        ok &= profiler.memoryBytes() == 5 * Profiler::eventsPerThread * sizeof(Profiler::Event);
+
+        profiler.clear();
+        ok &= profiler.recordedEvents() == 0 && profiler.droppedEvents() == 0 && profiler.memoryBytes() == 0;
+        return ok;
+    }
+
+    double zoneCostNs(uint32_t count)
+    {
+        const auto start = Clock::now();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            RAYVOX_ZONE("bench zone");
+        }
+        return secondsSince(start) * 1e9 / count;
+    }
+}
+
+void Bench::runProfiler(const Options& options)
+{
+    report("profile", "check", checkProfiler() ? 1.0 : 0.0, "ok");
+
+    // Cost of one zone when nobody captures, and when capturing into the global profiler
+    const uint32_t zoneCount = options.quick ? 20000 : Profiler::eventsPerThread - 1;
+    Profiler& profiler = Profiler::get();
+    const bool wasCapturing = profiler.isCapturing();
+
+    profiler.endCapture();
+    report("profile", "zone.idle", zoneCostNs(zoneCount), "ns");
+
+    profiler.beginCapture();
+    const uint64_t recordedBefore = profiler.recordedEvents();
+    const double captureCost = zoneCostNs(zoneCount);
+    const uint64_t recorded = profiler.recordedEvents() - recordedBefore;
+    if (!wasCapturing)
+    {
+        profiler.endCapture();
+        profiler.clear();
+    }
+
+#if defined(RAYVOX_PROFILER)
+    report("profile", "zone.capturing", captureCost, "ns");
+    report("profile", "zone.recorded", (double)recorded, "events");
+#else
+    // Compiled out: nothing may be recorded
+    report("profile", "compiled_out.check", recorded == 0 ? 1.0 : 0.0, "ok");
+    (void)captureCost;
+#endif
+}
@@ -0,0 +1,161 @@
+#include "Bench.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CPURaytracer.h"
+#include "JobSystem.h"
+#include "RayQuery.h"
+
+using namespace VoxelDataStructs;
+using namespace Bench;
+
+namespace
+{
+    struct RayBatch
+    {
+        std::vector<Ray> rays;
+        std::vector<float> tMax;
+    };
+
+    // Primary rays from a camera above the terrain, looking at its centre
+    RayBatch makePrimaryRays(const World& world, uint32_t count, uint32_t seed)
+    {
+        const float3 center((float)world.sizeInVoxels(0) * 0.5f, 0, (float)world.sizeInVoxels(2) * 0.5f);
+        const float3 pos(center.x, (float)world.sizeInVoxels(1), -10);
+        const CameraView camera = lookAlong(pos, center - pos);
+
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> pixel(0.0f, 1024.0f);
+        RayBatch batch;
+        batch.rays.resize(count);
+        batch.tMax.assign(count, 1000.0f);
+        for(Ray& ray : batch.rays)
+            ray = CPURaytracer::generateRay(pixel(gen), pixel(gen), 1024.0f, 1024.0f, camera);
+        return batch;
+    }
+
+    // Shadow rays toward a low sun from every primary hit, like a deferred shadow pass would cast them
+    RayBatch makeShadowRays(const World& world, const RayBatch& primary)
+    {
+        const float3 toSun = normalize(float3(0.6f, 0.5f, 0.3f));
+        RayBatch batch;
+        for(const Ray& ray : primary.rays)
+        {
+            const Hit hit = CPURaytracer::traceClosest(world, ray, 0.0f, 1000.0f);
+            if (!hit.hit)
+                continue;
+            batch.rays.push_back({hit.hitPoint + hit.normal * 1e-3f, toSun});
+            batch.tMax.push_back(1000.0f);
+        }
+        return batch;
+    }
+
+    void measure(const char* name, const World& world, const RayBatch& batch, JobSystem& jobs)
+    {
+        const size_t count = batch.rays.size();
+        std::vector<uint8_t> occluded(count);
+        std::string label;
+
+        uint64_t closestSteps = 0;
+        uint32_t closestHits = 0;
+        auto start = Clock::now();
+        for(size_t i = 0; i < count; ++i)
+        {
+            const Hit hit = CPURaytracer::traceClosest(world, batch.rays[i], 0.0f, batch.tMax[i]);
+            closestSteps += hit.steps;
+            closestHits += hit.hit;
+        }
+        double seconds = secondsSince(start);
+        label = std::string(name) + ".closest";
+        report("rays", label.c_str(), (double)count / seconds * 1e-6, "Mrays/s");
+        label = std::string(name) + ".closest.steps";
+        report("rays", label.c_str(), (double)closestSteps / (double)count, "steps/ray");
+
+        uint32_t anySteps = 0, anyHits = 0;
+        start = Clock::now();
+        for(size_t i = 0; i < count; ++i)
+            anyHits += CPURaytracer::traceAny(world, batch.rays[i], 0.0f, batch.tMax[i], &anySteps);
+        seconds = secondsSince(start);
+        label = std::string(name) + ".any";
+        report("rays", label.c_str(), (double)count / seconds * 1e-6, "Mrays/s");
+        label = std::string(name) + ".any.steps";
+        report("rays", label.c_str(), (double)anySteps / (double)count, "steps/ray");
+
+        start = Clock::now();
+        const uint64_t batchSteps = CPURaytracer::traceAnyBatch(world, batch.rays, 0.0f, batch.tMax, occluded, &jobs);
+        seconds = secondsSince(start);
+        label = std::string(name) + ".any.batch";
+        report("rays", label.c_str(), (double)count / seconds * 1e-6, "Mrays/s");
+
+        uint32_t batchHits = 0;
+        for(uint8_t o : occluded)
+            batchHits += o;
+        if (batchHits != anyHits || anyHits != closestHits || batchSteps != anySteps)
+            std::printf("rays     %s: any-hit and closest-hit disagree (%u, %u, %u)\n", name, closestHits, anyHits, batchHits);
+    }
+
+    // Gameplay style queries: short rays in random directions from anywhere in the world, a quarter of them
+    // line of sight checks that only need any hit
+    std::vector<RayQuery::Request> makeGameplayRequests(const World& world, uint32_t count, uint32_t seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::normal_distribution<float> gauss;
+        std::vector<RayQuery::Request> requests(count);
+        for(RayQuery::Request& request : requests)
+        {
+            request.origin = float3(unit(gen) * (float)world.sizeInVoxels(0), unit(gen) * (float)world.sizeInVoxels(1),
+                                    unit(gen) * (float)world.sizeInVoxels(2));
+            request.direction = normalize(float3(gauss(gen), gauss(gen), gauss(gen)));
+            request.maxDistance = 64.0f;
+            request.flags = unit(gen) < 0.25f ? RayQuery::AnyHit : RayQuery::None;
+        }
+        return requests;
+    }
+
+    void measureBatch(const World& world, uint32_t count, uint32_t seed, JobSystem& jobs)
+    {
+        const std::vector<RayQuery::Request> requests = makeGameplayRequests(world, count, seed);
+        std::vector<RayQuery::Result> results(count);
+
+        for(bool sorted : {false, true})
+        {
+            // Small batches run in well under a millisecond, repeat them to get a stable number
+            const uint32_t repeats = std::max(1u, 100000u / count);
+            RayQuery::BatchStats batchStats;
+            const auto start = Clock::now();
+            for(uint32_t i = 0; i < repeats; ++i)
+                batchStats = RayQuery::cast(world, requests, results, &jobs, sorted);
+            const double seconds = secondsSince(start) / repeats;
+
+            const std::string label = "batch." + std::to_string(count) + (sorted ? ".sorted" : ".unsorted");
+            report("rays", label.c_str(), (double)count / seconds * 1e-6, "Mrays/s");
+            if (sorted)
+                report("rays", ("batch." + std::to_string(count) + ".steps").c_str(),
+                       (double)batchStats.traversalSteps / (double)count, "steps/ray");
+        }
+    }
+}
+
+void Bench::runRays(const Options& options)
+{
+    JobSystem jobs(options.threads);
+
+    World world = makeWorld(options, jobs);
+
+    const RayBatch primary = makePrimaryRays(world, options.quick ? 16384 : 262144, options.seed);
+    const RayBatch shadow = makeShadowRays(world, primary);
+
+    report("rays", "workers", jobs.workerCount() + 1, "threads");
+    measure("primary", world, primary, jobs);
+    measure("shadow", world, shadow, jobs);
+
+    for(uint32_t count : {1000u, 100000u, 1000000u})
+    {
+        if (options.quick && count > 100000u)
+            break;
+        measureBatch(world, count, options.seed, jobs);
+    }
+}
@@ -0,0 +1,91 @@
+#include "Bench.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Suite
+    {
+        const char* name;
+        void (*run)(const Bench::Options&);
+    };
+
+    const Suite suites[] = {
+        {"sdf", &Bench::runSDF},
+        {"rays", &Bench::runRays},
+        {"backend", &Bench::runBackend},
+        {"frames", &Bench::runFramePacing},
+        {"upload", &Bench::runUploadRing},
+        {"desc", &Bench::runDescriptors},
+        {"shaders", &Bench::runShaderCache},
+        {"kernels", &Bench::runKernels},
+        {"delta", &Bench::runDelta},
+        {"resid", &Bench::runResidency},
+        {"input", &Bench::runInput},
+        {"loop", &Bench::runLoop},
+        {"path", &Bench::runCameraPath},
+        {"profile", &Bench::runProfiler},
+        {"prims", &Bench::runPrimitives},
+        {"memory", &Bench::runMemory},
+        {"heatmap", &Bench::runHeatmap},
+    };
+
+    void printUsage()
+    {
+        std::printf("Usage: RayVox_Bench [suite ...] [--threads N] [--seed S] [--quick]\nSuites:");
+        for(const Suite& suite : suites)
+            std::printf(" %s", suite.name);
+        std::printf("\nWithout suite every one of them runs.\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Bench::Options options;
+    std::vector<std::string> selected;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+            options.threads = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc)
+            options.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--quick"))
+            options.quick = true;
+        else if (!std::strcmp(argv[i], "--help"))
+        {
+            printUsage();
+            return 0;
+        }
+        else if (argv[i][0] == '-')
+        {
+            printUsage();
+            return 1;
+        }
+        else
+            selected.emplace_back(argv[i]);
+    }
+
+    bool ranAny = false;
+    for(const Suite& suite : suites)
+    {
+        bool wanted = selected.empty();
+        for(const std::string& name : selected)
+            wanted |= name == suite.name;
+        if (!wanted)
+            continue;
+
+        suite.run(options);
+        ranAny = true;
+    }
+
+    if (!ranAny)
+    {
+        printUsage();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Frustum.h"
+#include "ResidencyManager.h"
+
+using namespace Bench;
+
+namespace
+{
+    // Small scripted runs: order of evictions, degrade before drop, protection of visible chunks, churn
+    bool checkResidency()
+    {
+        bool ok = true;
+        {
+            const std::vector<ResidencyManager::LodCost> costs = {{8, 8}, {4, 4}, {1, 1}};
+            ResidencyManager residency(4, {20, 20}, costs);
+            residency.visibilityWindow = 2;
+
+            const VisibleChunk first[] = {{0, 0.0f}, {1, 0.0f}};
+            const VisibleChunk second[] = {{2, 0.0f}, {3, 0.0f}};
+            residency.markVisible(first, 100.0f);
+            residency.update();
+            ok &= residency.cpuBytes() == 16 && residency.changes().size() == 2;
+
+            // Chunks 2 and 3 come in while 0 and 1 are still protected: overrun
+            residency.markVisible(second, 100.0f);
+            residency.update();
+            ok &= residency.cpuBytes() == 32 && residency.counters().overrunFrames == 1;
+
+            // Out of the window, 0 and 1 get coarser one level per round until it fits
+            residency.markVisible(second, 100.0f);
+            residency.update();
+            ok &= residency.residentLod(0) == 2 && residency.residentLod(1) == 2 && residency.residentLod(2) == 0;
+            ok &= residency.counters().degrades == 4 && residency.counters().drops == 0 && residency.cpuBytes() == 18;
+
+            // Back in view right after: refined again, which is churn
+            residency.markVisible(first, 100.0f);
+            residency.update();
+            ok &= residency.residentLod(0) == 0 && residency.counters().refines == 2 && residency.counters().churn == 2;
+        }
+        {
+            const std::vector<ResidencyManager::LodCost> costs = {{8, 8}, {4, 4}};
+            ResidencyManager residency(2, {8, 8}, costs);
+            residency.visibilityWindow = 1;
+
+            const VisibleChunk first[] = {{0, 0.0f}};
+            const VisibleChunk second[] = {{1, 0.0f}};
+            residency.markVisible(first, 100.0f);
+            residency.update();
+            residency.markVisible(second, 100.0f);
+            residency.update();
+            // Degraded then dropped, the coarser level alone still does not fit
+            ok &= residency.residentLod(0) == ResidencyManager::notResident && residency.residentLod(1) == 0;
+            ok &= residency.counters().degrades == 1 && residency.counters().drops == 1;
+            ok &= residency.counters().overrunFrames == 0;
+        }
+        return ok;
+    }
+}
+
+void Bench::runResidency(const Options& options)
+{
+    report("resid", "residency.check", checkResidency() ? 1.0 : 0.0, "ok");
+
+    // Flight over a large streamed world, only chunk bounds are needed
+    constexpr int32_t side = 48;
+    const float chunk = (float)VoxelDataStructs::chunkSize;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    for(int32_t z = 0; z < side; ++z)
+        for(int32_t x = 0; x < side; ++x)
+        {
+            minX.push_back(x * chunk);
+            minY.push_back(0);
+            minZ.push_back(z * chunk);
+            maxX.push_back((x + 1) * chunk);
+            maxY.push_back(chunk);
+            maxZ.push_back((z + 1) * chunk);
+        }
+    const uint32_t chunkCount = side * side;
+    std::vector<uint8_t> inside(chunkCount);
+    std::vector<VisibleChunk> visible;
+
+    // What the view needs at full resolution is well above the budget, levels of detail make it fit
+    ResidencyManager residency(chunkCount, {256ull << 20, 192ull << 20});
+
+    const uint32_t frameCount = options.quick ? 300 : 3000;
+    const float worldSize = side * chunk;
+    double updateSeconds = 0;
+    uint64_t changes = 0;
+    uint64_t peakCpu = 0, peakGpu = 0;
+    uint32_t maxVisible = 0;
+    for(uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        // Circles around the centre, looking ahead
+        const float angle = (float)frame * 0.01f;
+        CameraView camera = lookAlong(float3(worldSize * 0.5f + std::cos(angle) * worldSize * 0.3f, 96.0f,
+                                             worldSize * 0.5f + std::sin(angle) * worldSize * 0.3f),
+                                      float3(-std::sin(angle), -0.2f, std::cos(angle)), 70);
+        camera.Zfar = 1024.0f;
+
+        Frustum::fromCamera(camera, 16.0f / 9.0f).cullBoxes(minX.data(), minY.data(), minZ.data(),
+                                                            maxX.data(), maxY.data(), maxZ.data(), chunkCount, inside.data());
+        visible.clear();
+        for(uint32_t c = 0; c < chunkCount; ++c)
+        {
+            if (!inside[c])
+                continue;
+            const float3 closest = min(max(camera.pos, float3(minX[c], minY[c], minZ[c])), float3(maxX[c], maxY[c], maxZ[c]));
+            visible.push_back({c, length(closest - camera.pos)});
+        }
+        maxVisible = std::max(maxVisible, (uint32_t)visible.size());
+
+        const auto start = Clock::now();
+        residency.markVisible(visible, 192.0f);
+        residency.update();
+        updateSeconds += secondsSince(start);
+
+        changes += residency.changes().size();
+        peakCpu = std::max(peakCpu, residency.cpuBytes());
+        peakGpu = std::max(peakGpu, residency.gpuBytes());
+    }
+
+    const ResidencyManager::Counters& counters = residency.counters();
+    report("resid", "update", updateSeconds * 1e6 / frameCount, "us/frame");
+    report("resid", "visible.max", maxVisible, "chunks");
+    report("resid", "resident", residency.residentCount(), "chunks");
+    report("resid", "cpu.peak", (double)peakCpu / (1 << 20), "MiB");
+    report("resid", "gpu.peak", (double)peakGpu / (1 << 20), "MiB");
+    report("resid", "changes", (double)changes / frameCount, "changes/frame");
+    report("resid", "loads", (double)counters.loads, "chunks");
+    report("resid", "refines", (double)counters.refines, "chunks");
+    report("resid", "degrades", (double)counters.degrades, "chunks");
+    report("resid", "drops", (double)counters.drops, "chunks");
+    report("resid", "churn", (double)counters.churn, "chunks");
+    report("resid", "overrun", (double)counters.overrunFrames, "frames");
+}
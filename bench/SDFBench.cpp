@@ -0,0 +1,212 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "JobSystem.h"
+#include "SDFBrickVolume.h"
+
+using namespace VoxelDataStructs;
+
+namespace
+{
+    // Port of the sdBox / DE pair of ComputeShader_raymarch.hlsl, one box per solid voxel
+    float sdBox(const float3& p, const float3& b)
+    {
+        float3 q = abs(p) - b;
+        return length(max(q, float3(0, 0, 0))) + std::min(std::max(q.x, std::max(q.y, q.z)), 0.0f);
+    }
+
+    struct AnalyticScene
+    {
+        std::vector<float3> centers;
+
+        float distance(const float3& p) const
+        {
+            float d = 999999999.0f;
+            for(const float3& c : centers)
+                d = std::min(d, sdBox(p - c, float3(0.5f, 0.5f, 0.5f)));
+            return d;
+        }
+
+        Hit trace(const Ray& ray, float tMax, uint32_t maxSteps) const
+        {
+            Hit hit;
+            float t = 0;
+            for(uint32_t i = 0; i < maxSteps && t < tMax; ++i)
+            {
+                ++hit.steps;
+                const float d = distance(ray.origin + ray.direction * t);
+                if (d < 1e-3f)
+                {
+                    hit.hit = true;
+                    hit.distance = t;
+                    return hit;
+                }
+                t += d;
+            }
+            return hit;
+        }
+    };
+
+    std::vector<Ray> makeRays(uint32_t count, const CameraView& camera, uint32_t seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> pixel(0.0f, 512.0f);
+        std::vector<Ray> rays(count);
+        for(Ray& ray : rays)
+            ray = CPURaytracer::generateRay(pixel(gen), pixel(gen), 512.0f, 512.0f, camera);
+        return rays;
+    }
+
+    CameraView lookAt(const float3& pos, const float3& target)
+    {
+        return Bench::lookAlong(pos, target - pos);
+    }
+
+    // Largest difference between the lookups of two volumes
+    float maxDifference(const SDFBrickVolume& volume, const SDFBrickVolume& reference, const World& world,
+                        uint32_t count, uint32_t seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> x(0.0f, (float)world.sizeInVoxels(0));
+        std::uniform_real_distribution<float> y(0.0f, (float)world.sizeInVoxels(1));
+        std::uniform_real_distribution<float> z(0.0f, (float)world.sizeInVoxels(2));
+        float worst = 0;
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            const float3 p(x(gen), y(gen), z(gen));
+            worst = std::max(worst, std::fabs(volume.distance(p) - reference.distance(p)));
+        }
+        return worst;
+    }
+}
+
+void Bench::runSDF(const Options& options)
+{
+    JobSystem jobs(options.threads);
+
+    // Same scene as the compute shaders: a 64x64 slab of voxels, 4096 sdBox per DE() call
+    {
+        World world;
+        world.init(1, 1, 1);
+        AnalyticScene analytic;
+        for(int32_t i = 0; i < 64; ++i)
+        {
+            for(int32_t j = 0; j < 64; ++j)
+            {
+                world.setVoxel(i, 0, j, 0xFFFFFFFFu);
+                analytic.centers.emplace_back((float)i + 0.5f, 0.5f, (float)j + 0.5f);
+            }
+        }
+
+        SDFBrickVolume volume;
+        auto start = Clock::now();
+        volume.build(world, &jobs);
+        report("sdf", "slab.build", secondsSince(start) * 1e3, "ms");
+
+        std::mt19937 gen(options.seed);
+        std::uniform_real_distribution<float> coord(0.0f, 64.0f);
+        std::vector<float3> points(options.quick ? 1000 : 10000);
+        for(float3& p : points)
+            p = float3(coord(gen), coord(gen) * 0.25f, coord(gen));
+
+        volatile float sink = 0;
+        start = Clock::now();
+        for(const float3& p : points)
+            sink = sink + analytic.distance(p);
+        report("sdf", "slab.eval.analytic", secondsSince(start) * 1e9 / (double)points.size(), "ns/eval");
+
+        start = Clock::now();
+        for(const float3& p : points)
+            sink = sink + volume.distance(p);
+        report("sdf", "slab.eval.bricks", secondsSince(start) * 1e9 / (double)points.size(), "ns/eval");
+
+        const std::vector<Ray> rays = makeRays(options.quick ? 256 : 2048, lookAt({32, 20, -20}, {32, 0, 32}), options.seed);
+        uint64_t analyticSteps = 0, brickSteps = 0;
+        uint32_t analyticHits = 0, brickHits = 0;
+
+        start = Clock::now();
+        for(const Ray& ray : rays)
+        {
+            const Hit hit = analytic.trace(ray, 200.0f, 256);
+            analyticSteps += hit.steps;
+            analyticHits += hit.hit;
+        }
+        report("sdf", "slab.trace.analytic", secondsSince(start) * 1e9 / (double)rays.size(), "ns/ray");
+
+        start = Clock::now();
+        for(const Ray& ray : rays)
+        {
+            const Hit hit = volume.trace(world, ray, 0.0f, 200.0f);
+            brickSteps += hit.steps;
+            brickHits += hit.hit;
+        }
+        report("sdf", "slab.trace.bricks", secondsSince(start) * 1e9 / (double)rays.size(), "ns/ray");
+
+        report("sdf", "slab.steps.analytic", (double)analyticSteps / (double)rays.size(), "steps/ray");
+        report("sdf", "slab.steps.bricks", (double)brickSteps / (double)rays.size(), "steps/ray");
+        report("sdf", "slab.hits.analytic", analyticHits, "rays");
+        report("sdf", "slab.hits.bricks", brickHits, "rays");
+    }
+
+    // Terrain, too many voxels for the analytic DE, compared with the plain DDA instead
+    {
+        World world = makeWorld(options, jobs);
+
+        SDFBrickVolume volume;
+        auto start = Clock::now();
+        volume.build(world, &jobs);
+        report("sdf", "terrain.build", secondsSince(start) * 1e3, "ms");
+        report("sdf", "terrain.bricks", volume.allocatedBrickCount(), "bricks");
+        report("sdf", "terrain.memory", (double)volume.memoryBytes() / (1024.0 * 1024.0), "MiB");
+
+        const float3 center((float)world.sizeInVoxels(0) * 0.5f, 0, (float)world.sizeInVoxels(2) * 0.5f);
+        const std::vector<Ray> rays = makeRays(options.quick ? 4096 : 65536,
+                                               lookAt({center.x, (float)world.sizeInVoxels(1), -10}, center), options.seed);
+
+        uint64_t ddaSteps = 0, brickSteps = 0;
+        uint32_t mismatches = 0;
+        std::vector<Hit> ddaHits(rays.size());
+
+        start = Clock::now();
+        for(size_t i = 0; i < rays.size(); ++i)
+        {
+            ddaHits[i] = CPURaytracer::traceClosest(world, rays[i], 0.0f, 1000.0f);
+            ddaSteps += ddaHits[i].steps;
+        }
+        report("sdf", "terrain.trace.dda", secondsSince(start) * 1e9 / (double)rays.size(), "ns/ray");
+
+        start = Clock::now();
+        for(size_t i = 0; i < rays.size(); ++i)
+        {
+            const Hit hit = volume.trace(world, rays[i], 0.0f, 1000.0f);
+            brickSteps += hit.steps;
+            mismatches += hit.hit != ddaHits[i].hit || (hit.hit && hit.voxel != ddaHits[i].voxel);
+        }
+        report("sdf", "terrain.trace.bricks", secondsSince(start) * 1e9 / (double)rays.size(), "ns/ray");
+        report("sdf", "terrain.steps.dda", (double)ddaSteps / (double)rays.size(), "steps/ray");
+        report("sdf", "terrain.steps.bricks", (double)brickSteps / (double)rays.size(), "steps/ray");
+        report("sdf", "terrain.mismatches", mismatches, "rays");
+
+        // Editing one voxel only rebuilds the bricks around it whose samples can move, every other edit carves
+        std::mt19937 gen(options.seed);
+        std::uniform_int_distribution<int32_t> x(0, world.sizeInVoxels(0) - 1), z(0, world.sizeInVoxels(2) - 1);
+        const uint32_t edits = options.quick ? 32 : 256;
+        start = Clock::now();
+        for(uint32_t i = 0; i < edits; ++i)
+        {
+            const int32_t ex = x(gen), ey = world.sizeInVoxels(1) / 2, ez = z(gen);
+            world.setVoxel(ex, ey, ez, i % 2 ? 0u : 0xFF0000FFu);
+            volume.updateVoxel(world, ex, ey, ez);
+        }
+        report("sdf", "terrain.update", secondsSince(start) * 1e6 / edits, "us/edit");
+
+        SDFBrickVolume rebuilt;
+        rebuilt.build(world, &jobs);
+        const float updateError = maxDifference(volume, rebuilt, world, options.quick ? 100000 : 1000000, options.seed);
+        report("sdf", "terrain.update.check", updateError == 0.0f ? 1.0 : 0.0, "ok");
+    }
+}
@@ -0,0 +1,89 @@
+#include "Bench.h"
+
+#include <fstream>
+#include <thread>
+
+#include "ShaderCache.h"
+
+namespace
+{
+    using namespace Bench;
+
+    // Pretends to compile: the "bytecode" is the source behind a marker, after a delay standing for FXC
+    class StubCompiler : public ShaderCompiler
+    {
+    public:
+        uint32_t compiles = 0;
+        std::chrono::microseconds delay{0};
+
+        std::string version() const override { return "stub_1"; }
+
+        bool compile(const ShaderDesc& desc, const std::string& source,
+                     std::vector<uint8_t>& bytecode, std::string& errors) override
+        {
+            ++compiles;
+            std::this_thread::sleep_for(delay);
+            if (source.find("error") != std::string::npos)
+            {
+                errors = desc.file.string() + ": error";
+                return false;
+            }
+            bytecode.assign({'D', 'X', 'B', 'C'});
+            bytecode.insert(bytecode.end(), source.begin(), source.end());
+            return true;
+        }
+    };
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+}
+
+void Bench::runShaderCache(const Options& options)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "rayvox_shader_cache_bench";
+    std::filesystem::remove_all(directory);
+
+    // Startup with a few kernel variants, first with an empty cache then with a warm one
+    const uint32_t variantCount = options.quick ? 8 : 32;
+    const std::filesystem::path shaders = directory / "src";
+    std::filesystem::create_directories(shaders);
+    std::string source;
+    for (int i = 0; i < 4096; ++i)
+        source += "// padding to the size of a real kernel\n";
+    writeFile(shaders / "Kernel.hlsl", source);
+
+    StubCompiler compiler;
+    compiler.delay = std::chrono::milliseconds(5);
+    const auto startup = [&](double& seconds)
+    {
+        ShaderCache cache(directory / "cache", compiler);
+        const auto start = Clock::now();
+        std::vector<uint8_t> bytecode;
+        std::string errors;
+        for (uint32_t i = 0; i < variantCount; ++i)
+        {
+            ShaderDesc desc;
+            desc.file = shaders / "Kernel.hlsl";
+            desc.target = "cs_5_0";
+            desc.defines.push_back({"VARIANT", std::to_string(i)});
+            cache.load(desc, bytecode, errors);
+        }
+        seconds = secondsSince(start);
+        return cache.stats();
+    };
+
+    double coldSeconds = 0;
+    double warmSeconds = 0;
+    const ShaderCache::Stats cold = startup(coldSeconds);
+    const ShaderCache::Stats warm = startup(warmSeconds);
+
+    report("shaders", "cold.startup", coldSeconds * 1e3, "ms");
+    report("shaders", "cold.misses", (double)cold.misses, "shaders");
+    report("shaders", "warm.startup", warmSeconds * 1e3, "ms");
+    report("shaders", "warm.hits", (double)warm.hits, "shaders");
+    report("shaders", "warm.load", warmSeconds * 1e6 / variantCount, "us/shader");
+
+    std::filesystem::remove_all(directory);
+}
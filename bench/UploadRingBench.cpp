@@ -0,0 +1,67 @@
+#include "Bench.h"
+
+#include <random>
+#include <vector>
+
+#include "FrameScheduler.h"
+#include "SimulatedGpuQueue.h"
+#include "UploadRing.h"
+
+namespace
+{
+    struct CameraConstants
+    {
+        float data[12];
+    };
+}
+
+void Bench::runUploadRing(const Options& options)
+{
+    constexpr uint64_t capacity = 4 * 1024 * 1024;
+    // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, for chunk data copied into textures
+    constexpr uint64_t chunkDataAlignment = 512;
+
+    std::vector<uint8_t> memory(capacity);
+    SimulatedGpuQueue queue;
+    FrameScheduler scheduler(queue, 3);
+    UploadRing ring(memory.data(), capacity, queue);
+
+    std::mt19937 gen(options.seed);
+    // Dirty chunk ranges, from a few voxels to a whole brick layer
+    std::uniform_int_distribution<uint32_t> chunkBytes(256, 96 * 1024);
+    std::uniform_int_distribution<uint32_t> dirtyChunks(0, 24);
+
+    const uint32_t frameCount = options.quick ? 60 : 600;
+    double allocSeconds = 0;
+    uint64_t bytes = 0;
+    const auto start = Clock::now();
+    for(uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        scheduler.beginFrame();
+
+        const auto allocStart = Clock::now();
+        const UploadRing::Allocation camera = ring.upload(CameraConstants{});
+        bytes += camera.size;
+        const uint32_t count = dirtyChunks(gen);
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            const UploadRing::Allocation allocation = ring.allocate(chunkBytes(gen), chunkDataAlignment);
+            bytes += allocation.size;
+        }
+        allocSeconds += secondsSince(allocStart);
+
+        queue.submit(std::chrono::microseconds(1000));
+        ring.finishFrame(scheduler.endFrame());
+    }
+    scheduler.waitIdle();
+    const double seconds = secondsSince(start);
+
+    const UploadRing::Stats& stats = ring.stats();
+    report("upload", "alloc", allocSeconds * 1e9 / (double)stats.allocations, "ns/alloc");
+    report("upload", "bytes", (double)bytes / frameCount / 1024.0, "KiB/frame");
+    report("upload", "frame", seconds * 1e3 / frameCount, "ms/frame");
+    report("upload", "peak", (double)stats.peakUsedBytes / (double)capacity * 100.0, "% of ring");
+    report("upload", "wasted", (double)stats.wastedBytes / (double)stats.allocatedBytes * 100.0, "% of bytes");
+    report("upload", "stalls", (double)stats.stalls, "allocations");
+    report("upload", "failures", (double)stats.failures, "allocations");
+}
@@ -1,11 +1,15 @@
 #include "App.h"
 
+#include <timeapi.h> // timeBeginPeriod
+
 #include <chrono>
 #include <iostream>
 #include <algorithm>
 #include <cassert>
 
 #include "AssertUtils.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
 
 #define MYICON 101
 
@@ -56,37 +60,15 @@ namespace App
 
     void Resize(uint32_t width, uint32_t height)
     {
+        if (clientWidth != width || clientHeight != height)
+        {
+            // Don't allow 0 size swap chain back buffers.
+            clientWidth = std::max(1u, width);
+            clientHeight = std::max(1u, height);
 
-//        if (clientWidth != width || clientHeight != height)
-//        {
-//            // Don't allow 0 size swap chain back buffers.
-//            clientWidth = std::max(1u, width );
-//            clientHeight = std::max(1u, height);
-//
-//            // Flush the GPU queue to make sure the swap chain's back buffers
-//            // are not being referenced by an in-flight command list.
-//
-//            dx_cctx.directCommandQueue->Flush();
-//            dx_cctx.computeCommandQueue->Flush();
-//            dx_cctx.copyCommandQueue->Flush();
-//
-//            for (int i = 0; i < dx_cctx.bufferCount; ++i)
-//            {
-//                // Any references to the back buffers must be released
-//                // before the swap chain can be resized.
-//                dx_cctx.backBuffers[i].Reset();
-//            }
-//            DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
-//            ThrowIfFailed(dx_cctx.swapChain->GetDesc(&swapChainDesc));
-//            ThrowIfFailed(dx_cctx.swapChain->ResizeBuffers(dx_cctx.bufferCount, clientWidth, clientHeight,
-//                                                           swapChainDesc.BufferDesc.Format, swapChainDesc.Flags));
-//
-//            dx_cctx.currentBackBufferIndex = dx_cctx.swapChain->GetCurrentBackBufferIndex();
-//
-//            dx_cctx.UpdateRenderTargetViews(dx_cctx.device, dx_cctx.swapChain, dx_cctx.RTVDescriptorHeap);
-//            dx_cctx.UpdateFrameBuffers(dx_cctx.device, dx_cctx.swapChain, dx_cctx.CBV_SRV_UAVDescriptorHeap);
-//        }
-
+            viewAspectRatio.store((float)clientWidth / (float)clientHeight, std::memory_order_relaxed);
+            renderBackend->resize(clientWidth, clientHeight);
+        }
     }
 
     void SetFullscreen(bool fullscreen)
@@ -157,16 +139,97 @@ namespace App
             sprintf_s(buffer, 500, "FPS: %f\n", fps);
             std::cout << buffer;
 
+            std::cout << "Memory:";
+            for (uint32_t tag = 0; tag < (uint32_t)MemoryTag::Count; ++tag)
+            {
+                const MemoryTracker::TagStats stats = MemoryTracker::stats((MemoryTag)tag);
+                sprintf_s(buffer, 500, " %s %.1f MB (peak %.1f)", MemoryTracker::tagName((MemoryTag)tag),
+                          (double)stats.currentBytes / (1024.0 * 1024.0), (double)stats.peakBytes / (1024.0 * 1024.0));
+                std::cout << buffer;
+            }
+            std::cout << "\n";
+
             frameCounter = 0;
             elapsedSeconds = 0.0;
 
         }
     }
 
+    void ParseCommandLine()
+    {
+        int argc = 0;
+        LPWSTR* argv = ::CommandLineToArgvW(::GetCommandLineW(), &argc);
+        for (int i = 1; i + 1 < argc; ++i)
+        {
+            if (wcscmp(argv[i], L"--trace") == 0)
+            {
+                traceFile = argv[++i];
+                continue;
+            }
+            if (wcscmp(argv[i], L"--record") == 0)
+                pathMode = PathMode::Record;
+            else if (wcscmp(argv[i], L"--replay") == 0)
+                pathMode = PathMode::Replay;
+            else
+                continue;
+            pathFile = argv[++i];
+        }
+        ::LocalFree(argv);
+    }
+
+    void ReplayTick()
+    {
+        static std::chrono::steady_clock::time_point start;
+        if (replayTick == 0)
+            start = std::chrono::steady_clock::now();
+
+        const CameraView view = cameraPath.view(replayTick);
+        camera.pos = {view.pos.x, view.pos.y, view.pos.z};
+        camera.forward = {view.forward.x, view.forward.y, view.forward.z};
+        camera.right = {view.right.x, view.right.y, view.right.z};
+        XMStoreFloat3(&camera.up, XMVector3Cross(camera.getForwardVec(), camera.getRightVec()));
+        camera.fov = view.fov;
+        camera.Znear = view.Znear;
+        camera.Zfar = view.Zfar;
+
+        if (++replayTick == cameraPath.tickCount())
+        {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "Replayed " << replayTick << " ticks in " << seconds << " s, "
+                      << seconds * 1e3 / replayTick << " ms/frame\n";
+            ::PostMessageW(hWnd, WM_CLOSE, 0, 0);
+        }
+    }
+
+    void Tick(double dt)
+    {
+        camera.aspectRatio = viewAspectRatio.load(std::memory_order_relaxed);
+        if (pathMode == PathMode::Replay)
+        {
+            // Once the path is over the last pose stays until the window closes
+            if (replayTick < cameraPath.tickCount())
+                ReplayTick();
+            return;
+        }
+
+        inputManager.processTickInput();
+        if (pathMode == PathMode::Record)
+            cameraPath.record(camera.getCameraView());
+    }
+
+    void RenderFrame(const FrameSnapshot& snapshot)
+    {
+        if (uint64_t size = pendingResize.exchange(0, std::memory_order_acquire))
+            Resize(uint32_t(size >> 32), uint32_t(size & 0xFFFFFFFFu));
+
+        Update();
+        renderBackend->frame(snapshot.camera);
+    }
+
     // Window callback function.
     LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
     {
-        if ( dx_cctx.isInitialized )
+        if ( renderBackend->isReady() )
         {
 
             inputManager.manageInput(message, wParam, lParam);
@@ -184,11 +247,8 @@ namespace App
                 break;
 
                 case WM_PAINT:
-                    Update();
-                    dx_cctx.render();
-                    inputManager.processTickInput();
-
-                    break;
+                    // Frames come from the render thread, only validate the window here
+                    return ::DefWindowProcW(hwnd, message, wParam, lParam);
                 case WM_SYSKEYDOWN:
                 case WM_KEYDOWN:
                 {
@@ -222,7 +282,8 @@ namespace App
                     int width = clientRect.right - clientRect.left;
                     int height = clientRect.bottom - clientRect.top;
 
-                    Resize(width, height);
+                    const uint64_t size = (uint64_t(std::max(1, width)) << 32) | uint32_t(std::max(1, height));
+                    pendingResize.store(size, std::memory_order_release);
                 }
                 break;
                 case WM_SETFOCUS:
@@ -309,6 +370,10 @@ namespace App
         RedirectIOToConsole();
 #endif
 
+        if (!traceFile.empty())
+            Profiler::get().beginCapture();
+        RAYVOX_THREAD_NAME("Window");
+
         // Windows 10 Creators update adds Per Monitor V2 DPI awareness context.
         // Using this awareness context allows the client area of the window
         // to achieve 100% scaling while still allowing non-client window content to
@@ -328,9 +393,57 @@ namespace App
 
         RegisterRawInputDevices(hWnd);
 
-        dx_cctx.init(hWnd, clientWidth, clientHeight);
-        inputManager.ctx = &dx_cctx;
+        camera = Camera({0,0,-10},{0,0,1},{0,1,0},
+                        80, (float)clientWidth/(float)clientHeight, 0.1f, 100);
+
+        renderBackend->init(hWnd, clientWidth, clientHeight);
+        inputManager.camera = &camera;
+        viewAspectRatio.store(camera.aspectRatio, std::memory_order_relaxed);
 
         ::ShowWindow(hWnd, SW_SHOW);
+
+        // Sleeps in the simulation thread wake up on time
+        timeBeginPeriod(1);
+        engineLoop = std::make_unique<EngineLoop>(tickRate, &Tick,
+                                                  [](FrameSnapshot& snapshot) { snapshot.camera = camera.getCameraView(); },
+                                                  &RenderFrame);
+
+        if (pathMode == PathMode::Replay && (!cameraPath.load(pathFile) || cameraPath.tickCount() == 0))
+        {
+            std::wcerr << L"Failed to load camera path " << pathFile.wstring() << std::endl;
+            pathMode = PathMode::None;
+        }
+        if (pathMode == PathMode::Record)
+            cameraPath.tickStep = 1.0 / tickRate;
+        engineLoop->lockstep = pathMode == PathMode::Replay;
+        engineLoop->start();
+    }
+
+    void ShutdownApp()
+    {
+        if (engineLoop)
+        {
+            engineLoop->stop();
+            engineLoop.reset();
+        }
+
+        if (pathMode == PathMode::Record)
+        {
+            if (cameraPath.save(pathFile))
+                std::cout << "Recorded " << cameraPath.tickCount() << " ticks, " << cameraPath.fileBytes() << " bytes\n";
+            else
+                std::wcerr << L"Failed to write camera path " << pathFile.wstring() << std::endl;
+        }
+        timeEndPeriod(1);
+
+        if (!traceFile.empty())
+        {
+            Profiler::get().endCapture();
+            if (Profiler::get().writeChromeTrace(traceFile))
+                std::cout << "Trace: " << Profiler::get().recordedEvents() << " events, "
+                          << Profiler::get().droppedEvents() << " dropped\n";
+            else
+                std::wcerr << L"Failed to write trace " << traceFile.wstring() << std::endl;
+        }
     }
 }
@@ -8,9 +8,14 @@
 #include <wrl.h>
 using namespace Microsoft::WRL;
 
+#include <atomic>
 #include <cstdint>
+#include <filesystem>
+#include <memory>
 
+#include "CameraPath.h"
 #include "DX12ComputeContext.h"
+#include "EngineLoop.h"
 #include "InputManager.h"
 
 namespace App
@@ -20,11 +25,42 @@ namespace App
     inline uint32_t clientWidth = 1024;
     inline uint32_t clientHeight = 1024;
 
+    inline Camera camera;
+
     inline DX12ComputeContext dx_cctx;
+    // Everything but the fullscreen switch goes through the backend interface
+    inline RenderBackend* renderBackend = &dx_cctx;
     inline InputManager inputManager;
 
+    // Simulation ticks at a fixed rate on its own thread, rendering runs on another one
+    inline constexpr double tickRate = 60.0;
+    inline std::unique_ptr<EngineLoop> engineLoop;
+
+    // Client size packed as width << 32 | height by WM_SIZE, 0 when nothing is pending.
+    // Applied by the render thread before its next frame.
+    inline std::atomic<uint64_t> pendingResize{0};
+    inline std::atomic<float> viewAspectRatio{1.0f};
+
     inline bool isWindowFocused = false;
 
+    // --record <file> saves the camera pose of every tick on exit, --replay <file> plays one back a tick per
+    // frame, whatever the frame times, then closes the window
+    enum class PathMode
+    {
+        None,
+        Record,
+        Replay
+    };
+    inline PathMode pathMode = PathMode::None;
+    inline std::filesystem::path pathFile;
+    inline CameraPath cameraPath;
+    inline uint32_t replayTick = 0;
+
+    // --trace <file> captures the profiler zones from startup and writes them as a Chrome trace on exit
+    inline std::filesystem::path traceFile;
+
+    void ParseCommandLine();
+
     void RedirectIOToConsole();
 
     HWND createWindow(const wchar_t* windowClassName, HINSTANCE hInst,
@@ -36,6 +72,12 @@ namespace App
 
     void Update();
 
+    // Simulation thread
+    void Tick(double dt);
+
+    // Render thread
+    void RenderFrame(const FrameSnapshot& snapshot);
+
     LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
 
     void RegisterWindowClass( HINSTANCE hInst, const wchar_t* windowClassName );
@@ -43,4 +85,7 @@ namespace App
     void RegisterRawInputDevices(HWND hwnd);
 
     void InitApp(HINSTANCE hInstance);
+
+    // Stops the simulation and render threads, call before flushing the backend.
+    void ShutdownApp();
 }
\ No newline at end of file
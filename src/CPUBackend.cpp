@@ -0,0 +1,25 @@
+#include "CPUBackend.h"
+
+#include <algorithm>
+
+void CPUBackend::init(void*, uint32_t width, uint32_t height)
+{
+    renderer.resize(width, height);
+    ready = true;
+}
+
+void CPUBackend::resize(uint32_t width, uint32_t height)
+{
+    renderer.resize(std::max(1u, width), std::max(1u, height));
+}
+
+void CPUBackend::render()
+{
+    renderer.render(world, camera);
+}
+
+void CPUBackend::present()
+{
+    presentedFrame = renderer.framebuffer;
+    ++presentedFrameCount;
+}
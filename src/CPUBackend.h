@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CPURenderer.h"
+#include "RenderBackend.h"
+
+// Headless backend, CPURenderer into memory. present() keeps a copy of the frame as a swapchain
+// would show it, so tools and benchmarks can read it back.
+class CPUBackend : public RenderBackend
+{
+public:
+    CPURenderer renderer;
+    TrackedVector<uint32_t, MemoryTag::Framebuffers> presentedFrame;
+    uint64_t presentedFrameCount = 0;
+
+    explicit CPUBackend(const VoxelDataStructs::World& world) : world(world) {}
+
+    void init(void* nativeWindow, uint32_t width, uint32_t height) override;
+    void resize(uint32_t width, uint32_t height) override;
+    void uploadCamera(const CameraView& newCamera) override { camera = newCamera; }
+    void render() override;
+    void present() override;
+    void flush() override {}
+    bool isReady() const override { return ready; }
+
+private:
+    const VoxelDataStructs::World& world;
+    CameraView camera{};
+    bool ready = false;
+};
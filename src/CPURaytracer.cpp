@@ -0,0 +1,231 @@
+#include "CPURaytracer.h"
+#include "JobSystem.h"
+
+#include <atomic>
+
+namespace CPURaytracer
+{
+    namespace
+    {
+        // tMinAxis is the axis of the face crossed at tMin when the caller knows it, for the normal of a hit there
+        template <bool anyHit>
+        Hit traverse(const World& world, const Ray& ray, float tMin, float tMax, int tMinAxis = -1)
+        {
+            Hit hit;
+
+            float3 dir = ray.direction;
+            for(int a = 0; a < 3; ++a)
+            {
+                // Avoid 0 * inf in the slab test for axis aligned rays
+                if (std::fabs(dir[a]) < 1e-8f)
+                    dir[a] = std::copysign(1e-8f, dir[a]);
+            }
+            const float3 invDir = float3(1, 1, 1) / dir;
+            const float3 worldMax((float)world.sizeInVoxels(0), (float)world.sizeInVoxels(1), (float)world.sizeInVoxels(2));
+
+            // Clip the ray against the world bounds
+            float3 t0s = (float3(0, 0, 0) - ray.origin) * invDir;
+            float3 t1s = (worldMax - ray.origin) * invDir;
+            float3 tsmaller = min(t0s, t1s);
+            float3 tbigger = max(t0s, t1s);
+
+            int entryAxis = tMinAxis;
+            float tEnter = tMin;
+            for(int a = 0; a < 3; ++a)
+            {
+                if (tsmaller[a] > tEnter)
+                {
+                    tEnter = tsmaller[a];
+                    entryAxis = a;
+                }
+            }
+            float tExit = std::min(tMax, std::min(tbigger.x, std::min(tbigger.y, tbigger.z)));
+            if (tEnter > tExit)
+                return hit;
+
+            float3 p = ray.origin + ray.direction * tEnter;
+            int3 cell;
+            int3 step;
+            float3 tNext;
+            float3 tDelta;
+            for(int a = 0; a < 3; ++a)
+            {
+                cell[a] = std::clamp((int32_t)std::floor(p[a]), 0, world.sizeInVoxels(a) - 1);
+                step[a] = dir[a] > 0 ? 1 : -1;
+                tDelta[a] = std::fabs(invDir[a]);
+                tNext[a] = ((float)cell[a] + (step[a] > 0 ? 1.0f : 0.0f) - ray.origin[a]) * invDir[a];
+            }
+
+            float t = tEnter;
+            int lastAxis = entryAxis;
+            while (t <= tExit)
+            {
+                ++hit.steps;
+
+                uint32_t color = world.voxelAt(cell.x, cell.y, cell.z);
+                if (color != 0)
+                {
+                    hit.hit = true;
+                    hit.distance = t;
+                    if constexpr (anyHit)
+                        return hit;
+
+                    hit.hitPoint = ray.origin + ray.direction * t;
+                    hit.voxel = cell;
+                    hit.color = color;
+
+                    // A ray starting inside a voxel has no entry face, use its dominant axis
+                    int axis = lastAxis;
+                    if (axis < 0)
+                    {
+                        float3 ad = abs(dir);
+                        axis = ad.x > ad.y ? (ad.x > ad.z ? 0 : 2) : (ad.y > ad.z ? 1 : 2);
+                    }
+                    hit.normal[axis] = (float)-step[axis];
+                    return hit;
+                }
+
+                int a = tNext.x < tNext.y ? (tNext.x < tNext.z ? 0 : 2) : (tNext.y < tNext.z ? 1 : 2);
+                t = tNext[a];
+                cell[a] += step[a];
+                tNext[a] += tDelta[a];
+                lastAxis = a;
+
+                if (cell[a] < 0 || cell[a] >= world.sizeInVoxels(a))
+                    break;
+            }
+
+            return hit;
+        }
+    }
+
+    Ray generateRay(float pixelX, float pixelY, float width, float height, const CameraView& camera)
+    {
+        float aspectRatio = width / height;
+        float ndcX = (pixelX / width) * 2.0f - 1.0f;
+        float ndcY = (pixelY / height) * 2.0f - 1.0f;
+
+        float tanFov = std::tan(radians(camera.fov) * 0.5f);
+        float3 up = cross(camera.right, camera.forward);
+
+        float3 right = camera.right * (tanFov * aspectRatio);
+        up *= tanFov;
+
+        Ray ray;
+        ray.origin = camera.pos;
+        ray.direction = normalize(ndcX * right + ndcY * up + camera.forward);
+        return ray;
+    }
+
+    bool projectToScreen(const float3& p, float width, float height, const CameraView& camera,
+                         float& pixelX, float& pixelY)
+    {
+        float3 d = p - camera.pos;
+        float z = dot(d, camera.forward);
+        if (z <= camera.Znear)
+            return false;
+
+        float aspectRatio = width / height;
+        float tanFov = std::tan(radians(camera.fov) * 0.5f);
+        float3 up = cross(camera.right, camera.forward);
+
+        float ndcX = dot(d, camera.right) / (z * tanFov * aspectRatio);
+        float ndcY = dot(d, up) / (z * tanFov);
+
+        pixelX = (ndcX + 1.0f) * 0.5f * width;
+        pixelY = (ndcY + 1.0f) * 0.5f * height;
+        return true;
+    }
+
+    bool clipToWorld(const World& world, const Ray& ray, float tMin, float tMax, float& tEnter, float& tExit)
+    {
+        tEnter = tMin;
+        tExit = tMax;
+        for(int a = 0; a < 3; ++a)
+        {
+            const float invDir = 1.0f / (std::fabs(ray.direction[a]) < 1e-8f ? std::copysign(1e-8f, ray.direction[a]) : ray.direction[a]);
+            float t0 = (0.0f - ray.origin[a]) * invDir;
+            float t1 = ((float)world.sizeInVoxels(a) - ray.origin[a]) * invDir;
+            if (t0 > t1)
+                std::swap(t0, t1);
+            tEnter = std::max(tEnter, t0);
+            tExit = std::min(tExit, t1);
+        }
+        return tEnter <= tExit;
+    }
+
+    Hit traceClosest(const World& world, const Ray& ray, float tMin, float tMax)
+    {
+        return traverse<false>(world, ray, tMin, tMax);
+    }
+
+    Hit traceClosest(const World& world, const Ray& ray, float tMin, float tMax, std::span<const VisibleChunk> chunks)
+    {
+        Hit best;
+        best.distance = tMax;
+        uint32_t steps = 0;
+
+        for(const VisibleChunk& visible : chunks)
+        {
+            // Every voxel of this chunk and of the next ones is behind the closest hit
+            if (visible.distance > best.distance)
+                break;
+
+            const VoxelDataStructs::Chunk& chunk = world.chunks[visible.chunk];
+            int axis = -1;
+            float tEnter = tMin;
+            float tExit = best.distance;
+            for(int a = 0; a < 3; ++a)
+            {
+                const float invDir = 1.0f / (std::fabs(ray.direction[a]) < 1e-8f ? std::copysign(1e-8f, ray.direction[a]) : ray.direction[a]);
+                float t0 = ((float)chunk.offsetPos[a] - ray.origin[a]) * invDir;
+                float t1 = ((float)(chunk.offsetPos[a] + VoxelDataStructs::chunkSize) - ray.origin[a]) * invDir;
+                if (t0 > t1)
+                    std::swap(t0, t1);
+                if (t0 > tEnter)
+                {
+                    tEnter = t0;
+                    axis = a;
+                }
+                tExit = std::min(tExit, t1);
+            }
+            if (tEnter > tExit)
+                continue;
+
+            Hit hit = traverse<false>(world, ray, tEnter, tExit, axis);
+            steps += hit.steps;
+            if (hit.hit && hit.distance <= best.distance)
+                best = hit;
+        }
+
+        best.steps = steps;
+        if (!best.hit)
+            best.distance = 0;
+        return best;
+    }
+
+    bool traceAny(const World& world, const Ray& ray, float tMin, float tMax, uint32_t* steps)
+    {
+        const Hit hit = traverse<true>(world, ray, tMin, tMax);
+        if (steps)
+            *steps += hit.steps;
+        return hit.hit;
+    }
+
+    uint64_t traceAnyBatch(const World& world, std::span<const Ray> rays, float tMin, std::span<const float> tMax,
+                           std::span<uint8_t> occluded, JobSystem* jobSystem)
+    {
+        constexpr uint32_t raysPerJob = 256;
+        std::atomic<uint64_t> totalSteps{0};
+
+        JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::get();
+        jobs.parallelFor((uint32_t)rays.size(), raysPerJob, [&](uint32_t begin, uint32_t end)
+        {
+            uint32_t steps = 0;
+            for(uint32_t i = begin; i < end; ++i)
+                occluded[i] = traceAny(world, rays[i], tMin, tMax[i], &steps);
+            totalSteps.fetch_add(steps, std::memory_order_relaxed);
+        });
+        return totalSteps.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <span>
+
+#include "VecMath.h"
+#include "VoxelDataStructs.h"
+
+// Same layout as the CameraBuffer constant buffer read by the compute shaders.
+struct CameraView
+{
+    float3 pos;
+    float Znear;
+    float3 forward;
+    float Zfar;
+    float3 right;
+    float fov;
+};
+
+struct Ray
+{
+    float3 origin;
+    float3 direction;
+};
+
+struct Hit
+{
+    bool hit = false;
+    float distance = 0;
+    float3 hitPoint;
+    float3 normal;
+    int3 voxel;
+    uint32_t color = 0;
+    // Number of cells visited by the traversal
+    uint32_t steps = 0;
+};
+
+class JobSystem;
+
+// Chunk that survived frustum culling, distance is from the camera to its bounding box.
+struct VisibleChunk
+{
+    uint32_t chunk;
+    float distance;
+};
+
+// CPU port of the shader ray generation and a DDA traversal of the voxel world.
+namespace CPURaytracer
+{
+    using VoxelDataStructs::World;
+
+    Ray generateRay(float pixelX, float pixelY, float width, float height, const CameraView& camera);
+
+    // Inverse of generateRay. Returns false when the point is behind the near plane.
+    bool projectToScreen(const float3& p, float width, float height, const CameraView& camera,
+                         float& pixelX, float& pixelY);
+
+    // Clips [tMin, tMax] to the world bounds, returns false when the ray misses them.
+    bool clipToWorld(const World& world, const Ray& ray, float tMin, float tMax, float& tEnter, float& tExit);
+
+    // Closest hit along the ray in [tMin, tMax], traversing cells with the Amanatides-Woo DDA.
+    Hit traceClosest(const World& world, const Ray& ray, float tMin, float tMax);
+
+    // Same query restricted to a front to back list of chunks, for rays starting where the chunk distances were
+    // measured from. Stops as soon as the next chunk starts behind the closest hit found so far.
+    Hit traceClosest(const World& world, const Ray& ray, float tMin, float tMax, std::span<const VisibleChunk> chunks);
+
+    // Occlusion query for shadow and visibility rays: stops on the first occupied cell, without normal nor color.
+    // Adds the number of visited cells to steps when given.
+    bool traceAny(const World& world, const Ray& ray, float tMin, float tMax, uint32_t* steps = nullptr);
+
+    // traceAny over a batch split across the job system, ray i tested in [tMin, tMax[i]], result in occluded[i].
+    // Returns the total number of visited cells. nullptr uses JobSystem::get().
+    uint64_t traceAnyBatch(const World& world, std::span<const Ray> rays, float tMin, std::span<const float> tMax,
+                           std::span<uint8_t> occluded, JobSystem* jobSystem = nullptr);
+}
@@ -0,0 +1,495 @@
+#include "CPURenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "JobSystem.h"
+#include "Profiler.h"
+
+using VoxelDataStructs::World;
+
+void CPURenderer::resize(uint32_t newWidth, uint32_t newHeight)
+{
+    if (width == newWidth && height == newHeight)
+        return;
+
+    width = newWidth;
+    height = newHeight;
+
+    const size_t pixelCount = size_t(width) * height;
+    framebuffer.assign(pixelCount, 0);
+    history.assign(pixelCount, {});
+    nextHistory.assign(pixelCount, {});
+    reprojectedSource.assign(pixelCount, invalidIndex);
+    reprojectedDepth.assign(pixelCount, 0);
+    frameDepth.assign(pixelCount, 0);
+
+    invalidateHistory();
+}
+
+size_t CPURenderer::memoryBytes() const
+{
+    return (framebuffer.capacity() + referenceFramebuffer.capacity() + reprojectedSource.capacity()) * sizeof(uint32_t) +
+           (history.capacity() + nextHistory.capacity()) * sizeof(HistorySample) +
+           (reprojectedDepth.capacity() + frameDepth.capacity()) * sizeof(float) + occupancy.cells.capacity();
+}
+
+void CPURenderer::invalidateHistory()
+{
+    historyValid = false;
+}
+
+void CPURenderer::render(const World& world, const CameraView& camera)
+{
+    RAYVOX_ZONE("CPURenderer::render");
+    stats = {};
+    stats.pixelCount = width * height;
+
+    if (world.revision != historyWorldRevision)
+        invalidateHistory();
+
+    if (useTraversalKernel)
+    {
+        const TraversalKernel& selected = TraversalKernels::select(kernelConfig);
+        if (kernel != &selected || occupancy.revision != world.revision || occupancy.cells.empty())
+        {
+            RAYVOX_ZONE("build occupancy");
+            kernel = &selected;
+            kernel->build(world, kernelConfig.chunkDim, kernelConfig.layout, occupancy, jobSystem);
+        }
+    }
+    else if (useChunkCulling)
+    {
+        chunkCuller.update(world, camera, (float)width / (float)height);
+        stats.visibleChunks = chunkCuller.stats.visible;
+        stats.culledChunks = chunkCuller.stats.culled;
+    }
+
+    const bool haveHistory = historyValid && (useTemporalReprojection || samplingMode != SamplingMode::Full);
+    if (haveHistory)
+    {
+        RAYVOX_ZONE("reproject history");
+        reprojectHistory(camera);
+    }
+
+    const CostView view = costView;
+    if (view != CostView::None)
+        costBuffer.assign(size_t(width) * height, 0.0f);
+
+    forEachTile([&](uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, FrameStats& tileStats)
+    {
+        for(uint32_t y = y0; y < y1; ++y)
+        {
+            for(uint32_t x = x0; x < x1; ++x)
+            {
+                if (!isTracedThisFrame(x, y))
+                    continue;
+
+                const uint32_t i = x + y * width;
+                Hit hit;
+                if (view == CostView::None)
+                {
+                    hit = tracePixel(world, camera, x, y, haveHistory && useTemporalReprojection, tileStats);
+                }
+                else if (view == CostView::TraversalSteps)
+                {
+                    const uint64_t stepsBefore = tileStats.traversalSteps;
+                    hit = tracePixel(world, camera, x, y, haveHistory && useTemporalReprojection, tileStats);
+                    costBuffer[i] = (float)(tileStats.traversalSteps - stepsBefore);
+                }
+                else
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    hit = tracePixel(world, camera, x, y, haveHistory && useTemporalReprojection, tileStats);
+                    costBuffer[i] = (float)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start).count();
+                }
+
+                framebuffer[i] = shade(hit);
+                frameDepth[i] = hit.hit ? hit.distance : std::numeric_limits<float>::max();
+                nextHistory[i] = hit.hit ? HistorySample{hit.hitPoint, world.voxelId(hit.voxel.x, hit.voxel.y, hit.voxel.z), framebuffer[i]}
+                                         : HistorySample{};
+            }
+        }
+    });
+
+    // Second pass, reconstruction reads the neighbours traced by other tiles
+    if (samplingMode != SamplingMode::Full)
+    {
+        forEachTile([&](uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, FrameStats& tileStats)
+        {
+            for(uint32_t y = y0; y < y1; ++y)
+            {
+                for(uint32_t x = x0; x < x1; ++x)
+                {
+                    if (!isTracedThisFrame(x, y))
+                        reconstructPixel(x, y, haveHistory, tileStats);
+                }
+            }
+        });
+    }
+
+    if (measureAgainstReference)
+    {
+        renderReference(world, camera);
+        stats.referenceDiff = compareImages(framebuffer, referenceFramebuffer);
+    }
+
+    // Last, the shaded colors were needed by the reconstruction and the reference diff
+    if (view != CostView::None)
+    {
+        buildCostHistogram();
+        writeHeatmap();
+    }
+
+    RAYVOX_COUNTER("traversal steps", stats.traversalSteps);
+    RAYVOX_COUNTER("reused pixels", stats.reusedPixels);
+
+    history.swap(nextHistory);
+    historyFrustum = Frustum::fromCamera(camera, (float)width / (float)height);
+    historyValid = true;
+    historyWorldRevision = world.revision;
+    ++frameIndex;
+}
+
+void CPURenderer::forEachTile(const std::function<void(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, FrameStats& tileStats)>& body)
+{
+    const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+    const uint32_t tileCount = tilesX * tilesY;
+
+    // Counters are kept per tile and summed afterwards so tiles never share a cache line
+    tileStats.assign(tileCount, {});
+
+    JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::get();
+    jobs.parallelFor(tileCount, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for(uint32_t tile = begin; tile < end; ++tile)
+        {
+            RAYVOX_ZONE("tile");
+            const uint32_t x0 = (tile % tilesX) * tileSize;
+            const uint32_t y0 = (tile / tilesX) * tileSize;
+            body(x0, y0, std::min(width, x0 + tileSize), std::min(height, y0 + tileSize), tileStats[tile]);
+        }
+    });
+
+    for(const FrameStats& t : tileStats)
+    {
+        stats.reusedPixels += t.reusedPixels;
+        stats.tracedPixels += t.tracedPixels;
+        stats.validationSegments += t.validationSegments;
+        stats.validationSteps += t.validationSteps;
+        stats.reconstructedFromHistory += t.reconstructedFromHistory;
+        stats.reconstructedSpatially += t.reconstructedSpatially;
+        stats.traversalSteps += t.traversalSteps;
+    }
+}
+
+bool CPURenderer::isTracedThisFrame(uint32_t x, uint32_t y) const
+{
+    switch (samplingMode)
+    {
+        case SamplingMode::Checkerboard:
+            return ((x + y + frameIndex) & 1) == 0;
+        case SamplingMode::Interleaved4:
+            return ((x & 1) | ((y & 1) << 1)) == (frameIndex & 3);
+        default:
+            return true;
+    }
+}
+
+void CPURenderer::reprojectHistory(const CameraView& camera)
+{
+    std::fill(reprojectedSource.begin(), reprojectedSource.end(), invalidIndex);
+    std::fill(reprojectedDepth.begin(), reprojectedDepth.end(), std::numeric_limits<float>::max());
+
+    // Forward splat of last frame's hits with a depth test, pixels left empty are disoccluded
+    for(uint32_t i = 0; i < history.size(); ++i)
+    {
+        const HistorySample& sample = history[i];
+        if (sample.voxelId == invalidIndex)
+            continue;
+
+        float px, py;
+        if (!CPURaytracer::projectToScreen(sample.hitPoint, (float)width, (float)height, camera, px, py))
+            continue;
+
+        const long x = std::lround(px);
+        const long y = std::lround(py);
+        if (x < 0 || y < 0 || x >= (long)width || y >= (long)height)
+            continue;
+
+        const uint32_t target = uint32_t(x + y * width);
+        const float depth = length(sample.hitPoint - camera.pos);
+        if (depth < reprojectedDepth[target])
+        {
+            reprojectedDepth[target] = depth;
+            reprojectedSource[target] = i;
+        }
+    }
+}
+
+Hit CPURenderer::tracePixel(const World& world, const CameraView& camera, uint32_t x, uint32_t y, bool reproject,
+                            FrameStats& counters)
+{
+    const Ray ray = CPURaytracer::generateRay((float)x, (float)y, (float)width, (float)height, camera);
+
+    const uint32_t source = reproject ? reprojectedSource[x + y * width] : invalidIndex;
+    if (source != invalidIndex)
+    {
+        const HistorySample& sample = history[source];
+
+        // Only trace a short segment around where last frame's surface is expected along this pixel's ray.
+        // A hit at the very start of the segment means something now sits in front of it.
+        const float tExpected = dot(sample.hitPoint - camera.pos, ray.direction);
+        const float tStart = std::max(camera.Znear, tExpected - reprojectionSegment);
+        Hit hit = traceClosest(world, ray, tStart, tExpected + reprojectionSegment);
+        counters.traversalSteps += hit.steps;
+        counters.validationSteps += hit.steps;
+        ++counters.validationSegments;
+
+        if (hit.hit && hit.distance > tStart &&
+            (world.voxelId(hit.voxel.x, hit.voxel.y, hit.voxel.z) == sample.voxelId ||
+             std::fabs(hit.distance - tExpected) < 1.0f))
+        {
+            // The segment cannot see an occluder wholly in front of it. Last frame saw the part of the ray inside
+            // its frustum and any surface there would have splatted over this pixel, unless it fell in a gap of
+            // the splat: the whole front is tested next to nearer or missing neighbours, otherwise only the part
+            // last frame could not see.
+            const float tUnseen = mayBeOccluded(x, y) ? tStart : historyFrustum.enterDistance(ray, camera.Znear, tStart);
+            uint32_t occlusionSteps = 0;
+            const bool occluded = tUnseen > camera.Znear &&
+                                  CPURaytracer::traceAny(world, ray, camera.Znear, tUnseen, &occlusionSteps);
+            counters.traversalSteps += occlusionSteps;
+            counters.validationSteps += occlusionSteps;
+            if (!occluded)
+            {
+                ++counters.reusedPixels;
+                return hit;
+            }
+        }
+    }
+
+    ++counters.tracedPixels;
+    Hit hit = useChunkCulling && !useTraversalKernel
+                      ? CPURaytracer::traceClosest(world, ray, camera.Znear, camera.Zfar, chunkCuller.visible)
+                      : traceClosest(world, ray, camera.Znear, camera.Zfar);
+    counters.traversalSteps += hit.steps;
+    return hit;
+}
+
+// A gap in the splat of a nearer surface shows through to what was behind it, next to pixels that reprojected
+// much closer or not at all
+bool CPURenderer::mayBeOccluded(uint32_t x, uint32_t y) const
+{
+    const float depth = reprojectedDepth[x + y * width];
+    for(int dy = -1; dy <= 1; ++dy)
+    {
+        for(int dx = -1; dx <= 1; ++dx)
+        {
+            const int nx = (int)x + dx;
+            const int ny = (int)y + dy;
+            if (nx < 0 || ny < 0 || nx >= (int)width || ny >= (int)height)
+                return true;
+            const uint32_t n = nx + ny * width;
+            if (reprojectedSource[n] == invalidIndex || reprojectedDepth[n] < depth - reprojectionSegment)
+                return true;
+        }
+    }
+    return false;
+}
+
+Hit CPURenderer::traceClosest(const World& world, const Ray& ray, float tMin, float tMax) const
+{
+    if (!useTraversalKernel)
+        return CPURaytracer::traceClosest(world, ray, tMin, tMax);
+
+    Hit hit;
+    kernel->trace(occupancy, std::span<const Ray>(&ray, 1), tMin, tMax, std::span<Hit>(&hit, 1));
+    if (hit.hit)
+        hit.color = world.voxelAt(hit.voxel.x, hit.voxel.y, hit.voxel.z);
+    return hit;
+}
+
+void CPURenderer::reconstructPixel(uint32_t x, uint32_t y, bool haveHistory, FrameStats& counters)
+{
+    const uint32_t i = x + y * width;
+
+    // Neighbours traced this frame, the 3x3 window holds at least one for both sampling patterns
+    uint32_t sum[3] = {0, 0, 0};
+    uint32_t count = 0;
+    float minDepth = std::numeric_limits<float>::max();
+    float maxDepth = 0;
+    for(int dy = -1; dy <= 1; ++dy)
+    {
+        for(int dx = -1; dx <= 1; ++dx)
+        {
+            const int nx = (int)x + dx;
+            const int ny = (int)y + dy;
+            if (nx < 0 || ny < 0 || nx >= (int)width || ny >= (int)height || !isTracedThisFrame(nx, ny))
+                continue;
+
+            const uint32_t n = nx + ny * width;
+            const uint32_t c = framebuffer[n];
+            sum[0] += c & 0xFF;
+            sum[1] += (c >> 8) & 0xFF;
+            sum[2] += (c >> 16) & 0xFF;
+            minDepth = std::min(minDepth, frameDepth[n]);
+            maxDepth = std::max(maxDepth, frameDepth[n]);
+            ++count;
+        }
+    }
+
+    // Last frame's sample is kept if its reprojected depth fits between the freshly traced neighbours,
+    // otherwise it is most likely a disocclusion or an edge that moved
+    const uint32_t source = haveHistory ? reprojectedSource[i] : invalidIndex;
+    if (source != invalidIndex)
+    {
+        const float depth = reprojectedDepth[i];
+        const float tolerance = 1.0f + 0.05f * depth;
+        if (count == 0 || (depth >= minDepth - tolerance && depth <= maxDepth + tolerance))
+        {
+            framebuffer[i] = history[source].color;
+            frameDepth[i] = depth;
+            nextHistory[i] = history[source];
+            ++counters.reconstructedFromHistory;
+            return;
+        }
+    }
+
+    if (count == 0)
+        count = 1;
+    framebuffer[i] = (sum[0] / count) | ((sum[1] / count) << 8) | ((sum[2] / count) << 16) | 0xFF000000u;
+    frameDepth[i] = minDepth;
+    nextHistory[i] = {};
+    ++counters.reconstructedSpatially;
+}
+
+void CPURenderer::renderReference(const World& world, const CameraView& camera)
+{
+    referenceFramebuffer.resize(framebuffer.size());
+
+    forEachTile([&](uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, FrameStats&)
+    {
+        for(uint32_t y = y0; y < y1; ++y)
+        {
+            for(uint32_t x = x0; x < x1; ++x)
+            {
+                const Ray ray = CPURaytracer::generateRay((float)x, (float)y, (float)width, (float)height, camera);
+                referenceFramebuffer[x + y * width] = shade(CPURaytracer::traceClosest(world, ray, camera.Znear, camera.Zfar));
+            }
+        }
+    });
+}
+
+uint32_t CPURenderer::shade(const Hit& hit)
+{
+    if (!hit.hit)
+        return 0xFF000000u;
+
+    // Flat per face lighting so the voxel edges stay readable
+    const float light = hit.normal.y != 0 ? 1.0f : (hit.normal.x != 0 ? 0.8f : 0.6f);
+
+    const uint32_t r = uint32_t(float(hit.color & 0xFF) * light);
+    const uint32_t g = uint32_t(float((hit.color >> 8) & 0xFF) * light);
+    const uint32_t b = uint32_t(float((hit.color >> 16) & 0xFF) * light);
+    return r | (g << 8) | (b << 16) | 0xFF000000u;
+}
+
+uint32_t CostHistogram::binOf(float cost)
+{
+    if (cost < 1.0f)
+        return 0;
+    const uint32_t bin = (uint32_t)std::ilogb(cost) + 1;
+    return std::min(bin, binCount - 1);
+}
+
+void CPURenderer::buildCostHistogram()
+{
+    costHistogram = {};
+    sortedCosts.clear();
+    for(uint32_t y = 0; y < height; ++y)
+    {
+        for(uint32_t x = 0; x < width; ++x)
+        {
+            if (isTracedThisFrame(x, y))
+                sortedCosts.push_back(costBuffer[x + y * width]);
+        }
+    }
+    if (sortedCosts.empty())
+        return;
+
+    double sum = 0;
+    for(float cost : sortedCosts)
+    {
+        ++costHistogram.bins[CostHistogram::binOf(cost)];
+        sum += cost;
+    }
+    std::sort(sortedCosts.begin(), sortedCosts.end());
+
+    // Nearest rank
+    const auto percentile = [&](double p)
+    {
+        const size_t rank = (size_t)std::ceil(p / 100.0 * (double)sortedCosts.size());
+        return (double)sortedCosts[std::clamp<size_t>(rank, 1, sortedCosts.size()) - 1];
+    };
+    costHistogram.samples = (uint32_t)sortedCosts.size();
+    costHistogram.mean = sum / (double)sortedCosts.size();
+    costHistogram.p50 = percentile(50);
+    costHistogram.p95 = percentile(95);
+    costHistogram.p99 = percentile(99);
+    costHistogram.max = sortedCosts.back();
+}
+
+void CPURenderer::writeHeatmap()
+{
+    // Dark blue, blue, cyan, green, yellow, red
+    static constexpr float ramp[][3] = {{0.0f, 0.0f, 0.2f}, {0.0f, 0.2f, 1.0f}, {0.0f, 0.9f, 1.0f},
+                                        {0.1f, 1.0f, 0.2f}, {1.0f, 0.9f, 0.0f}, {1.0f, 0.0f, 0.0f}};
+    constexpr uint32_t segments = sizeof(ramp) / sizeof(ramp[0]) - 1;
+
+    const float scale = costScale > 0 ? costScale : std::max(1.0f, (float)costHistogram.p99);
+    for(size_t i = 0; i < framebuffer.size(); ++i)
+    {
+        const float t = std::clamp(costBuffer[i] / scale, 0.0f, 1.0f) * (float)segments;
+        const uint32_t s = std::min((uint32_t)t, segments - 1);
+        const float f = t - (float)s;
+
+        uint32_t color = 0xFF000000u;
+        for(int c = 0; c < 3; ++c)
+            color |= uint32_t((ramp[s][c] + (ramp[s + 1][c] - ramp[s][c]) * f) * 255.0f + 0.5f) << (8 * c);
+        framebuffer[i] = color;
+    }
+}
+
+ImageDiff compareImages(std::span<const uint32_t> a, std::span<const uint32_t> b)
+{
+    ImageDiff diff;
+    const size_t pixelCount = std::min(a.size(), b.size());
+    if (pixelCount == 0)
+        return diff;
+
+    uint64_t squaredError = 0;
+    size_t differing = 0;
+    for(size_t i = 0; i < pixelCount; ++i)
+    {
+        bool differs = false;
+        for(int shift = 0; shift < 24; shift += 8)
+        {
+            const int ca = int((a[i] >> shift) & 0xFF);
+            const int cb = int((b[i] >> shift) & 0xFF);
+            const uint32_t e = (uint32_t)std::abs(ca - cb);
+            squaredError += e * e;
+            diff.maxChannelError = std::max(diff.maxChannelError, e);
+            differs |= e != 0;
+        }
+        differing += differs;
+    }
+
+    diff.mse = (double)squaredError / (double)(pixelCount * 3);
+    diff.psnr = diff.mse > 0 ? 10.0 * std::log10(255.0 * 255.0 / diff.mse) : std::numeric_limits<double>::infinity();
+    diff.differingPercent = 100.0f * (float)differing / (float)pixelCount;
+    return diff;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "CPURaytracer.h"
+#include "Frustum.h"
+#include "MemoryTracker.h"
+#include "TraversalKernels.h"
+
+class JobSystem;
+
+struct ImageDiff
+{
+    double mse = 0;
+    // Infinite when both images are identical
+    double psnr = 0;
+    uint32_t maxChannelError = 0;
+    float differingPercent = 0;
+};
+
+// Per channel RGB comparison of two RGBA8 images of the same size.
+ImageDiff compareImages(std::span<const uint32_t> a, std::span<const uint32_t> b);
+
+// Distribution of the per pixel cost of one frame, over the pixels traced that frame.
+struct CostHistogram
+{
+    // Bin 0 holds the zero costs, bin b > 0 the costs in [2^(b-1), 2^b), the last one everything above
+    static constexpr uint32_t binCount = 24;
+    uint64_t bins[binCount] = {};
+    uint32_t samples = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+
+    static uint32_t binOf(float cost);
+};
+
+// Software version of the compute pass: traces the voxel world into an RGBA8 framebuffer
+// with the same layout as the DX12 framebuffer.
+struct CPURenderer
+{
+    enum class SamplingMode
+    {
+        Full,
+        // Half of the pixels per frame, alternating checkerboard
+        Checkerboard,
+        // One pixel of each 2x2 quad per frame
+        Interleaved4
+    };
+
+    struct FrameStats
+    {
+        uint32_t pixelCount = 0;
+        // Pixels whose reprojected history hit was confirmed by a short segment trace
+        uint32_t reusedPixels = 0;
+        // Pixels traced over the full [Znear, Zfar] range
+        uint32_t tracedPixels = 0;
+        // Short segments traced around reprojected hits, confirmed or not, and their share of traversalSteps
+        uint32_t validationSegments = 0;
+        uint64_t validationSteps = 0;
+        // Pixels skipped by the sampling mode and filled from last frame or from their neighbours
+        uint32_t reconstructedFromHistory = 0;
+        uint32_t reconstructedSpatially = 0;
+        uint64_t traversalSteps = 0;
+        // Chunks left by frustum culling, and those outside of the view
+        uint32_t visibleChunks = 0;
+        uint32_t culledChunks = 0;
+
+        // Only filled when measureAgainstReference is set
+        ImageDiff referenceDiff;
+
+        float reusedPercent() const { return pixelCount ? 100.0f * (float)reusedPixels / (float)pixelCount : 0.0f; }
+    };
+
+    static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+    struct HistorySample
+    {
+        float3 hitPoint;
+        uint32_t voxelId = invalidIndex;
+        uint32_t color = 0;
+    };
+
+    uint32_t width = 0, height = 0;
+    TrackedVector<uint32_t, MemoryTag::Framebuffers> framebuffer;
+
+    bool useTemporalReprojection = true;
+    // Half length, in voxels, of the segment traced around a reprojected hit to validate it
+    float reprojectionSegment = 1.5f;
+
+    SamplingMode samplingMode = SamplingMode::Full;
+
+    // Debug output of what each pixel cost to trace
+    enum class CostView
+    {
+        None,
+        // Grid cells visited, history validation segment included
+        TraversalSteps,
+        // Nanoseconds spent in the pixel's traces
+        Time
+    };
+
+    // Anything but None fills costBuffer and costHistogram, then replaces the framebuffer by a false color
+    // heatmap of the cost (blue cheap, red expensive). History keeps the shaded colors.
+    CostView costView = CostView::None;
+    // Cost shown as the hottest color, 0 uses the p99 of the frame
+    float costScale = 0;
+    // Raw per pixel cost of the last frame, 0 for the pixels not traced that frame
+    TrackedVector<float, MemoryTag::Framebuffers> costBuffer;
+    CostHistogram costHistogram;
+
+    // Full traces only visit the chunks inside the view, front to back
+    bool useChunkCulling = true;
+    ChunkCuller chunkCuller;
+
+    // Traces through the TraversalKernels instance of kernelConfig, on an occupancy grid rebuilt whenever the
+    // world changes, instead of CPURaytracer. Same hits and steps, chunk culling does not apply. The generic
+    // kernel is used when the configuration has no specialised instance.
+    bool useTraversalKernel = false;
+    KernelConfig kernelConfig = {64, VoxelLayout::Linear, 1};
+
+    // Also render every frame at full rate without history and diff against it. Debug only, doubles the cost.
+    bool measureAgainstReference = false;
+    TrackedVector<uint32_t, MemoryTag::Framebuffers> referenceFramebuffer;
+
+    FrameStats stats;
+    uint64_t frameIndex = 0;
+
+    // Tiles are the unit of work handed to the job system, nullptr uses JobSystem::get()
+    static constexpr uint32_t tileSize = 32;
+    JobSystem* jobSystem = nullptr;
+
+    void resize(uint32_t newWidth, uint32_t newHeight);
+
+    void render(const VoxelDataStructs::World& world, const CameraView& camera);
+
+    void invalidateHistory();
+
+    bool isTracedThisFrame(uint32_t x, uint32_t y) const;
+
+    // Framebuffers, history and the occupancy grid of the traversal kernel, chunk lists excluded.
+    size_t memoryBytes() const;
+
+private:
+    TrackedVector<HistorySample, MemoryTag::Caches> history;
+    TrackedVector<HistorySample, MemoryTag::Caches> nextHistory;
+    // Per pixel candidate from the previous frame, found by forward projecting its hits
+    TrackedVector<uint32_t, MemoryTag::Caches> reprojectedSource;
+    TrackedVector<float, MemoryTag::Caches> reprojectedDepth;
+    // Hit distance of the pixels traced this frame
+    TrackedVector<float, MemoryTag::Caches> frameDepth;
+    uint64_t historyWorldRevision = 0;
+    // View the history was rendered from, the space it saw empty
+    Frustum historyFrustum;
+    bool historyValid = false;
+    std::vector<FrameStats> tileStats;
+
+    void reprojectHistory(const CameraView& camera);
+
+    void forEachTile(const std::function<void(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, FrameStats& tileStats)>& body);
+
+    Hit tracePixel(const VoxelDataStructs::World& world, const CameraView& camera, uint32_t x, uint32_t y,
+                   bool reproject, FrameStats& counters);
+
+    bool mayBeOccluded(uint32_t x, uint32_t y) const;
+
+    void reconstructPixel(uint32_t x, uint32_t y, bool haveHistory, FrameStats& counters);
+
+    void renderReference(const VoxelDataStructs::World& world, const CameraView& camera);
+
+    static uint32_t shade(const Hit& hit);
+
+    void buildCostHistogram();
+    void writeHeatmap();
+
+    // CPURaytracer::traceClosest, or the traversal kernel plus the color of the hit voxel
+    Hit traceClosest(const VoxelDataStructs::World& world, const Ray& ray, float tMin, float tMax) const;
+
+    std::vector<float> sortedCosts;
+
+    const TraversalKernel* kernel = nullptr;
+    OccupancyGrid occupancy;
+};
@@ -3,6 +3,8 @@
 #include <DirectXMath.h>
 using namespace DirectX;
 
+#include "Frustum.h"
+
 struct CameraBuffer
 {
     XMFLOAT3 pos;
@@ -89,4 +91,14 @@ struct Camera
     {
         return {pos, Znear, forward, Zfar, right, fov};
     }
+
+    CameraView getCameraView() const
+    {
+        return {{pos.x, pos.y, pos.z}, Znear, {forward.x, forward.y, forward.z}, Zfar, {right.x, right.y, right.z}, fov};
+    }
+
+    Frustum getFrustum() const
+    {
+        return Frustum::fromCamera(getCameraView(), aspectRatio);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+    constexpr uint32_t fileMagic = 0x50435652; // "RVCP"
+    constexpr uint32_t fileVersion = 1;
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t tickCount;
+        float fov;
+        float Znear;
+        float Zfar;
+        double tickStep;
+    };
+
+    static_assert(sizeof(CameraPath::Pose) == 9 * sizeof(float));
+}
+
+void CameraPath::record(const CameraView& view)
+{
+    if (poses.empty())
+    {
+        fov = view.fov;
+        Znear = view.Znear;
+        Zfar = view.Zfar;
+    }
+    poses.push_back({view.pos, view.forward, view.right});
+}
+
+CameraView CameraPath::view(uint32_t tick) const
+{
+    CameraView view{};
+    view.fov = fov;
+    view.Znear = Znear;
+    view.Zfar = Zfar;
+    if (poses.empty())
+        return view;
+
+    const Pose& pose = poses[std::min<size_t>(tick, poses.size() - 1)];
+    view.pos = pose.pos;
+    view.forward = pose.forward;
+    view.right = pose.right;
+    return view;
+}
+
+bool CameraPath::save(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    const FileHeader header{fileMagic, fileVersion, tickCount(), fov, Znear, Zfar, tickStep};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(poses.data()), (std::streamsize)(poses.size() * sizeof(Pose)));
+    return (bool)file;
+}
+
+bool CameraPath::load(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != fileMagic || header.version != fileVersion || header.tickStep <= 0)
+        return false;
+
+    // The count comes from the file, a corrupt one must not ask for gigabytes before the read fails
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    if (error || size - sizeof(header) != uint64_t(header.tickCount) * sizeof(Pose))
+        return false;
+
+    std::vector<Pose> loaded(header.tickCount);
+    if (!file.read(reinterpret_cast<char*>(loaded.data()), (std::streamsize)(loaded.size() * sizeof(Pose))))
+        return false;
+
+    tickStep = header.tickStep;
+    fov = header.fov;
+    Znear = header.Znear;
+    Zfar = header.Zfar;
+    poses = std::move(loaded);
+    return true;
+}
+
+size_t CameraPath::fileBytes() const
+{
+    return sizeof(FileHeader) + poses.size() * sizeof(Pose);
+}
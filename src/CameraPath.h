@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "CPURaytracer.h"
+
+// Camera pose of every simulation tick, recorded while flying and replayed one tick per frame so two runs
+// render the exact same frame sequence whatever the machine or the frame times.
+// The lens (fov, near, far) is the one of the first recorded tick, only the poses are stored per tick.
+class CameraPath
+{
+public:
+    struct Pose
+    {
+        float3 pos;
+        float3 forward;
+        float3 right;
+    };
+
+    // Duration of a tick when it was recorded, informative only: replay never looks at the clock
+    double tickStep = 1.0 / 60.0;
+    float fov = 80;
+    float Znear = 0.1f;
+    float Zfar = 100;
+    std::vector<Pose> poses;
+
+    void clear() { poses.clear(); }
+
+    void record(const CameraView& view);
+
+    uint32_t tickCount() const { return (uint32_t)poses.size(); }
+
+    // Pose of the tick, the last one past the end.
+    CameraView view(uint32_t tick) const;
+
+    // Header then raw poses. False when the file cannot be written, read or is not a camera path,
+    // a failed load leaves the path unchanged.
+    bool save(const std::filesystem::path& path) const;
+    bool load(const std::filesystem::path& path);
+
+    size_t fileBytes() const;
+};
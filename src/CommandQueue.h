@@ -10,7 +10,9 @@
 #include <cstdint>  // For uint64_t
 #include <queue>    // For std::queue
 
-class CommandQueue
+#include "GpuTimeline.h"
+
+class CommandQueue : public GpuTimeline
 {
 public:
     CommandQueue(Microsoft::WRL::ComPtr<ID3D12Device2> &device, D3D12_COMMAND_LIST_TYPE type);
@@ -28,6 +30,11 @@ public:
     void WaitForFenceValue(uint64_t fenceValue);
     void Flush();
 
+    // GpuTimeline
+    uint64_t signal() override { return Signal(); }
+    uint64_t completedValue() const override;
+    void waitForValue(uint64_t fenceValue) override { WaitForFenceValue(fenceValue); }
+
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> GetD3D12CommandQueue() const;
 protected:
 
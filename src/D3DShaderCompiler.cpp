@@ -0,0 +1,59 @@
+#include "D3DShaderCompiler.h"
+
+UINT D3DShaderCompiler::compileFlags() const
+{
+    UINT flags = 0;
+#ifdef _DEBUG
+    flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+    return flags;
+}
+
+std::string D3DShaderCompiler::version() const
+{
+    return "d3dcompiler_" + std::to_string(D3D_COMPILER_VERSION) + "_flags" + std::to_string(compileFlags());
+}
+
+bool D3DShaderCompiler::compile(const ShaderDesc& desc, const std::string& source,
+                                std::vector<uint8_t>& bytecode, std::string& errors)
+{
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (const auto& [name, value] : desc.defines)
+    {
+        macros.push_back({name.c_str(), value.c_str()});
+    }
+    macros.push_back({nullptr, nullptr});
+
+    // The source name lets the standard include handler resolve includes next to the file
+    const std::string source_name = desc.file.string();
+
+    ComPtr<ID3DBlob> shaderBlob;
+    ComPtr<ID3DBlob> errorBlob;
+    const HRESULT hr =
+            D3DCompile(
+                    source.data(),
+                    source.size(),
+                    source_name.c_str(),
+                    macros.data(),
+                    D3D_COMPILE_STANDARD_FILE_INCLUDE,
+                    desc.entryPoint.c_str(),
+                    desc.target.c_str(),
+                    compileFlags(),
+                    0,
+                    &shaderBlob,
+                    &errorBlob
+            );
+
+    if (FAILED(hr))
+    {
+        if (errorBlob)
+        {
+            errors.assign((const char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize());
+        }
+        return false;
+    }
+
+    const uint8_t* data = (const uint8_t*)shaderBlob->GetBufferPointer();
+    bytecode.assign(data, data + shaderBlob->GetBufferSize());
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "includeDX12.h"
+#include "ShaderCache.h"
+
+// ShaderCompiler over D3DCompile, FXC bytecode for the shader model 5 targets.
+class D3DShaderCompiler : public ShaderCompiler
+{
+public:
+    std::string version() const override;
+    bool compile(const ShaderDesc& desc, const std::string& source,
+                 std::vector<uint8_t>& bytecode, std::string& errors) override;
+
+private:
+    UINT compileFlags() const;
+};
@@ -1,5 +1,6 @@
 #include "DX12ComputeContext.h"
 #include "AssertUtils.h"
+#include "Profiler.h"
 
 #include <filesystem>
 
@@ -38,47 +39,53 @@ bool DX12ComputeContext::setTearingFlag()
 }
 
 HRESULT DX12ComputeContext::CompileShaderFromFile(const std::wstring &filename, const std::string &entryPoint,
-                                           const std::string &target, ComPtr<ID3DBlob> &shaderBlob)
+                                           const std::string &target, std::vector<uint8_t> &bytecode,
+                                           const std::vector<std::pair<std::string, std::string>> &defines)
 {
-    UINT compileFlags = 0;
-#ifdef _DEBUG
-    compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-
-    if (!std::filesystem::exists(filename)) {
-        OutputDebugStringA("Shader file not found.\n");
-        std::cout << "Shader file not found\n";
-        return E_FAIL;
-    }
-
-    ComPtr<ID3DBlob> errorBlob;
-    HRESULT hr =
-            D3DCompileFromFile(
-                    filename.c_str(),
-                    nullptr,
-                    D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                    entryPoint.c_str(),
-                    target.c_str(),
-                    compileFlags,
-                    0,
-                    &shaderBlob,
-                    &errorBlob
-            );
-
-    if (FAILED(hr))
+    ShaderDesc desc;
+    desc.file = filename;
+    desc.entryPoint = entryPoint;
+    desc.target = target;
+    desc.defines = defines;
+
+    std::string errors;
+    if (!shader_cache->load(desc, bytecode, errors))
     {
-        if (errorBlob)
-        {
-            OutputDebugStringA((char*)errorBlob->GetBufferPointer());
-        }
-        return hr;
+        OutputDebugStringA(errors.c_str());
+        std::cout << errors << "\n";
+        return E_FAIL;
     }
 
     return S_OK;
 }
 
+void DX12ComputeContext::createFramebuffer()
+{
+    // Retrieve swapchain buffer description and create identical resource but with UAV allowed, so compute shader could write to it
+    auto buffer_desc = swapchain_buffers[0]->GetDesc();
+    buffer_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    const CD3DX12_HEAP_PROPERTIES default_heap_props{ D3D12_HEAP_TYPE_DEFAULT };
+
+    ThrowIfFailed( device->CreateCommittedResource(
+            &default_heap_props, D3D12_HEAP_FLAG_NONE,
+            &buffer_desc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            nullptr, IID_PPV_ARGS(&framebuffer)));
+
+    ThrowIfFailed( framebuffer->SetName(L"framebuffer"));
+    /* Create view for our framebuffer so compute shader can access it
+    *  passing UAV desc is not neccessary? it's determined automatically by system(correctly)
+    *  the descriptor is kept across resizes, the GPU is idle when the view is rewritten
+    */
+    if (!framebuffer_uav)
+        framebuffer_uav = descriptors.allocate();
+    device->CreateUnorderedAccessView(framebuffer.Get(), nullptr, nullptr, descriptors.cpuHandle(framebuffer_uav.first));
+    descriptors.commit(framebuffer_uav);
+}
+
 void DX12ComputeContext::init(HWND hWnd, uint32_t clientWidth, uint32_t clientHeight)
 {
+    RAYVOX_ZONE("DX12ComputeContext::init");
     width = clientHeight;
     height = clientHeight;
 
@@ -105,42 +112,21 @@ void DX12ComputeContext::init(HWND hWnd, uint32_t clientWidth, uint32_t clientHe
     ThrowIfFailed( D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device)));
 
 
-    const D3D12_DESCRIPTOR_HEAP_DESC descriptor_heap_desc{
-            D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
-            2,
-            D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
-    };
-    ThrowIfFailed( device->CreateDescriptorHeap(&descriptor_heap_desc, IID_PPV_ARGS(&descriptor_heap)));
+    direct_queue = std::make_shared<CommandQueue>(device, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    frame_scheduler = std::make_unique<FrameScheduler>(*direct_queue, frames_in_flight);
 
+    descriptors.init(device, persistent_descriptor_count, transient_descriptor_count, *direct_queue);
 
-    const D3D12_COMMAND_QUEUE_DESC command_queue_desc = {
-            D3D12_COMMAND_LIST_TYPE_DIRECT,
-            D3D12_COMMAND_QUEUE_PRIORITY_NORMAL,
-            D3D12_COMMAND_QUEUE_FLAG_NONE,
-            0
-    };
-    ThrowIfFailed( device->CreateCommandQueue(&command_queue_desc, IID_PPV_ARGS(&direct_command_queue)));
-
-
-    ThrowIfFailed( device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                                  IID_PPV_ARGS(&command_allocator)));
-
+    for (uint32_t i = 0; i < frame_scheduler->framesInFlight(); ++i)
+    {
+        ThrowIfFailed( device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                      IID_PPV_ARGS(&command_allocators[i])));
+    }
 
+    // Recorded again every frame with the allocator of its slot, closed in between
     ThrowIfFailed( device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                             command_allocator.Get(), nullptr, IID_PPV_ARGS(&command_list)));
-
+                                             command_allocators[0].Get(), nullptr, IID_PPV_ARGS(&command_list)));
     ThrowIfFailed( command_list->Close());
-    ThrowIfFailed( command_allocator->Reset());
-    ThrowIfFailed( command_list->Reset(command_allocator.Get(), nullptr));
-
-
-    fence_value = 0;
-    ThrowIfFailed( device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
-    fence_event = CreateEventA(nullptr, FALSE, FALSE, nullptr);
-    if (!fence_event)
-    {
-        ThrowIfFailed( HRESULT_FROM_WIN32(GetLastError()));
-    }
 
 
     setTearingFlag();
@@ -164,7 +150,7 @@ void DX12ComputeContext::init(HWND hWnd, uint32_t clientWidth, uint32_t clientHe
 // Create and upgrade swapchain to our version(ComPtr<IDXGISwapChain4> swapchain)
     ComPtr<IDXGISwapChain1> swapchain_tier_dx12;
     ThrowIfFailed( dxgi_factory->CreateSwapChainForHwnd(
-            direct_command_queue.Get(),
+            direct_queue->GetD3D12CommandQueue().Get(),
             hWnd,
             &swapchain_desc,
             nullptr,
@@ -179,48 +165,47 @@ void DX12ComputeContext::init(HWND hWnd, uint32_t clientWidth, uint32_t clientHe
         ThrowIfFailed( swapchain_buffers[i]->SetName(L"swapchain_buffer"));
     }
 
-    // Retrieve swapchain buffer description and create identical resource but with UAV allowed, so compute shader could write to it
-    auto buffer_desc = swapchain_buffers[0]->GetDesc();
-    buffer_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-
-    const CD3DX12_HEAP_PROPERTIES default_heap_props{ D3D12_HEAP_TYPE_DEFAULT };
-
-    ThrowIfFailed( device->CreateCommittedResource(
-            &default_heap_props, D3D12_HEAP_FLAG_NONE,
-            &buffer_desc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-            nullptr, IID_PPV_ARGS(&framebuffer)));
-
-    ThrowIfFailed( framebuffer->SetName(L"framebuffer"));
-    /* Create view for our framebuffer so compute shader can access it
-    *  passing UAV desc is not neccessary? it's determined automatically by system(correctly)
-    *  using first handle/descriptor in the heap as currently we dont have any other resources
-    */
-    device->CreateUnorderedAccessView(framebuffer.Get(), nullptr, nullptr, descriptor_heap->GetCPUDescriptorHandleForHeapStart());
-    ++currentlyInitDescriptor;
+    createFramebuffer();
 
-    camera = Camera({0,0,-10},{0,0,1},{0,1,0},
-                    80, (float)width/(float)height, 0.1f, 100);
-
-    CameraBuffer cameraBufferData = camera.getCameraBuffer();
-    cameraBuffer.createOrUpdateConstantBuffer(device.Get(), command_list.Get(), cameraBufferData,
-                                              descriptor_heap.Get(), currentlyInitDescriptor);
+    {
+        const CD3DX12_HEAP_PROPERTIES upload_heap_props{ D3D12_HEAP_TYPE_UPLOAD };
+        const auto upload_desc = CD3DX12_RESOURCE_DESC::Buffer(upload_ring_size);
+        ThrowIfFailed( device->CreateCommittedResource(
+                &upload_heap_props, D3D12_HEAP_FLAG_NONE,
+                &upload_desc, D3D12_RESOURCE_STATE_GENERIC_READ,
+                nullptr, IID_PPV_ARGS(&upload_buffer)));
+        ThrowIfFailed( upload_buffer->SetName(L"upload_ring"));
+
+        // Mapped once for the lifetime of the buffer, upload heaps can stay mapped while the GPU reads them
+        void* mapped = nullptr;
+        const D3D12_RANGE read_range = { 0, 0 };
+        ThrowIfFailed( upload_buffer->Map(0, &read_range, &mapped));
+        upload_ring = std::make_unique<UploadRing>(static_cast<uint8_t*>(mapped), upload_ring_size, *direct_queue);
+    }
 
     std::wstring shader_dir;
-    shader_dir = std::filesystem::current_path().filename() == "bin" ? L"../src/Shaders" : L"src/Shaders";
+    const bool in_bin = std::filesystem::current_path().filename() == "bin";
+    shader_dir = in_bin ? L"../src/Shaders" : L"src/Shaders";
+    shader_cache = std::make_unique<ShaderCache>(in_bin ? "shader_cache" : "bin/shader_cache", shader_compiler);
 
 // Shader and its layout
-    ComPtr<ID3DBlob> computeShaderBlob;
-    ThrowIfFailed(CompileShaderFromFile(shader_dir + L"/ComputeShader.hlsl", "main", "cs_5_0", computeShaderBlob));
+    std::vector<uint8_t> computeShaderBytecode;
+    // The group size is compiled in the shader, so dispatch and numthreads cannot disagree
+    ThrowIfFailed(CompileShaderFromFile(shader_dir + L"/ComputeShader.hlsl", "main", "cs_5_0", computeShaderBytecode,
+                                        {{"THREAD_GROUP_SIZE_X", std::to_string(threadGroupSizeX)},
+                                         {"THREAD_GROUP_SIZE_Y", std::to_string(threadGroupSizeY)}}));
+    // Entries of older versions of the shaders, or of configurations not run for a month
+    shader_cache->pruneOlderThan(std::chrono::hours(24 * 30));
 
     {
         // Description des éléments de la signature racine
-        CD3DX12_DESCRIPTOR_RANGE1 ranges[2];
+        CD3DX12_DESCRIPTOR_RANGE1 ranges[1];
         ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0); // Un UAV à l'emplacement 0
-        ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
 
         CD3DX12_ROOT_PARAMETER1 rootParameters[2];
         rootParameters[0].InitAsDescriptorTable(1, &ranges[0], D3D12_SHADER_VISIBILITY_ALL);
-        rootParameters[1].InitAsDescriptorTable(1, &ranges[1], D3D12_SHADER_VISIBILITY_ALL);
+        // Caméra : CBV racine, l'adresse change à chaque frame dans l'upload ring
+        rootParameters[1].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE);
 
         // Définir les flags de la signature racine
         D3D12_ROOT_SIGNATURE_FLAGS computeRootSignatureFlags =
@@ -242,8 +227,8 @@ void DX12ComputeContext::init(HWND hWnd, uint32_t clientWidth, uint32_t clientHe
 
     D3D12_COMPUTE_PIPELINE_STATE_DESC pso_desc = {};
     pso_desc.pRootSignature = root_signature.Get();
-    pso_desc.CS.BytecodeLength = computeShaderBlob->GetBufferSize();
-    pso_desc.CS.pShaderBytecode = computeShaderBlob->GetBufferPointer();
+    pso_desc.CS.BytecodeLength = computeShaderBytecode.size();
+    pso_desc.CS.pShaderBytecode = computeShaderBytecode.data();
     ThrowIfFailed( device->CreateComputePipelineState(&pso_desc, IID_PPV_ARGS(&pso)));
 
 
@@ -253,21 +238,29 @@ void DX12ComputeContext::init(HWND hWnd, uint32_t clientWidth, uint32_t clientHe
 
 void DX12ComputeContext::render()
 {
+    RAYVOX_ZONE("DX12ComputeContext::render");
+    // Only waits when the GPU is more than frames_in_flight - 1 frames behind
+    uint32_t slot;
+    {
+        RAYVOX_ZONE("wait frame slot");
+        slot = frame_scheduler->beginFrame();
+    }
+    ThrowIfFailed( command_allocators[slot]->Reset());
+    ThrowIfFailed( command_list->Reset(command_allocators[slot].Get(), nullptr));
+
     buffer_index = swapchain->GetCurrentBackBufferIndex();
     const auto& backbuffer = swapchain_buffers[buffer_index];
 
 
     command_list->SetPipelineState(pso.Get());
     command_list->SetComputeRootSignature(root_signature.Get());
-    command_list->SetDescriptorHeaps(1, descriptor_heap.GetAddressOf());
+    command_list->SetDescriptorHeaps(1, descriptors.gpu_heap.GetAddressOf());
 
     // Set the root descriptor table for the UAV (at slot 0)
-    CD3DX12_GPU_DESCRIPTOR_HANDLE uavHandle(descriptor_heap->GetGPUDescriptorHandleForHeapStart(), 0, device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-    command_list->SetComputeRootDescriptorTable(0, uavHandle);
+    command_list->SetComputeRootDescriptorTable(0, descriptors.gpuHandle(framebuffer_uav.first));
 
-    // Set the root descriptor table for the CBV (at slot 1)
-    CD3DX12_GPU_DESCRIPTOR_HANDLE cbvHandle(descriptor_heap->GetGPUDescriptorHandleForHeapStart(), 1, device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-    command_list->SetComputeRootDescriptorTable(1, cbvHandle);
+    // Camera constants of this frame, in the upload ring (slot 1)
+    command_list->SetComputeRootConstantBufferView(1, camera_address);
 
 
 
@@ -302,44 +295,93 @@ void DX12ComputeContext::render()
 
     ThrowIfFailed( command_list->Close());
     ID3D12CommandList* const command_lists[] = { command_list.Get() };
-    direct_command_queue->ExecuteCommandLists(sizeof(command_lists) / sizeof command_lists[0], command_lists);
-
-    ThrowIfFailed( direct_command_queue->Signal(fence.Get(), ++fence_value));
-    ThrowIfFailed( fence->SetEventOnCompletion(fence_value, fence_event));
-    if (::WaitForSingleObject(fence_event, INFINITE) == WAIT_FAILED) {
-        ThrowIfFailed( HRESULT_FROM_WIN32(GetLastError()));
-    }
-
-    ThrowIfFailed( command_allocator->Reset());
-    ThrowIfFailed( command_list->Reset(command_allocator.Get(), nullptr));
+    direct_queue->GetD3D12CommandQueue()->ExecuteCommandLists(sizeof(command_lists) / sizeof command_lists[0], command_lists);
 
+    // The upload space and transient descriptors of this frame are given back once the GPU passes its fence
+    const uint64_t fence_value = frame_scheduler->endFrame();
+    upload_ring->finishFrame(fence_value);
+    descriptors.finishFrame(fence_value);
+}
 
+void DX12ComputeContext::present()
+{
+    RAYVOX_ZONE("DX12ComputeContext::present");
     swapchain->Present(useVSync, tearingFlag);
 }
 
 void DX12ComputeContext::flush()
 {
-    if (fence->GetCompletedValue() < fence_value)
+    frame_scheduler->waitIdle();
+
+    for(int i = 0; i < buffer_count; ++i)
     {
-        fence->SetEventOnCompletion(fence_value, fence_event);
-        ::WaitForSingleObject(fence_event, DWORD_MAX);
+        swapchain_buffers[i].Reset();
     }
+    framebuffer.Reset();
+    swapchain.Reset();
+    command_list.Reset();
+    upload_ring.reset();
+    upload_buffer->Unmap(0, nullptr);
+    upload_buffer.Reset();
+    descriptors.release();
+    framebuffer_uav = {};
+    for (auto& allocator : command_allocators)
+    {
+        allocator.Reset();
+    }
+    frame_scheduler.reset();
+    direct_queue.reset();
+    device.Reset();
+    isInitialized = false;
+}
 
-    ThrowIfFailed(direct_command_queue->Signal(fence.Get(), fence_value));
+void DX12ComputeContext::init(void* nativeWindow, uint32_t clientWidth, uint32_t clientHeight)
+{
+    init((HWND)nativeWindow, clientWidth, clientHeight);
+}
 
-    ThrowIfFailed(fence->SetEventOnCompletion(fence_value, fence_event));
-    ::WaitForSingleObject(fence_event, INFINITE);
+void DX12ComputeContext::resize(uint32_t clientWidth, uint32_t clientHeight)
+{
+    clientWidth = std::max(1u, clientWidth);
+    clientHeight = std::max(1u, clientHeight);
+    if (!isInitialized || (clientWidth == width && clientHeight == height))
+        return;
 
+    // The back buffers and the framebuffer must not be referenced by the GPU anymore
+    frame_scheduler->waitIdle();
     for(int i = 0; i < buffer_count; ++i)
     {
         swapchain_buffers[i].Reset();
     }
-    swapchain.Reset();
-    device.Reset();
+    framebuffer.Reset();
+
+    width = clientWidth;
+    height = clientHeight;
+    threadGroupCountX = (width + threadGroupSizeX - 1) / threadGroupSizeX;
+    threadGroupCountY = (height + threadGroupSizeY - 1) / threadGroupSizeY;
+
+    DXGI_SWAP_CHAIN_DESC swapchain_desc = {};
+    ThrowIfFailed(swapchain->GetDesc(&swapchain_desc));
+    ThrowIfFailed(swapchain->ResizeBuffers(buffer_count, width, height, swapchain_desc.BufferDesc.Format, swapchain_desc.Flags));
+
+    for (int i = 0; i < buffer_count; i++)
+    {
+        ThrowIfFailed( swapchain->GetBuffer(i, IID_PPV_ARGS(&swapchain_buffers[i])));
+        ThrowIfFailed( swapchain_buffers[i]->SetName(L"swapchain_buffer"));
+    }
+    createFramebuffer();
 }
 
-void DX12ComputeContext::computeAndUploadCameraBuffer() {
-    CameraBuffer cameraBufferData = camera.getCameraBuffer();
-    cameraBuffer.createOrUpdateConstantBuffer(device.Get(), command_list.Get(), cameraBufferData,
-                                              descriptor_heap.Get(), currentlyInitDescriptor);
+void DX12ComputeContext::uploadCamera(const CameraView& camera)
+{
+    RAYVOX_ZONE("DX12ComputeContext::uploadCamera");
+    CameraBuffer cameraBufferData = {{camera.pos.x, camera.pos.y, camera.pos.z}, camera.Znear,
+                                     {camera.forward.x, camera.forward.y, camera.forward.z}, camera.Zfar,
+                                     {camera.right.x, camera.right.y, camera.right.z}, camera.fov};
+    const UploadRing::Allocation allocation = upload_ring->upload(cameraBufferData);
+    // allocate already waited for every submitted frame, the space left is held by the frame being recorded
+    // and waiting longer cannot free it
+    if (!allocation)
+        throw std::runtime_error("Upload ring too small for the camera constants");
+    camera_address = upload_buffer->GetGPUVirtualAddress() + allocation.offset;
 }
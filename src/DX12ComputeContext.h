@@ -3,8 +3,16 @@
 #include "includeDX12.h"
 #include "Camera.h"
 #include "DX12Resource.h"
+#include "DX12DescriptorHeap.h"
+#include "RenderBackend.h"
+#include "CommandQueue.h"
+#include "FrameScheduler.h"
+#include "UploadRing.h"
+#include "D3DShaderCompiler.h"
 
-struct DX12ComputeContext
+#include <memory>
+
+struct DX12ComputeContext : public RenderBackend
 {
     uint32_t threadGroupSizeX = 8;
     uint32_t threadGroupSizeY = 8;
@@ -22,15 +30,14 @@ struct DX12ComputeContext
     // D3D12 core interfaces
     ComPtr<ID3D12Debug6> debug_controller;
     ComPtr<ID3D12Device2> device;
-    // Command interfaces
-    ComPtr<ID3D12CommandQueue> direct_command_queue;
-    ComPtr<ID3D12CommandAllocator> command_allocator;
+    // Command interfaces, one allocator per frame in flight
+    std::shared_ptr<CommandQueue> direct_queue;
+    ComPtr<ID3D12CommandAllocator> command_allocators[FrameScheduler::maxFramesInFlight];
     ComPtr<ID3D12GraphicsCommandList> command_list;
 
     // Synchronization
-    ComPtr<ID3D12Fence> fence;
-    uint64_t fence_value;
-    HANDLE fence_event;
+    uint32_t frames_in_flight = 2;
+    std::unique_ptr<FrameScheduler> frame_scheduler;
 
     // GPU Resources
     ComPtr<ID3D12Resource> swapchain_buffers[buffer_count];
@@ -41,9 +48,10 @@ struct DX12ComputeContext
     ComPtr<ID3D12PipelineState> pso;
 
     // Resource descriptors(views)
-    ComPtr<ID3D12DescriptorHeap> descriptor_heap;
-
-    unsigned int currentlyInitDescriptor = 0;
+    static const uint32_t persistent_descriptor_count = 64;
+    static const uint32_t transient_descriptor_count = 256;
+    DX12DescriptorHeap descriptors;
+    DescriptorAllocator::Range framebuffer_uav;
 
     bool isInitialized;
 
@@ -51,19 +59,33 @@ struct DX12ComputeContext
 
     uint32_t threadGroupCountX, threadGroupCountY, threadGroupCountZ;
 
-    Camera camera;
-    DX12Resource cameraBuffer;
-
-    void computeAndUploadCameraBuffer();
+    // Persistently mapped upload buffer, constants and dirty chunk data are suballocated from it every frame
+    static const uint64_t upload_ring_size = 4 * 1024 * 1024;
+    ComPtr<ID3D12Resource> upload_buffer;
+    std::unique_ptr<UploadRing> upload_ring;
+    D3D12_GPU_VIRTUAL_ADDRESS camera_address = 0;
 
     bool setTearingFlag();
 
+    // Compiled shaders are kept on disk next to the executable, keyed by their sources, defines and target
+    D3DShaderCompiler shader_compiler;
+    std::unique_ptr<ShaderCache> shader_cache;
+
     HRESULT CompileShaderFromFile(const std::wstring &filename, const std::string &entryPoint,
-                                                      const std::string &target, ComPtr<ID3DBlob> &shaderBlob);
+                                                      const std::string &target, std::vector<uint8_t> &bytecode,
+                                                      const std::vector<std::pair<std::string, std::string>> &defines = {});
+
 
-    void flush();
+    void createFramebuffer();
 
     void init(HWND hWnd, uint32_t clientWidth, uint32_t clientHeight);
 
-    void render();
+    // RenderBackend
+    void init(void* nativeWindow, uint32_t clientWidth, uint32_t clientHeight) override;
+    void resize(uint32_t clientWidth, uint32_t clientHeight) override;
+    void uploadCamera(const CameraView& camera) override;
+    void render() override;
+    void present() override;
+    void flush() override;
+    bool isReady() const override { return isInitialized; }
 };
\ No newline at end of file
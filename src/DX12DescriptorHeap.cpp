@@ -0,0 +1,110 @@
+#include "DX12DescriptorHeap.h"
+#include "AssertUtils.h"
+
+#include <algorithm>
+
+void DX12DescriptorHeap::init(const ComPtr<ID3D12Device2>& device, uint32_t persistentCapacity,
+                              uint32_t transientCapacity, GpuTimeline& timeline)
+{
+    this->device = device;
+    this->timeline = &timeline;
+    descriptor_size = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    allocator = std::make_unique<DescriptorAllocator>(persistentCapacity, transientCapacity, timeline);
+    createHeaps(allocator->capacity(), cpu_heap, gpu_heap);
+}
+
+DescriptorAllocator::Range DX12DescriptorHeap::allocate(uint32_t count)
+{
+    DescriptorAllocator::Range range = allocator->allocate(count);
+    if (!range)
+    {
+        grow(std::max(allocator->persistentCapacity() * 2, allocator->persistentCapacity() + count));
+        range = allocator->allocate(count);
+    }
+    return range;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DX12DescriptorHeap::cpuHandle(uint32_t index) const
+{
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(cpu_heap->GetCPUDescriptorHandleForHeapStart(), index, descriptor_size);
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DX12DescriptorHeap::gpuHandle(uint32_t index) const
+{
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(gpu_heap->GetGPUDescriptorHandleForHeapStart(), index, descriptor_size);
+}
+
+void DX12DescriptorHeap::commit(DescriptorAllocator::Range range)
+{
+    const CD3DX12_CPU_DESCRIPTOR_HANDLE dst(gpu_heap->GetCPUDescriptorHandleForHeapStart(), range.first, descriptor_size);
+    device->CopyDescriptorsSimple(range.count, dst, cpuHandle(range.first), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+DescriptorAllocator::Range DX12DescriptorHeap::allocateTable(const uint32_t* persistentIndices, uint32_t count)
+{
+    const DescriptorAllocator::Range table = allocator->allocateTransient(count);
+    if (!table)
+        return table;
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE dst(gpu_heap->GetCPUDescriptorHandleForHeapStart(), table.first, descriptor_size);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        device->CopyDescriptorsSimple(1, dst, cpuHandle(persistentIndices[i]), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        dst.Offset(descriptor_size);
+    }
+    return table;
+}
+
+void DX12DescriptorHeap::finishFrame(uint64_t fenceValue)
+{
+    allocator->finishFrame(fenceValue);
+
+    const uint64_t completed = timeline->completedValue();
+    while (!retired_heaps.empty() && retired_heaps.front().fenceValue <= completed)
+        retired_heaps.pop_front();
+}
+
+void DX12DescriptorHeap::release()
+{
+    retired_heaps.clear();
+    allocator.reset();
+    gpu_heap.Reset();
+    cpu_heap.Reset();
+    device.Reset();
+}
+
+void DX12DescriptorHeap::grow(uint32_t persistentCapacity)
+{
+    const uint32_t oldPersistent = allocator->persistentCapacity();
+    allocator->grow(persistentCapacity);
+
+    ComPtr<ID3D12DescriptorHeap> cpu, gpu;
+    createHeaps(allocator->capacity(), cpu, gpu);
+
+    // Persistent descriptors keep their index, transient tables start over in the new heap
+    device->CopyDescriptorsSimple(oldPersistent, cpu->GetCPUDescriptorHandleForHeapStart(),
+                                  cpu_heap->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    device->CopyDescriptorsSimple(oldPersistent, gpu->GetCPUDescriptorHandleForHeapStart(),
+                                  cpu_heap->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    retired_heaps.push_back({timeline->signal(), gpu_heap});
+    cpu_heap = cpu;
+    gpu_heap = gpu;
+}
+
+void DX12DescriptorHeap::createHeaps(uint32_t capacity, ComPtr<ID3D12DescriptorHeap>& cpu, ComPtr<ID3D12DescriptorHeap>& gpu)
+{
+    const D3D12_DESCRIPTOR_HEAP_DESC cpu_desc{
+            D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            capacity,
+            D3D12_DESCRIPTOR_HEAP_FLAG_NONE
+    };
+    ThrowIfFailed( device->CreateDescriptorHeap(&cpu_desc, IID_PPV_ARGS(&cpu)));
+
+    const D3D12_DESCRIPTOR_HEAP_DESC gpu_desc{
+            D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            capacity,
+            D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
+    };
+    ThrowIfFailed( device->CreateDescriptorHeap(&gpu_desc, IID_PPV_ARGS(&gpu)));
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "includeDX12.h"
+#include "DescriptorAllocator.h"
+
+#include <deque>
+#include <memory>
+
+// Shader visible CBV/SRV/UAV heap driven by a DescriptorAllocator.
+// Persistent descriptors are written in a CPU only mirror heap and copied to the shader visible one by commit(),
+// the mirror is what copies read from when growing the heap or building transient tables
+// (shader visible heaps are write combined and cannot be a copy source).
+struct DX12DescriptorHeap
+{
+    ComPtr<ID3D12Device2> device;
+    ComPtr<ID3D12DescriptorHeap> cpu_heap;
+    ComPtr<ID3D12DescriptorHeap> gpu_heap;
+    UINT descriptor_size = 0;
+    std::unique_ptr<DescriptorAllocator> allocator;
+    GpuTimeline* timeline = nullptr;
+
+    // Heaps replaced by grow(), kept until the GPU is done with the frames that bound them
+    struct RetiredHeap
+    {
+        uint64_t fenceValue;
+        ComPtr<ID3D12DescriptorHeap> heap;
+    };
+    std::deque<RetiredHeap> retired_heaps;
+
+    void init(const ComPtr<ID3D12Device2>& device, uint32_t persistentCapacity, uint32_t transientCapacity,
+              GpuTimeline& timeline);
+
+    // Persistent range, the heap grows when the allocator is full. Must not be called while a command list
+    // that bound the heap is being recorded.
+    DescriptorAllocator::Range allocate(uint32_t count = 1);
+    void release(DescriptorAllocator::Range range) { allocator->release(range); }
+
+    // Where to write a persistent descriptor, then commit() its range
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle(uint32_t index) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle(uint32_t index) const;
+    void commit(DescriptorAllocator::Range range);
+
+    // Gathers persistent descriptors in a contiguous table valid for the frame being recorded.
+    DescriptorAllocator::Range allocateTable(const uint32_t* persistentIndices, uint32_t count);
+
+    void finishFrame(uint64_t fenceValue);
+    void release();
+
+private:
+    void grow(uint32_t persistentCapacity);
+    void createHeaps(uint32_t capacity, ComPtr<ID3D12DescriptorHeap>& cpu, ComPtr<ID3D12DescriptorHeap>& gpu);
+};
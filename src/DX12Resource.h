@@ -2,19 +2,20 @@
 
 #include "includeDX12.h"
 #include "AssertUtils.h"
+#include "DX12DescriptorHeap.h"
 
 struct DX12Resource
 {
     ComPtr<ID3D12Resource> resource;
     D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptorHandle = {};
     D3D12_GPU_DESCRIPTOR_HANDLE gpuDescriptorHandle = {};
+    DescriptorAllocator::Range descriptor;
 
     template <typename T>
     void createOrUpdateConstantBuffer(ID3D12Device* device,
                                                     ID3D12GraphicsCommandList* commandList,
                                                     const T& data,
-                                                    ID3D12DescriptorHeap* descriptorHeap,
-                                                    unsigned int &currentlyInitDescriptor)
+                                                    DX12DescriptorHeap& descriptors)
     {
         //TODO : check si sizeof(T) est un multiple de ... pour le padding
         const UINT64 bufferSize = (sizeof(T) + 255) & ~255; // Align buffer size to 256 bytes
@@ -49,17 +50,16 @@ struct DX12Resource
             ));
 
 
-            cpuDescriptorHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(
-                    descriptorHeap->GetCPUDescriptorHandleForHeapStart(),
-                    currentlyInitDescriptor++,
-                    device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
-            );
+            descriptor = descriptors.allocate();
+            cpuDescriptorHandle = descriptors.cpuHandle(descriptor.first);
 
             D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
             cbvDesc.BufferLocation = resource->GetGPUVirtualAddress();
             cbvDesc.SizeInBytes = bufferSize;
 
             device->CreateConstantBufferView(&cbvDesc, cpuDescriptorHandle);
+            descriptors.commit(descriptor);
+            gpuDescriptorHandle = descriptors.gpuHandle(descriptor.first);
         }
 
         // Map and update the buffer
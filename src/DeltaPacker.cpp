@@ -0,0 +1,105 @@
+#include "DeltaPacker.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace VoxelDataStructs;
+
+void DeltaPacker::markVoxel(const World& world, int32_t x, int32_t y, int32_t z)
+{
+    if (!world.contains(x, y, z))
+        return;
+    const uint32_t chunk = uint32_t(x / chunkSize + world.chunkCount[0] * (y / chunkSize + world.chunkCount[1] * (z / chunkSize)));
+    markRange(chunk, Chunk::index(x % chunkSize, y % chunkSize, z % chunkSize), 1);
+}
+
+void DeltaPacker::markRange(uint32_t chunk, uint32_t firstVoxel, uint32_t count)
+{
+    if (count == 0)
+        return;
+    dirty.push_back({chunk, firstVoxel, std::min(firstVoxel + count, voxelsPerChunk)});
+    ++markedSincePack;
+}
+
+UploadRing::Allocation DeltaPacker::pack(const World& world, UploadRing& staging, std::vector<CopyRange>& copies)
+{
+    RAYVOX_ZONE("DeltaPacker::pack");
+    copies.clear();
+    frameStats = {};
+    frameStats.markedRanges = markedSincePack;
+    frameStats.worldUploadBytes = uint64_t(world.chunks.size()) * chunkBytes;
+    markedSincePack = 0;
+    if (dirty.empty())
+        return {};
+
+    // Coalesce in place, ranges of a chunk end up sorted and merged with their close neighbours
+    std::sort(dirty.begin(), dirty.end(), [](const DirtyRange& a, const DirtyRange& b)
+    {
+        return a.chunk != b.chunk ? a.chunk < b.chunk : a.begin < b.begin;
+    });
+    size_t merged = 0;
+    for (size_t i = 1; i < dirty.size(); ++i)
+    {
+        DirtyRange& last = dirty[merged];
+        if (dirty[i].chunk == last.chunk && dirty[i].begin <= last.end + mergeGap)
+            last.end = std::max(last.end, dirty[i].end);
+        else
+            dirty[++merged] = dirty[i];
+    }
+    dirty.resize(merged + 1);
+
+    // Take ranges in order until the budget is spent, splitting the one that crosses it
+    const uint64_t budgetVoxels = std::max<uint64_t>(1, maxFrameBytes / sizeof(uint32_t));
+    uint64_t voxels = 0;
+    size_t taken = 0;
+    uint32_t splitEnd = 0;
+    for (; taken < dirty.size() && voxels < budgetVoxels; ++taken)
+    {
+        const uint64_t count = dirty[taken].end - dirty[taken].begin;
+        if (voxels + count > budgetVoxels)
+        {
+            splitEnd = dirty[taken].begin + uint32_t(budgetVoxels - voxels);
+            voxels = budgetVoxels;
+            ++taken;
+            break;
+        }
+        voxels += count;
+    }
+
+    const UploadRing::Allocation allocation = staging.allocate(voxels * sizeof(uint32_t));
+    if (!allocation)
+        return {};
+
+    uint32_t lastChunk = UINT32_MAX;
+    uint64_t srcOffset = 0;
+    for (size_t i = 0; i < taken; ++i)
+    {
+        const DirtyRange& range = dirty[i];
+        const uint32_t end = (i + 1 == taken && splitEnd) ? splitEnd : range.end;
+        const uint64_t size = uint64_t(end - range.begin) * sizeof(uint32_t);
+
+        // Chunks without storage are all empty voxels
+        const Chunk& chunk = world.chunks[range.chunk];
+        if (chunk.voxels.empty())
+            std::memset(allocation.cpuAddress + srcOffset, 0, size);
+        else
+            std::memcpy(allocation.cpuAddress + srcOffset, chunk.voxels.data() + range.begin, size);
+
+        copies.push_back({srcOffset, gpuOffset(range.chunk, range.begin), size});
+        srcOffset += size;
+
+        frameStats.chunkUploadBytes += range.chunk != lastChunk ? chunkBytes : 0;
+        lastChunk = range.chunk;
+    }
+
+    frameStats.copies = (uint32_t)copies.size();
+    frameStats.payloadBytes = srcOffset;
+
+    // What is left, with the rest of a split range, waits for the next frame
+    if (splitEnd)
+        dirty[--taken].begin = splitEnd;
+    dirty.erase(dirty.begin(), dirty.begin() + taken);
+    frameStats.deferredRanges = (uint32_t)dirty.size();
+    return allocation;
+}
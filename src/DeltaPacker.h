@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "UploadRing.h"
+#include "VoxelDataStructs.h"
+
+// Collects the voxel ranges edited during a frame and packs them for upload to a GPU mirror of the world,
+// where chunk c occupies voxelsPerChunk colors at gpuOffset(c, 0). Like SDFBrickVolume::updateVoxel,
+// the editing code tells the packer what it changed. pack() sorts and coalesces the ranges, writes their
+// payload back to back in one staging allocation and returns one copy per range, ready for CopyBufferRegion.
+// CPU side only for now: the DX12 backend keeps no GPU mirror of the world, so nothing records these copies yet.
+class DeltaPacker
+{
+public:
+    static constexpr uint32_t voxelsPerChunk =
+            uint32_t(VoxelDataStructs::chunkSize * VoxelDataStructs::chunkSize * VoxelDataStructs::chunkSize);
+    static constexpr uint64_t chunkBytes = uint64_t(voxelsPerChunk) * sizeof(uint32_t);
+
+    struct CopyRange
+    {
+        // From the start of the staging allocation
+        uint64_t srcOffset;
+        // From the start of the mirror
+        uint64_t dstOffset;
+        uint64_t size;
+    };
+
+    struct FrameStats
+    {
+        // Ranges marked since the previous pack, and copies left once coalesced
+        uint32_t markedRanges = 0;
+        uint32_t copies = 0;
+        uint64_t payloadBytes = 0;
+        // What re-uploading every touched chunk, or the whole world, would have cost
+        uint64_t chunkUploadBytes = 0;
+        uint64_t worldUploadBytes = 0;
+        // Coalesced ranges pushed to the next frame by maxFrameBytes
+        uint32_t deferredRanges = 0;
+    };
+
+    // Ranges closer than this many voxels go in one copy, re-sending a few unchanged voxels is cheaper
+    // than another copy command
+    uint32_t mergeGap = 16;
+    // Payload budget of one frame, what does not fit stays dirty for the next ones
+    uint64_t maxFrameBytes = 2 * 1024 * 1024;
+
+    static uint64_t gpuOffset(uint32_t chunk, uint32_t voxel)
+    {
+        return (uint64_t(chunk) * voxelsPerChunk + voxel) * sizeof(uint32_t);
+    }
+
+    // World voxel coordinates, ignored outside of the world.
+    void markVoxel(const VoxelDataStructs::World& world, int32_t x, int32_t y, int32_t z);
+    // count voxels from firstVoxel, in the Chunk::index order of the chunk
+    void markRange(uint32_t chunk, uint32_t firstVoxel, uint32_t count);
+    void markChunk(uint32_t chunk) { markRange(chunk, 0, voxelsPerChunk); }
+
+    // Returns the staging allocation holding the payload, empty when there was nothing to send or it did not
+    // fit in the ring (everything then stays dirty). copies is overwritten.
+    UploadRing::Allocation pack(const VoxelDataStructs::World& world, UploadRing& staging, std::vector<CopyRange>& copies);
+
+    bool hasDirtyRanges() const { return !dirty.empty(); }
+    const FrameStats& lastFrame() const { return frameStats; }
+
+private:
+    struct DirtyRange
+    {
+        uint32_t chunk;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    TrackedVector<DirtyRange, MemoryTag::Staging> dirty;
+    uint32_t markedSincePack = 0;
+    FrameStats frameStats;
+};
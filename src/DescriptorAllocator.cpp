@@ -0,0 +1,175 @@
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+DescriptorAllocator::DescriptorAllocator(uint32_t persistentCapacity, uint32_t transientCapacity, GpuTimeline& timeline)
+        : persistentSize(persistentCapacity), transientSize(transientCapacity), timeline(timeline)
+{
+    if (persistentSize > 0)
+        freeBlocks[0] = persistentSize;
+}
+
+DescriptorAllocator::Range DescriptorAllocator::allocate(uint32_t count)
+{
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+        {
+            if (it->second < count)
+                continue;
+
+            const Range range = {it->first, count};
+            const uint32_t left = it->second - count;
+            freeBlocks.erase(it);
+            if (left > 0)
+                freeBlocks[range.first + count] = left;
+            persistentUsed += count;
+            return range;
+        }
+        // Retired blocks of completed frames might make room
+        reclaim();
+    }
+
+    ++failureCount;
+    return {};
+}
+
+void DescriptorAllocator::release(Range range)
+{
+    if (!range)
+        return;
+    assert(range.first + range.count <= persistentSize && "Not a persistent range");
+    persistentUsed -= range.count;
+    retiredCount += range.count;
+    releasedThisFrame.push_back(range);
+}
+
+void DescriptorAllocator::grow(uint32_t newPersistentCapacity)
+{
+    if (newPersistentCapacity <= persistentSize)
+        return;
+    insertFreeBlock(persistentSize, newPersistentCapacity - persistentSize);
+    persistentSize = newPersistentCapacity;
+
+    // Keep the frames for their released blocks, forget their transient ranges
+    for (PendingFrame& frame : pending)
+        frame.transientEnd = 0;
+    transientHead = transientTail = transientFrameStart = 0;
+}
+
+DescriptorAllocator::Range DescriptorAllocator::allocateTransient(uint32_t count)
+{
+    if (count == 0 || count > transientSize)
+    {
+        ++failureCount;
+        return {};
+    }
+
+    bool stalled = false;
+    while (true)
+    {
+        uint64_t start = transientHead;
+        // A descriptor table must be contiguous, skip to the next lap when it does not fit before the end
+        if (start % transientSize + count > transientSize)
+            start = (start / transientSize + 1) * transientSize;
+
+        if (start + count - transientTail <= transientSize)
+        {
+            transientHead = start + count;
+            transientPeak = std::max(transientPeak, uint32_t(transientHead - transientTail));
+            stallCount += stalled;
+            return {persistentSize + uint32_t(start % transientSize), count};
+        }
+
+        reclaim();
+        if (start + count - transientTail <= transientSize)
+            continue;
+
+        // Only the frame being recorded holds the ring
+        if (pending.empty())
+        {
+            ++failureCount;
+            return {};
+        }
+        timeline.waitForValue(pending.front().fenceValue);
+        stalled = true;
+    }
+}
+
+void DescriptorAllocator::finishFrame(uint64_t fenceValue)
+{
+    if (transientHead != transientFrameStart || !releasedThisFrame.empty())
+        pending.push_back({fenceValue, transientHead, std::move(releasedThisFrame)});
+    releasedThisFrame.clear();
+    transientFrameStart = transientHead;
+    reclaim();
+}
+
+void DescriptorAllocator::reclaim()
+{
+    const uint64_t completed = timeline.completedValue();
+    while (!pending.empty() && pending.front().fenceValue <= completed)
+    {
+        PendingFrame& frame = pending.front();
+        transientTail = std::max(transientTail, frame.transientEnd);
+        for (const Range& range : frame.released)
+        {
+            insertFreeBlock(range.first, range.count);
+            retiredCount -= range.count;
+        }
+        pending.pop_front();
+    }
+    // Nothing left in flight nor being recorded, restart from the beginning of a lap
+    if (transientTail == transientHead && pending.empty() && transientSize > 0)
+        transientTail = transientHead = transientFrameStart = (transientHead + transientSize - 1) / transientSize * transientSize;
+}
+
+float DescriptorAllocator::fragmentation() const
+{
+    uint64_t freeCount = 0;
+    uint32_t largest = 0;
+    for (const auto& [first, count] : freeBlocks)
+    {
+        freeCount += count;
+        largest = std::max(largest, count);
+    }
+    return freeCount == 0 ? 0.0f : 1.0f - float(largest) / float(freeCount);
+}
+
+DescriptorAllocator::Stats DescriptorAllocator::stats() const
+{
+    Stats s;
+    s.persistentUsed = persistentUsed;
+    s.freeBlocks = (uint32_t)freeBlocks.size();
+    for (const auto& [first, count] : freeBlocks)
+        s.largestFreeBlock = std::max(s.largestFreeBlock, count);
+    s.retired = retiredCount;
+    s.transientUsed = uint32_t(transientHead - transientTail);
+    s.transientPeak = transientPeak;
+    s.stalls = stallCount;
+    s.failures = failureCount;
+    return s;
+}
+
+void DescriptorAllocator::insertFreeBlock(uint32_t first, uint32_t count)
+{
+    auto next = freeBlocks.lower_bound(first);
+    assert((next == freeBlocks.end() || next->first >= first + count) && "Range released twice");
+
+    if (next != freeBlocks.end() && next->first == first + count)
+    {
+        count += next->second;
+        next = freeBlocks.erase(next);
+    }
+    if (next != freeBlocks.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == first)
+        {
+            prev->second += count;
+            return;
+        }
+    }
+    freeBlocks.emplace_hint(next, first, count);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "GpuTimeline.h"
+
+// Index management of a descriptor heap, without any API object so it runs and is checked on the CPU.
+// The heap is split in two regions:
+//  - persistent, [0, persistentCapacity): first fit in a free list of blocks, coalesced on release.
+//    Released ranges are only reused once the GPU passed the frame that released them.
+//  - transient, [persistentCapacity, persistentCapacity + transientCapacity): linear ring of per frame
+//    descriptor tables, given back in bulk when the fence of their frame completes.
+class DescriptorAllocator
+{
+public:
+    struct Range
+    {
+        // Index in the heap, both regions share the same index space
+        uint32_t first = 0;
+        uint32_t count = 0;
+
+        explicit operator bool() const { return count != 0; }
+    };
+
+    struct Stats
+    {
+        uint32_t persistentUsed = 0;
+        uint32_t freeBlocks = 0;
+        uint32_t largestFreeBlock = 0;
+        // Released, waiting for the GPU before going back to the free list
+        uint32_t retired = 0;
+        uint32_t transientUsed = 0;
+        uint32_t transientPeak = 0;
+        // Transient allocations that had to wait for the GPU, and allocations that could not fit at all
+        uint64_t stalls = 0;
+        uint64_t failures = 0;
+    };
+
+    DescriptorAllocator(uint32_t persistentCapacity, uint32_t transientCapacity, GpuTimeline& timeline);
+
+    // Returns an empty range when no free block is large enough, grow() and try again.
+    Range allocate(uint32_t count = 1);
+    void release(Range range);
+
+    // Extends the persistent region. Transient ranges move with it, so the ones still in flight are
+    // dropped: they belong to the previous heap, which the caller keeps alive until they complete.
+    void grow(uint32_t newPersistentCapacity);
+
+    // Contiguous range valid until finishFrame, waits for the oldest frame when the ring is full.
+    Range allocateTransient(uint32_t count);
+
+    // Everything allocated or released since the previous call is in use by the GPU until fenceValue.
+    void finishFrame(uint64_t fenceValue);
+    // Gives back what the GPU is done with. Also done by finishFrame and when an allocation does not fit.
+    void reclaim();
+
+    // 0 when the free persistent space is one block, towards 1 as it is split in small blocks.
+    float fragmentation() const;
+
+    uint32_t persistentCapacity() const { return persistentSize; }
+    uint32_t transientCapacity() const { return transientSize; }
+    uint32_t capacity() const { return persistentSize + transientSize; }
+    Stats stats() const;
+
+private:
+    struct PendingFrame
+    {
+        uint64_t fenceValue;
+        uint64_t transientEnd;
+        std::vector<Range> released;
+    };
+
+    void insertFreeBlock(uint32_t first, uint32_t count);
+
+    uint32_t persistentSize;
+    uint32_t transientSize;
+    GpuTimeline& timeline;
+
+    // first -> count, ordered so that a released block finds its neighbours
+    std::map<uint32_t, uint32_t> freeBlocks;
+    uint32_t persistentUsed = 0;
+    std::vector<Range> releasedThisFrame;
+    uint32_t retiredCount = 0;
+
+    // Monotonic positions in the transient ring, the physical index is position % transientSize
+    uint64_t transientHead = 0;
+    uint64_t transientTail = 0;
+    uint64_t transientFrameStart = 0;
+    uint32_t transientPeak = 0;
+
+    std::deque<PendingFrame> pending;
+
+    uint64_t stallCount = 0;
+    uint64_t failureCount = 0;
+};
@@ -0,0 +1,133 @@
+#include "EngineLoop.h"
+
+#include <chrono>
+
+#include "Profiler.h"
+
+EngineLoop::EngineLoop(double tickRate, TickFunction tick, CaptureFunction capture, RenderFunction render)
+        : tick(std::move(tick)), capture(std::move(capture)), render(std::move(render))
+{
+    timestep.step = 1.0 / tickRate;
+}
+
+EngineLoop::~EngineLoop()
+{
+    stop();
+}
+
+void EngineLoop::start()
+{
+    if (running.exchange(true))
+        return;
+    simulationThread = std::thread(&EngineLoop::simulationLoop, this);
+    renderThread = std::thread(&EngineLoop::renderLoop, this);
+}
+
+void EngineLoop::stop()
+{
+    if (!running.exchange(false))
+        return;
+    // Wake the render thread up so it sees running is false
+    published.fetch_add(1, std::memory_order_release);
+    published.notify_all();
+    consumed.fetch_add(1, std::memory_order_release);
+    consumed.notify_all();
+    simulationThread.join();
+    renderThread.join();
+}
+
+EngineLoop::Stats EngineLoop::stats() const
+{
+    Stats s;
+    s.ticks = tickCount.load(std::memory_order_relaxed);
+    s.frames = frameCount.load(std::memory_order_relaxed);
+    const uint64_t snapshotsPublished = snapshotCount.load(std::memory_order_relaxed);
+    s.skippedSnapshots = snapshotsPublished > s.frames ? snapshotsPublished - s.frames : 0;
+    s.droppedSteps = droppedSteps.load(std::memory_order_relaxed);
+    return s;
+}
+
+void EngineLoop::simulationLoop()
+{
+    RAYVOX_THREAD_NAME("Simulation");
+    using Clock = std::chrono::steady_clock;
+    const auto stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timestep.step));
+
+    uint64_t ticks = 0;
+    while (lockstep && running.load(std::memory_order_acquire))
+    {
+        {
+            RAYVOX_ZONE("tick");
+            tick(timestep.step);
+        }
+        publishSnapshot(++ticks);
+
+        // The next tick waits for this one to be on screen, however long it takes
+        uint64_t frames;
+        while ((frames = consumed.load(std::memory_order_acquire)) < ticks && running.load(std::memory_order_acquire))
+            consumed.wait(frames, std::memory_order_acquire);
+    }
+
+    auto last = Clock::now();
+    auto nextTick = last + stepDuration;
+    while (running.load(std::memory_order_acquire))
+    {
+        const auto now = Clock::now();
+        const uint32_t steps = timestep.advance(std::chrono::duration<double>(now - last).count());
+        last = now;
+
+        for (uint32_t i = 0; i < steps; ++i)
+        {
+            RAYVOX_ZONE("tick");
+            tick(timestep.step);
+        }
+
+        if (steps > 0)
+        {
+            ticks += steps;
+            droppedSteps.store(timestep.droppedSteps, std::memory_order_relaxed);
+            publishSnapshot(ticks);
+        }
+
+        // Sleep to the next step boundary instead of spinning
+        nextTick = now + stepDuration - std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(timestep.accumulator));
+        std::this_thread::sleep_until(nextTick);
+    }
+}
+
+void EngineLoop::publishSnapshot(uint64_t ticks)
+{
+    FrameSnapshot& snapshot = snapshots.writeBuffer();
+    capture(snapshot);
+    snapshot.tick = ticks;
+    snapshot.time = (double)ticks * timestep.step;
+    snapshots.publish();
+
+    tickCount.store(ticks, std::memory_order_relaxed);
+    snapshotCount.fetch_add(1, std::memory_order_relaxed);
+    published.fetch_add(1, std::memory_order_release);
+    published.notify_one();
+}
+
+void EngineLoop::renderLoop()
+{
+    RAYVOX_THREAD_NAME("Render");
+    uint64_t seen = 0;
+    while (true)
+    {
+        published.wait(seen, std::memory_order_acquire);
+        seen = published.load(std::memory_order_acquire);
+        if (!running.load(std::memory_order_acquire))
+            break;
+
+        if (snapshots.fetch())
+        {
+            RAYVOX_ZONE("frame");
+            render(snapshots.readBuffer());
+            frameCount.fetch_add(1, std::memory_order_relaxed);
+            consumed.fetch_add(1, std::memory_order_release);
+            consumed.notify_one();
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "CPURaytracer.h"
+#include "SnapshotExchange.h"
+
+// What the render thread needs from the simulation, copied out once per tick.
+struct FrameSnapshot
+{
+    CameraView camera{};
+    uint64_t tick = 0;
+    double time = 0;
+};
+
+// Turns wall clock time into whole simulation steps of a fixed duration.
+struct FixedTimestep
+{
+    double step = 1.0 / 60.0;
+    // After a long hitch the simulation drops time instead of running a burst of steps
+    uint32_t maxStepsPerAdvance = 8;
+    double accumulator = 0;
+    uint64_t droppedSteps = 0;
+
+    uint32_t advance(double elapsedSeconds)
+    {
+        accumulator += elapsedSeconds;
+        uint32_t steps = (uint32_t)(accumulator / step);
+        if (steps > maxStepsPerAdvance)
+        {
+            droppedSteps += steps - maxStepsPerAdvance;
+            steps = maxStepsPerAdvance;
+            accumulator = 0;
+        }
+        else
+        {
+            accumulator -= steps * step;
+        }
+        return steps;
+    }
+};
+
+// Simulation and render threads, the platform thread that starts them only has to pump messages.
+// The simulation runs tick() at a fixed rate, sleeping between ticks, and publishes capture() after each
+// batch of ticks. The render thread sleeps until a snapshot is published and renders the latest one,
+// so a slow frame only makes it skip snapshots, it never holds back the simulation nor the input.
+class EngineLoop
+{
+public:
+    struct Stats
+    {
+        uint64_t ticks = 0;
+        uint64_t frames = 0;
+        // Snapshots the render thread was too slow to see
+        uint64_t skippedSnapshots = 0;
+        uint64_t droppedSteps = 0;
+    };
+
+    using TickFunction = std::function<void(double dt)>;
+    using CaptureFunction = std::function<void(FrameSnapshot& snapshot)>;
+    using RenderFunction = std::function<void(const FrameSnapshot& snapshot)>;
+
+    // One tick per rendered frame instead of following the clock: every snapshot is rendered, none is skipped,
+    // and the simulation waits for the frame. For replays, set before start().
+    bool lockstep = false;
+
+    EngineLoop(double tickRate, TickFunction tick, CaptureFunction capture, RenderFunction render);
+    ~EngineLoop();
+
+    void start();
+    // Joins both threads, the render function is not called anymore once it returns.
+    void stop();
+
+    Stats stats() const;
+
+private:
+    void simulationLoop();
+    void renderLoop();
+    void publishSnapshot(uint64_t ticks);
+
+    TickFunction tick;
+    CaptureFunction capture;
+    RenderFunction render;
+
+    FixedTimestep timestep;
+    SnapshotExchange<FrameSnapshot> snapshots;
+
+    std::atomic<bool> running{false};
+    // Bumped on every publish, the render thread waits on it
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> snapshotCount{0};
+    // Bumped after every rendered frame, the simulation waits on it in lockstep
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<uint64_t> tickCount{0};
+    std::atomic<uint64_t> frameCount{0};
+    std::atomic<uint64_t> droppedSteps{0};
+
+    std::thread simulationThread;
+    std::thread renderThread;
+};
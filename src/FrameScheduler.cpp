@@ -0,0 +1,37 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+FrameScheduler::FrameScheduler(GpuTimeline& timeline, uint32_t framesInFlight)
+        : timeline(timeline), inFlight(std::clamp(framesInFlight, 1u, maxFramesInFlight))
+{
+}
+
+uint32_t FrameScheduler::beginFrame()
+{
+    slot = uint32_t(frames % inFlight);
+
+    const uint64_t fence = slotFence[slot];
+    if (fence && timeline.completedValue() < fence)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        timeline.waitForValue(fence);
+        frameStats.stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++frameStats.stalledFrames;
+    }
+    return slot;
+}
+
+uint64_t FrameScheduler::endFrame()
+{
+    slotFence[slot] = timeline.signal();
+    ++frames;
+    frameStats.frames = frames;
+    return slotFence[slot];
+}
+
+void FrameScheduler::waitIdle()
+{
+    timeline.waitForValue(timeline.signal());
+}
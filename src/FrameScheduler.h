@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include "GpuTimeline.h"
+
+// N frames in flight on one GPU timeline. The CPU records frame N while the GPU still runs up to
+// framesInFlight - 1 older frames, and only waits when it gets further ahead than that. The slot
+// returned by beginFrame indexes the per frame resources (command allocators, upload space, ...).
+class FrameScheduler
+{
+public:
+    static constexpr uint32_t maxFramesInFlight = 4;
+
+    struct Stats
+    {
+        uint64_t frames = 0;
+        // Frames whose beginFrame had to wait for the GPU, and the time spent there
+        uint64_t stalledFrames = 0;
+        double stallSeconds = 0;
+    };
+
+    explicit FrameScheduler(GpuTimeline& timeline, uint32_t framesInFlight = 2);
+
+    // Waits until the GPU is done with the last frame that used the next slot, returns that slot.
+    uint32_t beginFrame();
+
+    // Signals the timeline after the submissions of the current frame, returns the fence value of the frame.
+    uint64_t endFrame();
+
+    // Waits for every frame in flight, before resizing or releasing the per frame resources.
+    void waitIdle();
+
+    uint32_t framesInFlight() const { return inFlight; }
+    uint32_t currentSlot() const { return slot; }
+    uint64_t frameCount() const { return frames; }
+
+    const Stats& stats() const { return frameStats; }
+
+private:
+    GpuTimeline& timeline;
+    uint32_t inFlight;
+    uint32_t slot = 0;
+    uint64_t frames = 0;
+    uint64_t slotFence[maxFramesInFlight] = {};
+    Stats frameStats;
+};
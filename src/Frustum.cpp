@@ -0,0 +1,146 @@
+#include "Frustum.h"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define RAYVOX_FRUSTUM_SSE 1
+#endif
+
+namespace
+{
+    Plane makePlane(const float3& normal, const float3& point)
+    {
+        const float3 n = normalize(normal);
+        return {n, -dot(n, point)};
+    }
+}
+
+Frustum Frustum::fromCamera(const CameraView& camera, float aspectRatio)
+{
+    const float tanY = std::tan(radians(camera.fov) * 0.5f);
+    const float tanX = tanY * aspectRatio;
+    const float3 up = cross(camera.right, camera.forward);
+
+    Frustum frustum;
+    frustum.planes[0] = makePlane(camera.forward, camera.pos + camera.forward * camera.Znear);
+    frustum.planes[1] = makePlane(-camera.forward, camera.pos + camera.forward * camera.Zfar);
+    frustum.planes[2] = makePlane(camera.right + camera.forward * tanX, camera.pos);
+    frustum.planes[3] = makePlane(-camera.right + camera.forward * tanX, camera.pos);
+    frustum.planes[4] = makePlane(up + camera.forward * tanY, camera.pos);
+    frustum.planes[5] = makePlane(-up + camera.forward * tanY, camera.pos);
+    return frustum;
+}
+
+bool Frustum::intersects(const float3& boxMin, const float3& boxMax) const
+{
+    for(const Plane& plane : planes)
+    {
+        // Corner of the box the furthest along the normal
+        const float3 p(plane.normal.x > 0 ? boxMax.x : boxMin.x,
+                       plane.normal.y > 0 ? boxMax.y : boxMin.y,
+                       plane.normal.z > 0 ? boxMax.z : boxMin.z);
+        if (dot(plane.normal, p) + plane.d < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+float Frustum::enterDistance(const Ray& ray, float tMin, float tMax) const
+{
+    float tEnter = tMin;
+    for(const Plane& plane : planes)
+    {
+        // Signed distance to the plane, linear along the segment
+        const float atMin = dot(plane.normal, ray.origin + ray.direction * tMin) + plane.d;
+        const float atMax = dot(plane.normal, ray.origin + ray.direction * tMax) + plane.d;
+        if (atMax < 0.0f)
+            return tMax;
+        if (atMin < 0.0f)
+            tEnter = std::max(tEnter, tMin + (tMax - tMin) * atMin / (atMin - atMax));
+    }
+    return std::min(tEnter, tMax);
+}
+
+void Frustum::cullBoxes(const float* minX, const float* minY, const float* minZ,
+                        const float* maxX, const float* maxY, const float* maxZ,
+                        uint32_t count, uint8_t* inside) const
+{
+    uint32_t i = 0;
+
+#ifdef RAYVOX_FRUSTUM_SSE
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 outside = _mm_setzero_ps();
+        for(const Plane& plane : planes)
+        {
+            // The furthest corner is picked per plane, so the four boxes read the same arrays
+            const __m128 px = _mm_loadu_ps((plane.normal.x > 0 ? maxX : minX) + i);
+            const __m128 py = _mm_loadu_ps((plane.normal.y > 0 ? maxY : minY) + i);
+            const __m128 pz = _mm_loadu_ps((plane.normal.z > 0 ? maxZ : minZ) + i);
+
+            __m128 distance = _mm_mul_ps(px, _mm_set1_ps(plane.normal.x));
+            distance = _mm_add_ps(distance, _mm_mul_ps(py, _mm_set1_ps(plane.normal.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(pz, _mm_set1_ps(plane.normal.z)));
+            distance = _mm_add_ps(distance, _mm_set1_ps(plane.d));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+
+        const int mask = _mm_movemask_ps(outside);
+        for(uint32_t lane = 0; lane < 4; ++lane)
+            inside[i + lane] = ((mask >> lane) & 1) == 0;
+    }
+#endif
+
+    for(; i < count; ++i)
+        inside[i] = intersects(float3(minX[i], minY[i], minZ[i]), float3(maxX[i], maxY[i], maxZ[i]));
+}
+
+void ChunkCuller::update(const VoxelDataStructs::World& world, const CameraView& camera, float aspectRatio)
+{
+    if (boundsRevision != world.revision)
+    {
+        chunkIndices.clear();
+        for(std::vector<float>* bounds : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ})
+            bounds->clear();
+
+        for(uint32_t c = 0; c < (uint32_t)world.chunks.size(); ++c)
+        {
+            const VoxelDataStructs::Chunk& chunk = world.chunks[c];
+            if (chunk.solidCount == 0)
+                continue;
+            chunkIndices.push_back(c);
+            minX.push_back((float)chunk.offsetPos[0]);
+            minY.push_back((float)chunk.offsetPos[1]);
+            minZ.push_back((float)chunk.offsetPos[2]);
+            maxX.push_back((float)(chunk.offsetPos[0] + VoxelDataStructs::chunkSize));
+            maxY.push_back((float)(chunk.offsetPos[1] + VoxelDataStructs::chunkSize));
+            maxZ.push_back((float)(chunk.offsetPos[2] + VoxelDataStructs::chunkSize));
+        }
+        boundsRevision = world.revision;
+    }
+
+    const uint32_t count = (uint32_t)chunkIndices.size();
+    inside.resize(count);
+    Frustum::fromCamera(camera, aspectRatio).cullBoxes(minX.data(), minY.data(), minZ.data(),
+                                                       maxX.data(), maxY.data(), maxZ.data(), count, inside.data());
+
+    visible.clear();
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        if (!inside[i])
+            continue;
+        const float3 boxMin(minX[i], minY[i], minZ[i]);
+        const float3 boxMax(maxX[i], maxY[i], maxZ[i]);
+        const float3 closest = min(max(camera.pos, boxMin), boxMax);
+        visible.push_back({chunkIndices[i], length(closest - camera.pos)});
+    }
+    std::sort(visible.begin(), visible.end(), [](const VisibleChunk& a, const VisibleChunk& b)
+    {
+        return a.distance < b.distance;
+    });
+
+    stats.visible = (uint32_t)visible.size();
+    stats.culled = count - stats.visible;
+    stats.empty = (uint32_t)world.chunks.size() - count;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CPURaytracer.h"
+
+// Points p with dot(normal, p) + d >= 0 are on the inner side.
+struct Plane
+{
+    float3 normal;
+    float d = 0;
+};
+
+// View frustum of the camera, planes pointing inward: near, far, left, right, bottom, top.
+struct Frustum
+{
+    Plane planes[6];
+
+    // Same projection as CPURaytracer::generateRay, fov is vertical and aspectRatio is width / height.
+    static Frustum fromCamera(const CameraView& camera, float aspectRatio);
+
+    bool intersects(const float3& boxMin, const float3& boxMax) const;
+
+    // Where the segment [tMin, tMax] of the ray enters the frustum for good: tMin when it is inside all along,
+    // tMax when its end is outside.
+    float enterDistance(const Ray& ray, float tMin, float tMax) const;
+
+    // Conservative test of count boxes given as separate arrays of coordinates (SSE, four boxes per iteration).
+    // Writes 1 in inside[i] for the boxes that may intersect the frustum.
+    void cullBoxes(const float* minX, const float* minY, const float* minZ,
+                   const float* maxX, const float* maxY, const float* maxZ,
+                   uint32_t count, uint8_t* inside) const;
+};
+
+// Per frame frustum culling of the chunks of a world, producing the front to back list used by
+// CPURaytracer::traceClosest. Chunk bounds are cached and only gathered again when the world changes.
+struct ChunkCuller
+{
+    struct Stats
+    {
+        uint32_t visible = 0;
+        uint32_t culled = 0;
+        // Chunks without any voxel, never tested
+        uint32_t empty = 0;
+    };
+
+    std::vector<VisibleChunk> visible;
+    Stats stats;
+
+    void update(const VoxelDataStructs::World& world, const CameraView& camera, float aspectRatio);
+
+private:
+    uint64_t boundsRevision = UINT64_MAX;
+    std::vector<uint32_t> chunkIndices;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    std::vector<uint8_t> inside;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Fence side of a GPU queue, all the frame pacing needs to know about it.
+// Implemented by CommandQueue on DX12 and by SimulatedGpuQueue everywhere else.
+class GpuTimeline
+{
+public:
+    virtual ~GpuTimeline() = default;
+
+    // Returns the value the fence reaches once everything submitted so far has executed.
+    virtual uint64_t signal() = 0;
+
+    virtual uint64_t completedValue() const = 0;
+
+    // Blocks the calling thread until the fence reaches value.
+    virtual void waitForValue(uint64_t value) = 0;
+};
+
+// Fence moved by hand, for driving allocators and schedulers step by step without any queue.
+// Waiting completes the fence up to the value, as if the GPU finished right then.
+class ManualTimeline : public GpuTimeline
+{
+public:
+    uint64_t signaled = 0;
+    uint64_t completed = 0;
+    uint64_t waits = 0;
+
+    uint64_t signal() override { return ++signaled; }
+    uint64_t completedValue() const override { return completed; }
+
+    void waitForValue(uint64_t value) override
+    {
+        ++waits;
+        if (completed < value)
+            completed = value;
+    }
+
+    void complete(uint64_t value) { completed = value; }
+};
@@ -0,0 +1,25 @@
+#include "ImageIO.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+bool writePPM(const std::filesystem::path& fileName, uint32_t width, uint32_t height, std::span<const uint32_t> pixels)
+{
+    if (pixels.size() != size_t(width) * height)
+        return false;
+
+    std::vector<char> rgb(pixels.size() * 3);
+    for(size_t i = 0; i < pixels.size(); ++i)
+    {
+        rgb[i * 3 + 0] = char(pixels[i] & 0xFF);
+        rgb[i * 3 + 1] = char((pixels[i] >> 8) & 0xFF);
+        rgb[i * 3 + 2] = char((pixels[i] >> 16) & 0xFF);
+    }
+
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    out.write(header.data(), std::streamsize(header.size()));
+    out.write(rgb.data(), std::streamsize(rgb.size()));
+    return out.good();
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// Binary PPM (P6) of an RGBA8 framebuffer laid out like CPURenderer::framebuffer, alpha dropped.
+// No dependency and readable by most image tools, meant for debug dumps and offline renders.
+bool writePPM(const std::filesystem::path& fileName, uint32_t width, uint32_t height, std::span<const uint32_t> pixels);
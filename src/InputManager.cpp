@@ -1,40 +1,33 @@
 #include "InputManager.h"
+#include "Profiler.h"
 #include <Windowsx.h>
 
+#include <cmath>
+#include <cstdlib>
+
 void InputManager::manageInput(UINT message, WPARAM wParam, LPARAM lParam)
 {
 
     switch (message)
     {
         case WM_KEYDOWN:
-            switch (wParam) {
-                case 'D': holdedKey[Right] = true; break;
-                case 'Q': holdedKey[Left] = true; break;
-                case 'Z': holdedKey[Forward] = true; break;
-                case 'S': holdedKey[Backward] = true; break;
-                case 'A': holdedKey[Down] = true; break;
-                case 'E': holdedKey[Up] = true; break;
-            }
-            break;
-
         case WM_KEYUP:
+        {
+            const bool down = message == WM_KEYDOWN;
             switch (wParam) {
-                case 'D': holdedKey[Right] = false; break;
-                case 'Q': holdedKey[Left] = false; break;
-                case 'Z': holdedKey[Forward] = false; break;
-                case 'S': holdedKey[Backward] = false; break;
-                case 'A': holdedKey[Down] = false; break;
-                case 'E': holdedKey[Up] = false; break;
+                case 'D': inputQueue.pushKey(Right, down); break;
+                case 'Q': inputQueue.pushKey(Left, down); break;
+                case 'Z': inputQueue.pushKey(Forward, down); break;
+                case 'S': inputQueue.pushKey(Backward, down); break;
+                case 'A': inputQueue.pushKey(Down, down); break;
+                case 'E': inputQueue.pushKey(Up, down); break;
             }
             break;
+        }
 
         case WM_MOUSEWHEEL:
         {
-            if(GET_WHEEL_DELTA_WPARAM(wParam) < 0){
-                ctx->camera.speed *= 0.92f;
-            } else {
-                ctx->camera.speed *= 1.08f;
-            }
+            inputQueue.pushWheel(GET_WHEEL_DELTA_WPARAM(wParam) < 0 ? -1 : 1);
             break;
         }
 
@@ -56,44 +49,52 @@ void InputManager::ProcessRawInput(LPARAM lParam)
     {
         if (raw.header.dwType == RIM_TYPEMOUSE)
         {
-            // Traiter les données de la souris
-            float mouseDeltaX = raw.data.mouse.lLastX * 0.001f;
-            float mouseDeltaY = raw.data.mouse.lLastY * 0.001f;
-            
-            
-            ctx->camera.rotate({0,1,0}, mouseDeltaX);
-            ctx->camera.rotate(ctx->camera.getRightVec(), mouseDeltaY);
-            ctx->computeAndUploadCameraBuffer();
+            // Traiter les données de la souris : accumulées jusqu'au prochain tick
+            inputQueue.pushMouseMove(raw.data.mouse.lLastX, raw.data.mouse.lLastY);
         }
     }
 }
 
 void InputManager::processTickInput()
 {
-    if (holdedKey[Right])
+    RAYVOX_ZONE("InputManager::processTickInput");
+    const FrameInput input = inputQueue.drain();
+    lastTickInput = input;
+    RAYVOX_COUNTER("input events", input.eventCount);
+
+    if (input.mouseDeltaX != 0 || input.mouseDeltaY != 0)
     {
-        ctx->camera.move(ctx->camera.getRightVec());
+        camera->rotate({0,1,0}, input.mouseDeltaX * 0.001f);
+        camera->rotate(camera->getRightVec(), input.mouseDeltaY * 0.001f);
     }
-    if (holdedKey[Left])
+
+    if (input.wheelNotches != 0)
     {
-        ctx->camera.move(XMVectorNegate(ctx->camera.getRightVec()));
+        camera->speed *= std::pow(input.wheelNotches < 0 ? 0.92f : 1.08f, (float)std::abs(input.wheelNotches));
     }
-    if (holdedKey[Forward])
+
+    if (input.isHeld(Right))
     {
-        ctx->camera.move(ctx->camera.getForwardVec());
+        camera->move(camera->getRightVec());
     }
-    if (holdedKey[Backward])
+    if (input.isHeld(Left))
     {
-        ctx->camera.move(XMVectorNegate(ctx->camera.getForwardVec()));
+        camera->move(XMVectorNegate(camera->getRightVec()));
     }
-    if (holdedKey[Down])
+    if (input.isHeld(Forward))
     {
-        ctx->camera.move({0,-1,0});
+        camera->move(camera->getForwardVec());
     }
-    if (holdedKey[Up])
+    if (input.isHeld(Backward))
     {
-        ctx->camera.move({0,1,0});
+        camera->move(XMVectorNegate(camera->getForwardVec()));
+    }
+    if (input.isHeld(Down))
+    {
+        camera->move({0,-1,0});
+    }
+    if (input.isHeld(Up))
+    {
+        camera->move({0,1,0});
     }
-
-    ctx->computeAndUploadCameraBuffer();
 }
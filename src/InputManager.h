@@ -1,13 +1,17 @@
 #pragma once
 
 #include "includeDX12.h"
-#include "DX12ComputeContext.h"
+#include "Camera.h"
+#include "InputQueue.h"
 
 struct InputManager
 {
-    DX12ComputeContext* ctx;
+    Camera* camera;
+
+    // Filled by the window procedure, applied once per tick by processTickInput
+    InputQueue inputQueue;
+    FrameInput lastTickInput;
 
-    bool holdedKey[9] = {false};
     enum KeyIndex
     {
         Forward,
@@ -25,5 +29,6 @@ struct InputManager
 
     void ProcessRawInput(LPARAM hRawInput);
 
+    // Applies everything captured since the previous tick: one camera rotation for all the mouse packets.
     void processTickInput();
 };
\ No newline at end of file
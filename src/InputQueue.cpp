@@ -0,0 +1,41 @@
+#include "InputQueue.h"
+
+void InputQueue::push(const InputEvent& event)
+{
+    if (!ring.push(event))
+        dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameInput InputQueue::drain()
+{
+    FrameInput input;
+    InputEvent event;
+    while (ring.pop(event))
+    {
+        ++input.eventCount;
+        const uint32_t bit = 1u << (event.key & 31);
+        switch (event.type)
+        {
+            case InputEvent::MouseMove:
+                input.mouseDeltaX += event.x;
+                input.mouseDeltaY += event.y;
+                break;
+            case InputEvent::KeyDown:
+                // Key repeat sends downs for a held key, not a new press
+                if (!(held & bit))
+                    input.pressed |= bit;
+                held |= bit;
+                break;
+            case InputEvent::KeyUp:
+                if (held & bit)
+                    input.released |= bit;
+                held &= ~bit;
+                break;
+            case InputEvent::Wheel:
+                input.wheelNotches += event.x;
+                break;
+        }
+    }
+    input.held = held;
+    return input;
+}
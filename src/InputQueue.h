@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SpscRing.h"
+
+// Raw input as captured by the window thread, before any game logic looks at it.
+// key is an action index (InputManager::KeyIndex), below 32.
+struct InputEvent
+{
+    enum Type : uint8_t
+    {
+        MouseMove,
+        KeyDown,
+        KeyUp,
+        Wheel
+    };
+
+    Type type;
+    uint8_t key;
+    // Mouse counts for MouseMove, notches (positive away from the user) for Wheel
+    int32_t x;
+    int32_t y;
+};
+
+// Everything that happened since the previous tick, folded into one state change.
+struct FrameInput
+{
+    int32_t mouseDeltaX = 0;
+    int32_t mouseDeltaY = 0;
+    int32_t wheelNotches = 0;
+    // Bit per key: held at the end of the tick, went down during it, went up during it.
+    // A key tapped between two ticks is in pressed and released but not in held.
+    uint32_t held = 0;
+    uint32_t pressed = 0;
+    uint32_t released = 0;
+    uint32_t eventCount = 0;
+
+    bool isHeld(uint32_t key) const { return (held >> key) & 1u; }
+};
+
+// Window thread pushes, simulation thread drains once per tick.
+class InputQueue
+{
+public:
+    static constexpr uint32_t capacity = 1024;
+
+    // Producer side. A full queue drops the event and counts it rather than stall the window thread.
+    void push(const InputEvent& event);
+    void pushMouseMove(int32_t dx, int32_t dy) { push({InputEvent::MouseMove, 0, dx, dy}); }
+    void pushKey(uint8_t key, bool down) { push({down ? InputEvent::KeyDown : InputEvent::KeyUp, key, 0, 0}); }
+    void pushWheel(int32_t notches) { push({InputEvent::Wheel, 0, notches, 0}); }
+
+    // Consumer side, folds every pending event in one FrameInput. Held keys carry over between ticks.
+    FrameInput drain();
+
+    uint64_t droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    SpscRing<InputEvent, capacity> ring;
+    std::atomic<uint64_t> dropped{0};
+    uint32_t held = 0;
+};
@@ -0,0 +1,201 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+namespace
+{
+    thread_local const JobSystem* tlsOwner = nullptr;
+    thread_local uint32_t tlsQueueIndex = 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+    for(uint32_t i = 0; i < workerCount + 1; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    workers.reserve(workerCount);
+    for(uint32_t i = 0; i < workerCount; ++i)
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    wakeUp.notify_all();
+
+    for(std::thread& worker : workers)
+        worker.join();
+}
+
+JobSystem& JobSystem::get()
+{
+    static JobSystem instance;
+    return instance;
+}
+
+uint32_t JobSystem::currentQueue() const
+{
+    return tlsOwner == this ? tlsQueueIndex : externalQueue();
+}
+
+void JobSystem::submit(TaskGroup& group, std::function<void()> task, Priority priority)
+{
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    // Counted before it is visible: a thief could otherwise run it and decrement the count below zero
+    queuedTasks.fetch_add(1, std::memory_order_release);
+
+    WorkQueue& queue = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks[(int)priority].push_back({std::move(task), &group});
+    }
+
+    // Taking the lock orders this with a worker checking queuedTasks before sleeping
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_one();
+}
+
+void JobSystem::wait(TaskGroup& group)
+{
+    const uint32_t queueIndex = currentQueue();
+    while (group.pending.load(std::memory_order_acquire) != 0)
+    {
+        if (!tryRunOne(queueIndex))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize,
+                            const std::function<void(uint32_t begin, uint32_t end)>& body, Priority priority)
+{
+    if (count == 0)
+        return;
+    grainSize = std::max(1u, grainSize);
+
+    // Not worth a round trip through the queues
+    if (count <= grainSize)
+    {
+        body(0, count);
+        return;
+    }
+
+    TaskGroup group;
+    for(uint32_t begin = 0; begin < count; begin += grainSize)
+    {
+        const uint32_t end = std::min(count, begin + grainSize);
+        submit(group, [&body, begin, end]() { body(begin, end); }, priority);
+    }
+    wait(group);
+}
+
+bool JobSystem::popLocal(uint32_t queueIndex, Task& task)
+{
+    WorkQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for(auto& tasks : queue.tasks)
+    {
+        if (!tasks.empty())
+        {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::steal(uint32_t thiefIndex, Task& task)
+{
+    const uint32_t queueCount = (uint32_t)queues.size();
+    for(int priority = 0; priority < (int)Priority::Count; ++priority)
+    {
+        for(uint32_t offset = 1; offset < queueCount; ++offset)
+        {
+            WorkQueue& victim = *queues[(thiefIndex + offset) % queueCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            auto& tasks = victim.tasks[priority];
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool JobSystem::tryRunOne(uint32_t queueIndex)
+{
+    Task task;
+    if (!popLocal(queueIndex, task))
+    {
+        // Nothing queued anywhere, not worth locking every victim
+        if (queuedTasks.load(std::memory_order_acquire) == 0)
+        {
+            idlePollCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (!steal(queueIndex, task))
+        {
+            failedStealCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        stealCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+    task.function();
+
+    executedTasks.fetch_add(1, std::memory_order_relaxed);
+    task.group->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+    tlsOwner = this;
+    tlsQueueIndex = index;
+    RAYVOX_THREAD_NAME("Job worker");
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        if (tryRunOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]() {
+            return !running.load(std::memory_order_relaxed) || queuedTasks.load(std::memory_order_acquire) != 0;
+        });
+    }
+}
+
+JobSystem::Stats JobSystem::stats() const
+{
+    Stats s;
+    s.workerCount = workerCount();
+    s.queueDepth = queuedTasks.load(std::memory_order_relaxed);
+    s.executed = executedTasks.load(std::memory_order_relaxed);
+    s.steals = stealCount.load(std::memory_order_relaxed);
+    s.failedSteals = failedStealCount.load(std::memory_order_relaxed);
+    s.idlePolls = idlePollCount.load(std::memory_order_relaxed);
+    return s;
+}
+
+void JobSystem::resetCounters()
+{
+    executedTasks = 0;
+    stealCount = 0;
+    failedStealCount = 0;
+    idlePollCount = 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work stealing thread pool shared by the whole engine (world generation, CPU rendering, ...).
+// Every worker owns one deque per priority: it pops its own work LIFO and steals from the others FIFO.
+// Threads that are not workers (the main thread) push into an extra shared slot and help while waiting.
+class JobSystem
+{
+public:
+    enum class Priority : uint8_t
+    {
+        High,
+        Normal,
+        Low,
+        Count
+    };
+
+    // Counts the tasks still running, wait() returns once it drops to zero.
+    struct TaskGroup
+    {
+        std::atomic<uint32_t> pending{0};
+    };
+
+    struct Stats
+    {
+        uint32_t workerCount = 0;
+        uint32_t queueDepth = 0;
+        uint64_t executed = 0;
+        uint64_t steals = 0;
+        // Steal attempts that found nothing while tasks were queued: lost races with other thieves
+        uint64_t failedSteals = 0;
+        // Looks for work while nothing was queued, from wait() spinning or a worker about to sleep
+        uint64_t idlePolls = 0;
+    };
+
+    // 0 workers means hardware_concurrency - 1, the calling thread being the last one.
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Engine wide instance, created on first use.
+    static JobSystem& get();
+
+    void submit(TaskGroup& group, std::function<void()> task, Priority priority = Priority::Normal);
+
+    // Runs pending tasks on the calling thread until the group is done.
+    void wait(TaskGroup& group);
+
+    // Splits [0, count) in ranges of at most grainSize and blocks until all of them ran.
+    void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& body,
+                     Priority priority = Priority::Normal);
+
+    uint32_t workerCount() const { return (uint32_t)workers.size(); }
+
+    Stats stats() const;
+    void resetCounters();
+
+private:
+    struct Task
+    {
+        std::function<void()> function;
+        TaskGroup* group;
+    };
+
+    struct alignas(64) WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks[(int)Priority::Count];
+    };
+
+    std::vector<std::thread> workers;
+    // One per worker plus the shared slot for external threads, at the back
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<bool> running{true};
+
+    std::atomic<uint32_t> queuedTasks{0};
+    std::atomic<uint64_t> executedTasks{0};
+    std::atomic<uint64_t> stealCount{0};
+    std::atomic<uint64_t> failedStealCount{0};
+    std::atomic<uint64_t> idlePollCount{0};
+
+    uint32_t externalQueue() const { return (uint32_t)queues.size() - 1; }
+    uint32_t currentQueue() const;
+
+    bool popLocal(uint32_t queueIndex, Task& task);
+    bool steal(uint32_t thiefIndex, Task& task);
+    bool tryRunOne(uint32_t queueIndex);
+
+    void workerLoop(uint32_t index);
+};
@@ -0,0 +1,69 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+
+namespace
+{
+    struct TagCounters
+    {
+        std::atomic<uint64_t> current{0};
+        std::atomic<uint64_t> peak{0};
+        std::atomic<uint64_t> allocations{0};
+    };
+
+    TagCounters counters[(size_t)MemoryTag::Count];
+}
+
+namespace MemoryTracker
+{
+    void allocated(MemoryTag tag, size_t bytes)
+    {
+        TagCounters& c = counters[(size_t)tag];
+        c.allocations.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t current = c.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+        uint64_t peak = c.peak.load(std::memory_order_relaxed);
+        while (current > peak && !c.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void freed(MemoryTag tag, size_t bytes)
+    {
+        counters[(size_t)tag].current.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    TagStats stats(MemoryTag tag)
+    {
+        const TagCounters& c = counters[(size_t)tag];
+        return {c.current.load(std::memory_order_relaxed), c.peak.load(std::memory_order_relaxed),
+                c.allocations.load(std::memory_order_relaxed)};
+    }
+
+    uint64_t totalCurrentBytes()
+    {
+        uint64_t total = 0;
+        for (const TagCounters& c : counters)
+            total += c.current.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void resetPeaks()
+    {
+        for (TagCounters& c : counters)
+            c.peak.store(c.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    const char* tagName(MemoryTag tag)
+    {
+        switch (tag)
+        {
+            case MemoryTag::Voxels: return "voxels";
+            case MemoryTag::Trees: return "trees";
+            case MemoryTag::Caches: return "caches";
+            case MemoryTag::Staging: return "staging";
+            case MemoryTag::Framebuffers: return "framebuffers";
+            default: return "?";
+        }
+    }
+}
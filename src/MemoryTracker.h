@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// What the tracked memory is used for.
+enum class MemoryTag : uint8_t
+{
+    // Chunk voxel grids and chunk headers
+    Voxels,
+    // Acceleration structures built from the voxels: SDF bricks, occupancy grids
+    Trees,
+    // Data kept from frame to frame to save work: render history, reprojection
+    Caches,
+    // CPU side of the uploads: dirty ranges waiting to be packed
+    Staging,
+    Framebuffers,
+    Count
+};
+
+// Current and peak bytes per tag, for the containers allocated through TrackedAllocator.
+// Counters are process wide atomics, any thread may allocate.
+namespace MemoryTracker
+{
+    struct TagStats
+    {
+        uint64_t currentBytes = 0;
+        uint64_t peakBytes = 0;
+        uint64_t allocations = 0;
+    };
+
+    void allocated(MemoryTag tag, size_t bytes);
+    void freed(MemoryTag tag, size_t bytes);
+
+    TagStats stats(MemoryTag tag);
+    uint64_t totalCurrentBytes();
+
+    // Peaks restart from the current values, to measure one phase.
+    void resetPeaks();
+
+    const char* tagName(MemoryTag tag);
+}
+
+template <typename T, MemoryTag Tag>
+struct TrackedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = TrackedAllocator<U, Tag>;
+    };
+
+    TrackedAllocator() = default;
+
+    template <typename U>
+    TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t count)
+    {
+        T* p = std::allocator<T>().allocate(count);
+        MemoryTracker::allocated(Tag, count * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, size_t count) noexcept
+    {
+        MemoryTracker::freed(Tag, count * sizeof(T));
+        std::allocator<T>().deallocate(p, count);
+    }
+
+    template <typename U>
+    bool operator==(const TrackedAllocator<U, Tag>&) const noexcept { return true; }
+};
+
+template <typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
@@ -0,0 +1,190 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+    std::atomic<uint64_t> nextInstanceId{1};
+
+    thread_local uint64_t tlsInstanceId = 0;
+    thread_local void* tlsBuffer = nullptr;
+
+    void appendEscaped(std::string& out, const char* text)
+    {
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                out += '\\';
+            if ((unsigned char)*c >= 0x20)
+                out += *c;
+        }
+    }
+}
+
+Profiler::Profiler()
+        : epoch(std::chrono::steady_clock::now()), instanceId(nextInstanceId.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+Profiler& Profiler::get()
+{
+    static Profiler instance;
+    return instance;
+}
+
+void Profiler::beginCapture()
+{
+    capturing.store(true, std::memory_order_release);
+}
+
+void Profiler::endCapture()
+{
+    capturing.store(false, std::memory_order_release);
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (const auto& buffer : buffers)
+    {
+        buffer->count.store(0, std::memory_order_release);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->events.reset();
+    }
+}
+
+uint64_t Profiler::now() const
+{
+    // Never 0, ProfileZone uses it for "not capturing"
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count() + 1;
+}
+
+Profiler::ThreadBuffer& Profiler::threadBuffer()
+{
+    if (tlsInstanceId != instanceId)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffers.back()->threadId = (uint32_t)buffers.size();
+        tlsInstanceId = instanceId;
+        tlsBuffer = buffers.back().get();
+    }
+    return *static_cast<ThreadBuffer*>(tlsBuffer);
+}
+
+void Profiler::push(const Event& event)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    const uint32_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index == eventsPerThread)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Published to the exporter by the release store of count below
+    if (!buffer.events)
+        buffer.events.reset(new Event[eventsPerThread]);
+    buffer.events[index] = event;
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::recordZone(const char* name, uint64_t start, uint64_t end)
+{
+    push({name, start, end - start, EventType::Zone});
+}
+
+void Profiler::recordCounter(const char* name, uint64_t value)
+{
+    push({name, now(), value, EventType::Counter});
+}
+
+void Profiler::setThreadName(const char* name)
+{
+    threadBuffer().name = name;
+}
+
+uint64_t Profiler::recordedEvents() const
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    uint64_t total = 0;
+    for (const auto& buffer : buffers)
+        total += buffer->count.load(std::memory_order_acquire);
+    return total;
+}
+
+uint64_t Profiler::droppedEvents() const
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    uint64_t total = 0;
+    for (const auto& buffer : buffers)
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+size_t Profiler::memoryBytes() const
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    size_t bytes = 0;
+    for (const auto& buffer : buffers)
+    {
+        // Only the owning thread allocates, a set count means the array is visible
+        if (buffer->count.load(std::memory_order_acquire) > 0 || buffer->dropped.load(std::memory_order_relaxed) > 0)
+            bytes += eventsPerThread * sizeof(Event);
+    }
+    return bytes;
+}
+
+std::string Profiler::chromeTrace() const
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    char line[160];
+    bool first = true;
+    auto separator = [&]() { out += first ? "" : ",\n"; first = false; };
+
+    for (const auto& buffer : buffers)
+    {
+        if (buffer->name)
+        {
+            separator();
+            std::snprintf(line, sizeof(line), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"",
+                          buffer->threadId);
+            out += line;
+            appendEscaped(out, buffer->name);
+            out += "\"}}";
+        }
+
+        // Timestamps in microseconds, as the format wants
+        const uint32_t count = buffer->count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const Event& event = buffer->events[i];
+            separator();
+            out += "{\"name\":\"";
+            appendEscaped(out, event.name);
+            if (event.type == EventType::Zone)
+                std::snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                              buffer->threadId, (double)event.start * 1e-3, (double)event.value * 1e-3);
+            else
+                std::snprintf(line, sizeof(line), "\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%llu}}",
+                              buffer->threadId, (double)event.start * 1e-3, (unsigned long long)event.value);
+            out += line;
+        }
+    }
+
+    out += "\n]}\n";
+    return out;
+}
+
+bool Profiler::writeChromeTrace(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    const std::string trace = chromeTrace();
+    file.write(trace.data(), (std::streamsize)trace.size());
+    return (bool)file;
+}
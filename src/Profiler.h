@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped timing zones and counters for the hot paths, exported as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev).
+// Each thread records into its own fixed size buffer, allocated on its first event and freed by clear(). The only
+// shared state touched while recording is the capture flag; a full buffer drops events and counts them. Names must outlive the profiler (string literals).
+// Built without RAYVOX_PROFILER the RAYVOX_ZONE / RAYVOX_COUNTER macros compile to nothing.
+class Profiler
+{
+public:
+    enum class EventType : uint8_t
+    {
+        Zone,
+        Counter
+    };
+
+    struct Event
+    {
+        const char* name;
+        // Nanoseconds since the profiler was created
+        uint64_t start;
+        // Zone duration in nanoseconds, or counter value
+        uint64_t value;
+        EventType type;
+    };
+
+    static constexpr uint32_t eventsPerThread = 1u << 16;
+
+    Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Engine wide instance, created on first use.
+    static Profiler& get();
+
+    bool isCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+    // Events are recorded between the two calls only, recording nothing costs one relaxed load.
+    void beginCapture();
+    void endCapture();
+
+    // Forgets the recorded events and frees their buffers. Only while no thread records, after endCapture().
+    void clear();
+
+    uint64_t now() const;
+
+    void recordZone(const char* name, uint64_t start, uint64_t end);
+    void recordCounter(const char* name, uint64_t value);
+
+    // Shown in the trace instead of the thread number.
+    void setThreadName(const char* name);
+
+    uint64_t recordedEvents() const;
+    uint64_t droppedEvents() const;
+
+    // Event buffers currently allocated, 0 as long as nothing was recorded.
+    size_t memoryBytes() const;
+
+    // Everything recorded so far, call after endCapture(). False when the file cannot be written.
+    bool writeChromeTrace(const std::filesystem::path& path) const;
+    std::string chromeTrace() const;
+
+private:
+    struct ThreadBuffer
+    {
+        // Allocated by the owning thread on its first event, so naming a thread costs no buffer
+        std::unique_ptr<Event[]> events;
+        // Written by the owning thread only, read with acquire by the exporter
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> dropped{0};
+        uint32_t threadId = 0;
+        const char* name = nullptr;
+    };
+
+    ThreadBuffer& threadBuffer();
+    void push(const Event& event);
+
+    std::atomic<bool> capturing{false};
+    const std::chrono::steady_clock::time_point epoch;
+    // Tells the thread local buffer pointers of two profilers apart, even at the same address
+    const uint64_t instanceId;
+
+    // Buffers are only added, once per thread, and live as long as the profiler
+    mutable std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+// Times the enclosing scope.
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+            : name(name), start(Profiler::get().isCapturing() ? Profiler::get().now() : 0)
+    {
+    }
+
+    ~ProfileZone()
+    {
+        if (start != 0)
+            Profiler::get().recordZone(name, start, Profiler::get().now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define RAYVOX_CONCAT_INNER(a, b) a##b
+#define RAYVOX_CONCAT(a, b) RAYVOX_CONCAT_INNER(a, b)
+
+#if defined(RAYVOX_PROFILER)
+#define RAYVOX_ZONE(name) ProfileZone RAYVOX_CONCAT(profileZone_, __LINE__)(name)
+#define RAYVOX_COUNTER(name, value) \
+    do { if (Profiler::get().isCapturing()) Profiler::get().recordCounter(name, (uint64_t)(value)); } while (0)
+#define RAYVOX_THREAD_NAME(name) Profiler::get().setThreadName(name)
+#else
+#define RAYVOX_ZONE(name) ((void)0)
+#define RAYVOX_COUNTER(name, value) ((void)0)
+#define RAYVOX_THREAD_NAME(name) ((void)0)
+#endif
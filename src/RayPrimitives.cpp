@@ -0,0 +1,277 @@
+#include "RayPrimitives.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RAYVOX_PRIMITIVES_SSE 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#include "RayPrimitivesSimd.h"
+
+namespace RayPrimitives
+{
+    Hit intersectSphere(const Ray& ray, const float3& center, float radius)
+    {
+        Hit result;
+
+        const float3 oc = ray.origin - center;
+        const float a = dot(ray.direction, ray.direction);
+        const float b = 2.0f * dot(oc, ray.direction);
+        const float c = dot(oc, oc) - radius * radius;
+        const float discriminant = b * b - 4.0f * a * c;
+
+        if (discriminant > 0.0f)
+        {
+            const float sqrtDiscriminant = std::sqrt(discriminant);
+            const float t1 = (-b - sqrtDiscriminant) / (2.0f * a);
+            const float t2 = (-b + sqrtDiscriminant) / (2.0f * a);
+
+            const float t = std::min(t1, t2);
+            if (t > 0.0f)
+            {
+                result.hit = true;
+                result.distance = t;
+                result.hitPoint = ray.origin + ray.direction * t;
+                result.normal = normalize(result.hitPoint - center);
+            }
+        }
+        return result;
+    }
+
+    bool lineIntersectsBox(const float3& origin, const float3& direction, const float3& center, const float3& extent)
+    {
+        // Ray in the box frame
+        const float3 o = origin - center;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (std::fabs(o[axis]) > extent[axis] && o[axis] * direction[axis] >= 0.0f)
+                return false;
+        }
+
+        const float3 WxD = abs(cross(direction, o));
+        const float3 absD = abs(direction);
+        return WxD.x <= extent.y * absD.z + extent.z * absD.y &&
+               WxD.y <= extent.x * absD.z + extent.z * absD.x &&
+               WxD.z <= extent.x * absD.y + extent.y * absD.x;
+    }
+
+    Hit intersectBox(const Ray& ray, const float3& boxMin, const float3& boxMax)
+    {
+        const float3 invDir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+        const float3 t0s = (boxMin - ray.origin) * invDir;
+        const float3 t1s = (boxMax - ray.origin) * invDir;
+        const float3 tSmaller = min(t0s, t1s);
+        const float3 tBigger = max(t0s, t1s);
+
+        const float tMin = std::max(std::max(tSmaller.x, tSmaller.y), tSmaller.z);
+        const float tMax = std::min(std::min(tBigger.x, tBigger.y), tBigger.z);
+
+        Hit result;
+        result.hit = tMax >= tMin && tMax >= 0.0f;
+        if (!result.hit)
+            return result;
+
+        result.distance = tMin > 0.0f ? tMin : tMax;
+        result.hitPoint = ray.origin + ray.direction * result.distance;
+        if (result.distance == tSmaller.x)
+            result.normal = float3(invDir.x > 0.0f ? -1.0f : 1.0f, 0, 0);
+        else if (result.distance == tSmaller.y)
+            result.normal = float3(0, invDir.y > 0.0f ? -1.0f : 1.0f, 0);
+        else
+            result.normal = float3(0, 0, invDir.z > 0.0f ? -1.0f : 1.0f);
+        return result;
+    }
+
+    float sdBox(const float3& p, const float3& halfExtent)
+    {
+        const float3 q = abs(p) - halfExtent;
+        return length(max(q, float3(0, 0, 0))) + std::min(std::max(q.x, std::max(q.y, q.z)), 0.0f);
+    }
+
+    void RayBatch::resize(uint32_t count)
+    {
+        for (std::vector<float>* v : {&ox, &oy, &oz, &dx, &dy, &dz})
+            v->resize(count);
+    }
+
+    void RayBatch::set(uint32_t i, const Ray& ray)
+    {
+        ox[i] = ray.origin.x;
+        oy[i] = ray.origin.y;
+        oz[i] = ray.origin.z;
+        dx[i] = ray.direction.x;
+        dy[i] = ray.direction.y;
+        dz[i] = ray.direction.z;
+    }
+
+    namespace detail
+    {
+        // Same math as the vector bodies, distance only
+        void sphereScalar(const RayBatch& rays, const float3& center, float radius, float* distance, uint32_t begin)
+        {
+            for (uint32_t i = begin; i < rays.size(); ++i)
+            {
+                const float3 d(rays.dx[i], rays.dy[i], rays.dz[i]);
+                const float3 oc = float3(rays.ox[i], rays.oy[i], rays.oz[i]) - center;
+                const float a = dot(d, d);
+                const float b = 2.0f * dot(oc, d);
+                const float c = dot(oc, oc) - radius * radius;
+                const float discriminant = b * b - 4.0f * a * c;
+
+                const float t1 = (-b - std::sqrt(std::max(discriminant, 0.0f))) / (2.0f * a);
+                distance[i] = discriminant > 0.0f && t1 > 0.0f ? t1 : std::numeric_limits<float>::infinity();
+            }
+        }
+
+        void lineBoxScalar(const RayBatch& rays, const float3& center, const float3& extent, uint8_t* hit, uint32_t begin)
+        {
+            for (uint32_t i = begin; i < rays.size(); ++i)
+                hit[i] = lineIntersectsBox(float3(rays.ox[i], rays.oy[i], rays.oz[i]), float3(rays.dx[i], rays.dy[i], rays.dz[i]),
+                                           center, extent);
+        }
+
+        void slabBoxScalar(const RayBatch& rays, const float3& boxMin, const float3& boxMax, float* distance, uint32_t begin)
+        {
+            for (uint32_t i = begin; i < rays.size(); ++i)
+            {
+                const float3 o(rays.ox[i], rays.oy[i], rays.oz[i]);
+                const float3 invDir(1.0f / rays.dx[i], 1.0f / rays.dy[i], 1.0f / rays.dz[i]);
+                const float3 t0s = (boxMin - o) * invDir;
+                const float3 t1s = (boxMax - o) * invDir;
+                const float3 tSmaller = min(t0s, t1s);
+                const float3 tBigger = max(t0s, t1s);
+                const float tMin = std::max(std::max(tSmaller.x, tSmaller.y), tSmaller.z);
+                const float tMax = std::min(std::min(tBigger.x, tBigger.y), tBigger.z);
+
+                const bool hit = tMax >= tMin && tMax >= 0.0f;
+                distance[i] = hit ? (tMin > 0.0f ? tMin : tMax) : std::numeric_limits<float>::infinity();
+            }
+        }
+
+        void sdBoxScalar(const RayBatch& points, const float3& halfExtent, float* distance, uint32_t begin)
+        {
+            for (uint32_t i = begin; i < points.size(); ++i)
+                distance[i] = sdBox(float3(points.ox[i], points.oy[i], points.oz[i]), halfExtent);
+        }
+    }
+
+    namespace
+    {
+        void sphereBatch(const RayBatch& rays, const float3& center, float radius, float* distance)
+        {
+            detail::sphereScalar(rays, center, radius, distance, 0);
+        }
+
+        void lineBoxBatch(const RayBatch& rays, const float3& center, const float3& extent, uint8_t* hit)
+        {
+            detail::lineBoxScalar(rays, center, extent, hit, 0);
+        }
+
+        void slabBoxBatch(const RayBatch& rays, const float3& boxMin, const float3& boxMax, float* distance)
+        {
+            detail::slabBoxScalar(rays, boxMin, boxMax, distance, 0);
+        }
+
+        void sdBoxBatch(const RayBatch& points, const float3& halfExtent, float* distance)
+        {
+            detail::sdBoxScalar(points, halfExtent, distance, 0);
+        }
+
+        constexpr BatchKernels scalarKernels{&sphereBatch, &lineBoxBatch, &slabBoxBatch, &sdBoxBatch};
+
+#ifdef RAYVOX_PRIMITIVES_SSE
+        struct SseOps
+        {
+            using V = __m128;
+            static constexpr uint32_t width = 4;
+
+            static V load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+            static V set1(float f) { return _mm_set1_ps(f); }
+            static V add(V a, V b) { return _mm_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+            static V madd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static V div(V a, V b) { return _mm_div_ps(a, b); }
+            static V min(V a, V b) { return _mm_min_ps(a, b); }
+            static V max(V a, V b) { return _mm_max_ps(a, b); }
+            static V sqrt(V a) { return _mm_sqrt_ps(a); }
+            static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+            static V greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+            static V greaterEqual(V a, V b) { return _mm_cmpge_ps(a, b); }
+            static V bitAnd(V a, V b) { return _mm_and_ps(a, b); }
+            static V bitOr(V a, V b) { return _mm_or_ps(a, b); }
+            static V select(V mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+            static uint32_t moveMask(V mask) { return (uint32_t)_mm_movemask_ps(mask); }
+        };
+
+        constexpr const BatchKernels& sseKernels = SimdKernels<SseOps>::table;
+
+        bool cpuHasAvx2()
+        {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+            __cpuid(info, 1);
+            // FMA, OSXSAVE and AVX, then the OS has to save the ymm registers
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            if (!fma || (info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+                return false;
+            if ((_xgetbv(0) & 6) != 6)
+                return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        }
+#endif
+    }
+
+    const char* isaName(Isa isa)
+    {
+        switch (isa)
+        {
+            case Isa::Scalar: return "scalar";
+            case Isa::SSE: return "sse";
+            case Isa::AVX2: return "avx2";
+            default: return "?";
+        }
+    }
+
+    bool isAvailable(Isa isa)
+    {
+        return batchKernels(isa) != nullptr;
+    }
+
+    const BatchKernels* batchKernels(Isa isa)
+    {
+        switch (isa)
+        {
+            case Isa::Scalar:
+                return &scalarKernels;
+#ifdef RAYVOX_PRIMITIVES_SSE
+            case Isa::SSE:
+                return &sseKernels;
+#if defined(RAYVOX_AVX2_KERNELS)
+            case Isa::AVX2:
+            {
+                static const bool supported = cpuHasAvx2();
+                return supported ? &detail::avx2Kernels : nullptr;
+            }
+#endif
+#endif
+            default:
+                return nullptr;
+        }
+    }
+}
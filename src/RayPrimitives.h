@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CPURaytracer.h"
+
+// CPU ports of the ray primitives of the compute shaders (ComputeShader.hlsl, ComputeShader_raymarch.hlsl):
+// one ray at a time as written there, and batched over rays stored as x, y, z arrays for the SIMD variants.
+namespace RayPrimitives
+{
+    // IntersectRaySphere: closest intersection in front of the origin. As in the shader, a ray starting inside
+    // the sphere misses.
+    Hit intersectSphere(const Ray& ray, const float3& center, float radius);
+
+    // intersectAABB: does the half line from origin along direction touch the box, without distance.
+    // The shader compares the cross product without abs, which misses lines passing on the negative side of
+    // the box; the port tests |WxD|.
+    bool lineIntersectsBox(const float3& origin, const float3& direction, const float3& center, const float3& extent);
+
+    // RayIntersectsAABB: slab test, with distance and face normal.
+    Hit intersectBox(const Ray& ray, const float3& boxMin, const float3& boxMax);
+
+    // Signed distance to a box centred on the origin.
+    float sdBox(const float3& p, const float3& halfExtent);
+
+    enum class Isa : uint8_t
+    {
+        Scalar,
+        SSE,
+        AVX2,
+        Count
+    };
+
+    const char* isaName(Isa isa);
+
+    // Compiled in and supported by this CPU.
+    bool isAvailable(Isa isa);
+
+    struct RayBatch
+    {
+        std::vector<float> ox, oy, oz;
+        std::vector<float> dx, dy, dz;
+
+        void resize(uint32_t count);
+        void set(uint32_t i, const Ray& ray);
+        uint32_t size() const { return (uint32_t)ox.size(); }
+    };
+
+    // The primitives over a whole batch, against one shape. Distances are +infinity on a miss.
+    struct BatchKernels
+    {
+        void (*sphere)(const RayBatch& rays, const float3& center, float radius, float* distance);
+        void (*lineBox)(const RayBatch& rays, const float3& center, const float3& extent, uint8_t* hit);
+        void (*slabBox)(const RayBatch& rays, const float3& boxMin, const float3& boxMax, float* distance);
+        // Evaluated at the ray origins
+        void (*sdBox)(const RayBatch& points, const float3& halfExtent, float* distance);
+    };
+
+    // nullptr when the variant is not available.
+    const BatchKernels* batchKernels(Isa isa);
+}
@@ -0,0 +1,39 @@
+// AVX2 + FMA variant of the RayPrimitives batch kernels. This file alone is built with AVX2 enabled,
+// RayPrimitives::batchKernels only hands it out once the CPU was checked.
+
+#include <immintrin.h>
+
+#include "RayPrimitivesSimd.h"
+
+namespace
+{
+    struct Avx2Ops
+    {
+        using V = __m256;
+        static constexpr uint32_t width = 8;
+
+        static V load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+        static V set1(float f) { return _mm256_set1_ps(f); }
+        static V add(V a, V b) { return _mm256_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+        static V madd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+        static V div(V a, V b) { return _mm256_div_ps(a, b); }
+        static V min(V a, V b) { return _mm256_min_ps(a, b); }
+        static V max(V a, V b) { return _mm256_max_ps(a, b); }
+        static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+        static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static V greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static V greaterEqual(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static V bitAnd(V a, V b) { return _mm256_and_ps(a, b); }
+        static V bitOr(V a, V b) { return _mm256_or_ps(a, b); }
+        static V select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+        static uint32_t moveMask(V mask) { return (uint32_t)_mm256_movemask_ps(mask); }
+    };
+}
+
+namespace RayPrimitives::detail
+{
+    const BatchKernels avx2Kernels = SimdKernels<Avx2Ops>::table;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+// Batch kernel bodies shared by the SSE and AVX2 variants, written once over a small set of vector operations.
+// Included by RayPrimitives.cpp and by RayPrimitivesAvx2.cpp, which is built with AVX2 enabled: everything is
+// in an anonymous namespace so no function compiled with AVX2 can be picked by the linker for another file.
+
+#include <cstdint>
+#include <limits>
+
+#include "RayPrimitives.h"
+
+namespace RayPrimitives::detail
+{
+    // Scalar versions from index begin to the end of the batch, for the lanes left after the last full vector.
+    void sphereScalar(const RayBatch& rays, const float3& center, float radius, float* distance, uint32_t begin);
+    void lineBoxScalar(const RayBatch& rays, const float3& center, const float3& extent, uint8_t* hit, uint32_t begin);
+    void slabBoxScalar(const RayBatch& rays, const float3& boxMin, const float3& boxMax, float* distance, uint32_t begin);
+    void sdBoxScalar(const RayBatch& points, const float3& halfExtent, float* distance, uint32_t begin);
+
+#if defined(RAYVOX_AVX2_KERNELS)
+    extern const BatchKernels avx2Kernels;
+#endif
+}
+
+namespace
+{
+    using RayPrimitives::BatchKernels;
+    using RayPrimitives::RayBatch;
+
+    template <typename Ops>
+    struct SimdKernels
+    {
+        using V = typename Ops::V;
+
+        static V infinity() { return Ops::set1(std::numeric_limits<float>::infinity()); }
+
+        static void sphere(const RayBatch& rays, const float3& center, float radius, float* distance)
+        {
+            const V cx = Ops::set1(center.x), cy = Ops::set1(center.y), cz = Ops::set1(center.z);
+            const V r2 = Ops::set1(radius * radius);
+            const V zero = Ops::set1(0.0f), two = Ops::set1(2.0f), four = Ops::set1(4.0f);
+
+            const uint32_t count = rays.size();
+            uint32_t i = 0;
+            for (; i + Ops::width <= count; i += Ops::width)
+            {
+                const V dx = Ops::load(&rays.dx[i]), dy = Ops::load(&rays.dy[i]), dz = Ops::load(&rays.dz[i]);
+                const V ocx = Ops::sub(Ops::load(&rays.ox[i]), cx);
+                const V ocy = Ops::sub(Ops::load(&rays.oy[i]), cy);
+                const V ocz = Ops::sub(Ops::load(&rays.oz[i]), cz);
+
+                const V a = Ops::madd(dx, dx, Ops::madd(dy, dy, Ops::mul(dz, dz)));
+                const V b = Ops::mul(two, Ops::madd(ocx, dx, Ops::madd(ocy, dy, Ops::mul(ocz, dz))));
+                const V c = Ops::sub(Ops::madd(ocx, ocx, Ops::madd(ocy, ocy, Ops::mul(ocz, ocz))), r2);
+                const V discriminant = Ops::sub(Ops::mul(b, b), Ops::mul(four, Ops::mul(a, c)));
+
+                // t1 <= t2 since a > 0, so the closest positive one is t1 or nothing
+                const V root = Ops::sqrt(Ops::max(discriminant, zero));
+                const V t1 = Ops::div(Ops::sub(Ops::sub(zero, b), root), Ops::mul(two, a));
+                const V hit = Ops::bitAnd(Ops::greater(discriminant, zero), Ops::greater(t1, zero));
+                Ops::store(distance + i, Ops::select(hit, t1, infinity()));
+            }
+            RayPrimitives::detail::sphereScalar(rays, center, radius, distance, i);
+        }
+
+        static void lineBox(const RayBatch& rays, const float3& center, const float3& extent, uint8_t* hitOut)
+        {
+            const V cx = Ops::set1(center.x), cy = Ops::set1(center.y), cz = Ops::set1(center.z);
+            const V ex = Ops::set1(extent.x), ey = Ops::set1(extent.y), ez = Ops::set1(extent.z);
+            const V zero = Ops::set1(0.0f);
+
+            const uint32_t count = rays.size();
+            uint32_t i = 0;
+            for (; i + Ops::width <= count; i += Ops::width)
+            {
+                const V dx = Ops::load(&rays.dx[i]), dy = Ops::load(&rays.dy[i]), dz = Ops::load(&rays.dz[i]);
+                const V ox = Ops::sub(Ops::load(&rays.ox[i]), cx);
+                const V oy = Ops::sub(Ops::load(&rays.oy[i]), cy);
+                const V oz = Ops::sub(Ops::load(&rays.oz[i]), cz);
+
+                // Outside of the slab of an axis and going away from it
+                V miss = Ops::bitAnd(Ops::greater(Ops::abs(ox), ex), Ops::greaterEqual(Ops::mul(ox, dx), zero));
+                miss = Ops::bitOr(miss, Ops::bitAnd(Ops::greater(Ops::abs(oy), ey), Ops::greaterEqual(Ops::mul(oy, dy), zero)));
+                miss = Ops::bitOr(miss, Ops::bitAnd(Ops::greater(Ops::abs(oz), ez), Ops::greaterEqual(Ops::mul(oz, dz), zero)));
+
+                // Line test: |d x o| against the box projected on each axis
+                const V adx = Ops::abs(dx), ady = Ops::abs(dy), adz = Ops::abs(dz);
+                const V wx = Ops::sub(Ops::mul(dy, oz), Ops::mul(dz, oy));
+                const V wy = Ops::sub(Ops::mul(dz, ox), Ops::mul(dx, oz));
+                const V wz = Ops::sub(Ops::mul(dx, oy), Ops::mul(dy, ox));
+                miss = Ops::bitOr(miss, Ops::greater(Ops::abs(wx), Ops::madd(ey, adz, Ops::mul(ez, ady))));
+                miss = Ops::bitOr(miss, Ops::greater(Ops::abs(wy), Ops::madd(ex, adz, Ops::mul(ez, adx))));
+                miss = Ops::bitOr(miss, Ops::greater(Ops::abs(wz), Ops::madd(ex, ady, Ops::mul(ey, adx))));
+
+                const uint32_t mask = Ops::moveMask(miss);
+                for (uint32_t lane = 0; lane < Ops::width; ++lane)
+                    hitOut[i + lane] = ((mask >> lane) & 1) == 0;
+            }
+            RayPrimitives::detail::lineBoxScalar(rays, center, extent, hitOut, i);
+        }
+
+        static void slabBox(const RayBatch& rays, const float3& boxMin, const float3& boxMax, float* distance)
+        {
+            const V minX = Ops::set1(boxMin.x), minY = Ops::set1(boxMin.y), minZ = Ops::set1(boxMin.z);
+            const V maxX = Ops::set1(boxMax.x), maxY = Ops::set1(boxMax.y), maxZ = Ops::set1(boxMax.z);
+            const V zero = Ops::set1(0.0f), one = Ops::set1(1.0f);
+
+            const uint32_t count = rays.size();
+            uint32_t i = 0;
+            for (; i + Ops::width <= count; i += Ops::width)
+            {
+                const V ox = Ops::load(&rays.ox[i]), oy = Ops::load(&rays.oy[i]), oz = Ops::load(&rays.oz[i]);
+                const V ix = Ops::div(one, Ops::load(&rays.dx[i]));
+                const V iy = Ops::div(one, Ops::load(&rays.dy[i]));
+                const V iz = Ops::div(one, Ops::load(&rays.dz[i]));
+
+                const V t0x = Ops::mul(Ops::sub(minX, ox), ix), t1x = Ops::mul(Ops::sub(maxX, ox), ix);
+                const V t0y = Ops::mul(Ops::sub(minY, oy), iy), t1y = Ops::mul(Ops::sub(maxY, oy), iy);
+                const V t0z = Ops::mul(Ops::sub(minZ, oz), iz), t1z = Ops::mul(Ops::sub(maxZ, oz), iz);
+
+                const V tMin = Ops::max(Ops::max(Ops::min(t0x, t1x), Ops::min(t0y, t1y)), Ops::min(t0z, t1z));
+                const V tMax = Ops::min(Ops::min(Ops::max(t0x, t1x), Ops::max(t0y, t1y)), Ops::max(t0z, t1z));
+
+                const V hit = Ops::bitAnd(Ops::greaterEqual(tMax, tMin), Ops::greaterEqual(tMax, zero));
+                const V t = Ops::select(Ops::greater(tMin, zero), tMin, tMax);
+                Ops::store(distance + i, Ops::select(hit, t, infinity()));
+            }
+            RayPrimitives::detail::slabBoxScalar(rays, boxMin, boxMax, distance, i);
+        }
+
+        static void sdBox(const RayBatch& points, const float3& halfExtent, float* distance)
+        {
+            const V bx = Ops::set1(halfExtent.x), by = Ops::set1(halfExtent.y), bz = Ops::set1(halfExtent.z);
+            const V zero = Ops::set1(0.0f);
+
+            const uint32_t count = points.size();
+            uint32_t i = 0;
+            for (; i + Ops::width <= count; i += Ops::width)
+            {
+                const V qx = Ops::sub(Ops::abs(Ops::load(&points.ox[i])), bx);
+                const V qy = Ops::sub(Ops::abs(Ops::load(&points.oy[i])), by);
+                const V qz = Ops::sub(Ops::abs(Ops::load(&points.oz[i])), bz);
+
+                const V px = Ops::max(qx, zero), py = Ops::max(qy, zero), pz = Ops::max(qz, zero);
+                const V outside = Ops::sqrt(Ops::madd(px, px, Ops::madd(py, py, Ops::mul(pz, pz))));
+                const V inside = Ops::min(Ops::max(qx, Ops::max(qy, qz)), zero);
+                Ops::store(distance + i, Ops::add(outside, inside));
+            }
+            RayPrimitives::detail::sdBoxScalar(points, halfExtent, distance, i);
+        }
+
+        static constexpr BatchKernels table{&sphere, &lineBox, &slabBox, &sdBox};
+    };
+}
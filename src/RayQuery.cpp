@@ -0,0 +1,122 @@
+#include "RayQuery.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace RayQuery
+{
+    namespace
+    {
+        constexpr uint32_t raysPerJob = 512;
+
+        // Spreads the 9 low bits of v so that two zero bits separate each of them
+        uint32_t spreadBits(uint32_t v)
+        {
+            v &= 0x1FF;
+            v = (v | (v << 16)) & 0x030000FF;
+            v = (v | (v << 8)) & 0x0300F00F;
+            v = (v | (v << 4)) & 0x030C30C3;
+            v = (v | (v << 2)) & 0x09249249;
+            return v;
+        }
+
+        // Morton order of the origin in cells of 8 voxels, then direction octant
+        uint32_t coherenceKey(const Request& request)
+        {
+            uint32_t key = 0;
+            for(int a = 0; a < 3; ++a)
+            {
+                const uint32_t cell = (uint32_t)std::clamp((int32_t)std::floor(request.origin[a]) >> 3, 0, 511);
+                key |= spreadBits(cell) << a;
+            }
+            const uint32_t octant = (request.direction.x < 0) | (request.direction.y < 0) << 1 | (request.direction.z < 0) << 2;
+            return key << 3 | octant;
+        }
+
+        Result castOne(const VoxelDataStructs::World& world, const Request& request, uint32_t& steps)
+        {
+            const float length = ::length(request.direction);
+            if (!(length >= FLT_MIN) || !std::isfinite(length))
+                return {};
+
+            Ray ray{request.origin, request.direction / length};
+            const float tMax = request.maxDistance * length;
+
+            float tMin = 0.0f;
+            if (request.flags & SkipOriginVoxel)
+            {
+                // Exit distance of the origin cell
+                const float3 cell = floor(ray.origin);
+                tMin = tMax;
+                for(int a = 0; a < 3; ++a)
+                {
+                    if (ray.direction[a] != 0.0f)
+                    {
+                        const float boundary = ray.direction[a] > 0 ? cell[a] + 1.0f : cell[a];
+                        tMin = std::min(tMin, (boundary - ray.origin[a]) / ray.direction[a]);
+                    }
+                }
+            }
+
+            Result result;
+            if (request.flags & AnyHit)
+            {
+                result.hit = CPURaytracer::traceAny(world, ray, tMin, tMax, &steps);
+                return result;
+            }
+
+            const Hit hit = CPURaytracer::traceClosest(world, ray, tMin, tMax);
+            steps += hit.steps;
+            if (hit.hit)
+            {
+                result.hit = true;
+                result.voxel = hit.voxel;
+                result.normal = hit.normal;
+                result.distance = hit.distance / length;
+            }
+            return result;
+        }
+    }
+
+    BatchStats cast(const VoxelDataStructs::World& world, std::span<const Request> requests, std::span<Result> results,
+                    JobSystem* jobSystem, bool sortForCoherence)
+    {
+        const uint32_t count = (uint32_t)requests.size();
+        JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::get();
+
+        // Key in the high half, request index in the low half, one sort orders both
+        std::vector<uint64_t> order;
+        const bool sorted = sortForCoherence && count >= minRaysToSort;
+        if (sorted)
+        {
+            order.resize(count);
+            jobs.parallelFor(count, 16384, [&](uint32_t begin, uint32_t end)
+            {
+                for(uint32_t i = begin; i < end; ++i)
+                    order[i] = uint64_t(coherenceKey(requests[i])) << 32 | i;
+            });
+            std::sort(order.begin(), order.end());
+        }
+
+        std::atomic<uint32_t> hitCount{0};
+        std::atomic<uint64_t> steps{0};
+        jobs.parallelFor(count, raysPerJob, [&](uint32_t begin, uint32_t end)
+        {
+            uint32_t localHits = 0, localSteps = 0;
+            for(uint32_t i = begin; i < end; ++i)
+            {
+                const uint32_t r = sorted ? (uint32_t)order[i] : i;
+                results[r] = castOne(world, requests[r], localSteps);
+                localHits += results[r].hit;
+            }
+            hitCount.fetch_add(localHits, std::memory_order_relaxed);
+            steps.fetch_add(localSteps, std::memory_order_relaxed);
+        });
+
+        return {count, hitCount.load(), steps.load()};
+    }
+}
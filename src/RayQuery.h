@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "CPURaytracer.h"
+
+class JobSystem;
+
+// Batched ray casts against the voxel world for gameplay code (picking, line of sight, projectiles, ...).
+// On request, rays are reordered internally so that rays starting close to each other and going the same way
+// run back to back on the same worker, results always come back in the order of the requests.
+namespace RayQuery
+{
+    enum Flags : uint32_t
+    {
+        None = 0,
+        // Only tells whether something is hit before maxDistance, voxel and normal are left at 0
+        AnyHit = 1 << 0,
+        // Ignores the voxel containing the origin, for rays cast from the surface of a voxel
+        SkipOriginVoxel = 1 << 1,
+    };
+
+    struct Request
+    {
+        float3 origin;
+        float maxDistance = 0;
+        // Does not need to be normalized, distances are in units of its length.
+        // A zero, denormal or non finite length has no direction, the ray misses.
+        float3 direction;
+        uint32_t flags = None;
+    };
+
+    struct Result
+    {
+        int3 voxel;
+        float distance = 0;
+        float3 normal;
+        bool hit = false;
+    };
+
+    struct BatchStats
+    {
+        uint32_t rayCount = 0;
+        uint32_t hitCount = 0;
+        uint64_t traversalSteps = 0;
+    };
+
+    // Below this many rays the sort costs more than the coherence it brings
+    inline constexpr uint32_t minRaysToSort = 4096;
+
+    // results must hold as many entries as requests. nullptr uses JobSystem::get().
+    // Sorting only pays off on large batches whose rays are spread over the world, measure before enabling it.
+    BatchStats cast(const VoxelDataStructs::World& world, std::span<const Request> requests, std::span<Result> results,
+                    JobSystem* jobSystem = nullptr, bool sortForCoherence = false);
+}
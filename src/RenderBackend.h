@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include "CPURaytracer.h"
+
+// What the frame loop needs from a renderer, so the same loop can drive the DX12 compute
+// context or a headless backend without window nor GPU.
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    // nativeWindow is the HWND on Windows, nullptr for headless backends.
+    virtual void init(void* nativeWindow, uint32_t width, uint32_t height) = 0;
+
+    virtual void resize(uint32_t width, uint32_t height) = 0;
+
+    // Called once per frame before render().
+    virtual void uploadCamera(const CameraView& camera) = 0;
+
+    virtual void render() = 0;
+
+    virtual void present() = 0;
+
+    // Waits for the work in flight and releases the backend objects, last call before exit.
+    virtual void flush() = 0;
+
+    virtual bool isReady() const = 0;
+
+    // One frame as App runs it.
+    void frame(const CameraView& camera)
+    {
+        uploadCamera(camera);
+        render();
+        present();
+    }
+};
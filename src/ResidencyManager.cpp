@@ -0,0 +1,121 @@
+#include "ResidencyManager.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+std::vector<ResidencyManager::LodCost> ResidencyManager::defaultLodCosts(uint32_t lodCount)
+{
+    std::vector<LodCost> costs;
+    for (uint32_t lod = 0; lod < lodCount; ++lod)
+    {
+        const uint64_t side = uint64_t(VoxelDataStructs::chunkSize) >> lod;
+        const uint64_t bytes = side * side * side * sizeof(uint32_t);
+        costs.push_back({bytes, bytes});
+    }
+    return costs;
+}
+
+ResidencyManager::ResidencyManager(uint32_t chunkCount, Budget budget, std::vector<LodCost> lodCosts)
+        : chunks(chunkCount), lodCosts(std::move(lodCosts)), memoryBudget(budget)
+{
+}
+
+void ResidencyManager::markVisible(std::span<const VisibleChunk> visible, float lodDistance)
+{
+    const uint8_t coarsest = uint8_t(lodCosts.size() - 1);
+    for (const VisibleChunk& v : visible)
+    {
+        chunks[v.chunk].lastVisibleFrame = frame;
+        request(v.chunk, (uint8_t)std::min<float>(coarsest, std::max(0.0f, v.distance) / lodDistance));
+    }
+}
+
+void ResidencyManager::request(uint32_t chunk, uint8_t lod)
+{
+    ChunkState& state = chunks[chunk];
+    if (state.requested == notResident)
+        requestedChunks.push_back(chunk);
+    state.requested = std::min(state.requested, std::min(lod, uint8_t(lodCosts.size() - 1)));
+}
+
+void ResidencyManager::update()
+{
+    RAYVOX_ZONE("ResidencyManager::update");
+    frameChanges.clear();
+    ++residencyCounters.frames;
+
+    // Loads and refinements, a chunk finer than asked keeps its level until memory is needed
+    for (uint32_t chunk : requestedChunks)
+    {
+        ChunkState& state = chunks[chunk];
+        if (state.requested < state.lod)
+        {
+            if (state.lastEvictedFrame && frame - state.lastEvictedFrame < churnWindow)
+                ++residencyCounters.churn;
+            ++(state.lod == notResident ? residencyCounters.loads : residencyCounters.refines);
+            setLod(chunk, state.requested);
+        }
+        state.requested = notResident;
+    }
+    requestedChunks.clear();
+
+    if (overBudget())
+    {
+        // Not seen during the window, least recently seen first
+        candidates.clear();
+        for (uint32_t c = 0; c < (uint32_t)chunks.size(); ++c)
+        {
+            const ChunkState& state = chunks[c];
+            if (state.lod != notResident && state.lastVisibleFrame + visibilityWindow <= frame)
+                candidates.push_back(c);
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b)
+        {
+            return chunks[a].lastVisibleFrame < chunks[b].lastVisibleFrame;
+        });
+
+        // Rounds over the candidates, each one a level coarser per round, dropped past the coarsest level
+        bool progressed = true;
+        while (overBudget() && progressed)
+        {
+            progressed = false;
+            for (uint32_t chunk : candidates)
+            {
+                ChunkState& state = chunks[chunk];
+                if (state.lod == notResident)
+                    continue;
+
+                const bool coarsest = state.lod + 1u >= lodCosts.size();
+                ++(coarsest ? residencyCounters.drops : residencyCounters.degrades);
+                setLod(chunk, coarsest ? notResident : uint8_t(state.lod + 1));
+                state.lastEvictedFrame = frame;
+                progressed = true;
+                if (!overBudget())
+                    break;
+            }
+        }
+
+        residencyCounters.overrunFrames += overBudget();
+    }
+
+    ++frame;
+}
+
+void ResidencyManager::setLod(uint32_t chunk, uint8_t lod)
+{
+    ChunkState& state = chunks[chunk];
+    if (state.lod != notResident)
+    {
+        usedCpu -= lodCosts[state.lod].cpuBytes;
+        usedGpu -= lodCosts[state.lod].gpuBytes;
+        --resident;
+    }
+    if (lod != notResident)
+    {
+        usedCpu += lodCosts[lod].cpuBytes;
+        usedGpu += lodCosts[lod].gpuBytes;
+        ++resident;
+    }
+    frameChanges.push_back({chunk, state.lod, lod});
+    state.lod = lod;
+}
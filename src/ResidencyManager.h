@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "CPURaytracer.h"
+
+// Decides which chunks stay in memory, and at which level of detail, under a CPU and a device memory budget.
+// The renderer reports the chunks it sees every frame, update() then loads what was asked for and, while over
+// budget, degrades the chunks not seen for the longest time one level at a time before dropping them.
+// Chunks seen during the last visibilityWindow frames are never evicted, when they alone exceed the budget
+// the frame counts as an overrun. The manager only does the bookkeeping: changes() tells the streaming
+// code what to build, upload or free. Neither CPURenderer nor the DX12 backend drives it yet, only the bench does.
+class ResidencyManager
+{
+public:
+    static constexpr uint8_t notResident = 0xFF;
+
+    struct Budget
+    {
+        uint64_t cpuBytes;
+        uint64_t gpuBytes;
+    };
+
+    // Memory of one chunk at a level of detail, level 0 is the finest
+    struct LodCost
+    {
+        uint64_t cpuBytes;
+        uint64_t gpuBytes;
+    };
+
+    struct Change
+    {
+        uint32_t chunk;
+        // notResident for a load or a drop
+        uint8_t fromLod;
+        uint8_t toLod;
+    };
+
+    struct Counters
+    {
+        uint64_t frames = 0;
+        // Frames that ended over budget, only with chunks seen recently left
+        uint64_t overrunFrames = 0;
+        uint64_t loads = 0;
+        uint64_t refines = 0;
+        uint64_t degrades = 0;
+        uint64_t drops = 0;
+        // Chunks loaded or refined again less than churnWindow frames after being degraded or dropped
+        uint64_t churn = 0;
+    };
+
+    // Frames during which a visible chunk is protected from eviction
+    uint32_t visibilityWindow = 8;
+    uint32_t churnWindow = 120;
+
+    // Dense chunkSize^3 colors at level 0, every coarser level halves the resolution
+    static std::vector<LodCost> defaultLodCosts(uint32_t lodCount = 4);
+
+    ResidencyManager(uint32_t chunkCount, Budget budget, std::vector<LodCost> lodCosts = defaultLodCosts());
+
+    // Chunks seen this frame, each wanted at level distance / lodDistance (clamped to the coarsest).
+    void markVisible(std::span<const VisibleChunk> chunks, float lodDistance);
+
+    // Asks for a chunk at a level without marking it visible, for prefetching.
+    void request(uint32_t chunk, uint8_t lod);
+
+    // Applies this frame's requests then evicts down to the budget, changes() lists what moved.
+    void update();
+
+    const std::vector<Change>& changes() const { return frameChanges; }
+
+    uint8_t residentLod(uint32_t chunk) const { return chunks[chunk].lod; }
+    uint64_t cpuBytes() const { return usedCpu; }
+    uint64_t gpuBytes() const { return usedGpu; }
+    uint32_t residentCount() const { return resident; }
+    const Budget& budget() const { return memoryBudget; }
+    const Counters& counters() const { return residencyCounters; }
+
+private:
+    struct ChunkState
+    {
+        uint8_t lod = notResident;
+        uint8_t requested = notResident;
+        uint64_t lastVisibleFrame = 0;
+        // Frame of the last degrade or drop, 0 when it never happened
+        uint64_t lastEvictedFrame = 0;
+    };
+
+    bool overBudget() const { return usedCpu > memoryBudget.cpuBytes || usedGpu > memoryBudget.gpuBytes; }
+    void setLod(uint32_t chunk, uint8_t lod);
+
+    std::vector<ChunkState> chunks;
+    std::vector<LodCost> lodCosts;
+    Budget memoryBudget;
+
+    uint64_t frame = 1;
+    uint64_t usedCpu = 0;
+    uint64_t usedGpu = 0;
+    uint32_t resident = 0;
+
+    std::vector<uint32_t> requestedChunks;
+    std::vector<uint32_t> candidates;
+    std::vector<Change> frameChanges;
+    Counters residencyCounters;
+};
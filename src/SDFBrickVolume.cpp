@@ -0,0 +1,441 @@
+#include "SDFBrickVolume.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+using VoxelDataStructs::World;
+
+namespace
+{
+    constexpr float farDistance = 1e20f;
+
+    int32_t floorDiv(int32_t a, int32_t b)
+    {
+        return a >= 0 ? a / b : -((-a + b - 1) / b);
+    }
+
+    // 1D squared euclidean distance transform (Felzenszwalb & Huttenlocher), in place on f
+    void distanceTransform1D(float* f, int32_t n, std::vector<float>& d, std::vector<int32_t>& v, std::vector<float>& z)
+    {
+        d.resize(n);
+        v.resize(n);
+        z.resize(n + 1);
+
+        int32_t k = 0;
+        v[0] = 0;
+        z[0] = -std::numeric_limits<float>::infinity();
+        z[1] = std::numeric_limits<float>::infinity();
+        for(int32_t q = 1; q < n; ++q)
+        {
+            float s = ((f[q] + float(q * q)) - (f[v[k]] + float(v[k] * v[k]))) / float(2 * q - 2 * v[k]);
+            while (s <= z[k])
+            {
+                --k;
+                s = ((f[q] + float(q * q)) - (f[v[k]] + float(v[k] * v[k]))) / float(2 * q - 2 * v[k]);
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = std::numeric_limits<float>::infinity();
+        }
+
+        k = 0;
+        for(int32_t q = 0; q < n; ++q)
+        {
+            while (z[k + 1] < float(q))
+                ++k;
+            d[q] = float((q - v[k]) * (q - v[k])) + f[v[k]];
+        }
+        std::copy(d.begin(), d.end(), f);
+    }
+
+    // Squared distance transform of a n^3 grid, separable along the three axes
+    void distanceTransform3D(std::vector<float>& grid, int32_t n)
+    {
+        thread_local std::vector<float> line, d, z;
+        thread_local std::vector<int32_t> v;
+        line.resize(n);
+
+        const int32_t strides[3] = {1, n, n * n};
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            const int32_t stride = strides[axis];
+            const int32_t otherA = strides[(axis + 1) % 3];
+            const int32_t otherB = strides[(axis + 2) % 3];
+            for(int32_t a = 0; a < n; ++a)
+            {
+                for(int32_t b = 0; b < n; ++b)
+                {
+                    const int32_t base = a * otherA + b * otherB;
+                    float lineMin = farDistance;
+                    for(int32_t i = 0; i < n; ++i)
+                    {
+                        line[i] = grid[base + i * stride];
+                        lineMin = std::min(lineMin, line[i]);
+                    }
+                    // Nothing to propagate along an untouched line
+                    if (lineMin >= farDistance)
+                        continue;
+                    distanceTransform1D(line.data(), n, d, v, z);
+                    for(int32_t i = 0; i < n; ++i)
+                        grid[base + i * stride] = line[i];
+                }
+            }
+        }
+    }
+}
+
+SDFBrickVolume::BrickClass SDFBrickVolume::computeBrick(const World& world, int32_t bx, int32_t by, int32_t bz,
+                                      std::vector<int8_t>& samples) const
+{
+    // Voxels further than margin from every sample cannot change a distance below band
+    const int32_t margin = (int32_t)std::ceil(band);
+    const int32_t n = samplesPerAxis + 2 * margin;
+    const int32_t origin[3] = {bx * brickSize - margin, by * brickSize - margin, bz * brickSize - margin};
+
+    // Whole region inside empty or full chunks, no need to look at the voxels
+    {
+        bool allEmpty = true, allFull = true;
+        int32_t c0[3], c1[3];
+        for(int a = 0; a < 3; ++a)
+        {
+            c0[a] = std::max(0, floorDiv(origin[a], VoxelDataStructs::chunkSize));
+            c1[a] = std::min(world.chunkCount[a] - 1, floorDiv(origin[a] + n - 1, VoxelDataStructs::chunkSize));
+            // Part of the region is outside of the world, which counts as empty
+            allFull &= origin[a] >= 0 && origin[a] + n <= world.sizeInVoxels(a);
+        }
+        for(int32_t cz = c0[2]; cz <= c1[2]; ++cz)
+            for(int32_t cy = c0[1]; cy <= c1[1]; ++cy)
+                for(int32_t cx = c0[0]; cx <= c1[0]; ++cx)
+                {
+                    const uint32_t count = world.chunkAt(cx, cy, cz).solidCount;
+                    allEmpty &= count == 0;
+                    allFull &= count == uint32_t(VoxelDataStructs::chunkSize * VoxelDataStructs::chunkSize * VoxelDataStructs::chunkSize);
+                }
+        if (allEmpty)
+            return BrickClass::Empty;
+        if (allFull)
+            return BrickClass::Solid;
+    }
+
+    thread_local std::vector<uint8_t> solid;
+    thread_local std::vector<float> toSolid, toEmpty;
+    solid.resize(size_t(n) * n * n);
+
+    uint32_t solidCount = 0;
+    for(int32_t z = 0; z < n; ++z)
+    {
+        for(int32_t y = 0; y < n; ++y)
+        {
+            for(int32_t x = 0; x < n; ++x)
+            {
+                const bool s = world.voxelAt(origin[0] + x, origin[1] + y, origin[2] + z) != 0;
+                solid[x + n * (y + n * z)] = s;
+                solidCount += s;
+            }
+        }
+    }
+
+    if (solidCount == 0)
+        return BrickClass::Empty;
+    if (solidCount == solid.size())
+        return BrickClass::Solid;
+
+    toSolid.resize(solid.size());
+    toEmpty.resize(solid.size());
+    for(size_t i = 0; i < solid.size(); ++i)
+    {
+        toSolid[i] = solid[i] ? 0.0f : farDistance;
+        toEmpty[i] = solid[i] ? farDistance : 0.0f;
+    }
+    distanceTransform3D(toSolid, n);
+    distanceTransform3D(toEmpty, n);
+
+    samples.resize(samplesPerBrick);
+    bool allOutside = true, allInside = true;
+    for(int32_t z = 0; z < samplesPerAxis; ++z)
+    {
+        for(int32_t y = 0; y < samplesPerAxis; ++y)
+        {
+            for(int32_t x = 0; x < samplesPerAxis; ++x)
+            {
+                const size_t r = size_t(x + margin) + n * (size_t(y + margin) + n * size_t(z + margin));
+
+                // Centre to centre distance, minus half a voxel to land on the face of the neighbour
+                const float d = solid[r] ? -(std::sqrt(toEmpty[r]) - 0.5f) : std::sqrt(toSolid[r]) - 0.5f;
+                const int8_t q = (int8_t)std::lround(std::clamp(d / band, -1.0f, 1.0f) * 127.0f);
+
+                samples[x + samplesPerAxis * (y + samplesPerAxis * z)] = q;
+                allOutside &= q == 127;
+                allInside &= q == -127;
+            }
+        }
+    }
+
+    if (allOutside)
+        return BrickClass::Empty;
+    if (allInside)
+        return BrickClass::Solid;
+    return BrickClass::Surface;
+}
+
+uint32_t SDFBrickVolume::storeBrick(const std::vector<int8_t>& samples)
+{
+    uint32_t slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        slot = uint32_t(atlas.size() / samplesPerBrick);
+        atlas.resize(atlas.size() + samplesPerBrick);
+    }
+    std::copy(samples.begin(), samples.end(), atlas.begin() + size_t(slot) * samplesPerBrick);
+    return slot;
+}
+
+void SDFBrickVolume::releaseBrick(uint32_t slot)
+{
+    freeSlots.push_back(slot);
+}
+
+void SDFBrickVolume::build(const World& world, JobSystem* jobSystem)
+{
+    for(int a = 0; a < 3; ++a)
+        gridSize[a] = world.sizeInVoxels(a) / brickSize;
+
+    brickIndex.assign(size_t(gridSize[0]) * gridSize[1] * gridSize[2], emptyBrick);
+    atlas.clear();
+    freeSlots.clear();
+
+    std::mutex atlasMutex;
+    JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::get();
+    jobs.parallelFor(uint32_t(gridSize[1] * gridSize[2]), 1, [&](uint32_t begin, uint32_t end)
+    {
+        std::vector<int8_t> samples;
+        for(uint32_t row = begin; row < end; ++row)
+        {
+            const int32_t by = int32_t(row) % gridSize[1];
+            const int32_t bz = int32_t(row) / gridSize[1];
+            for(int32_t bx = 0; bx < gridSize[0]; ++bx)
+            {
+                const auto c = computeBrick(world, bx, by, bz, samples);
+                if (c == BrickClass::Empty)
+                    continue;
+
+                uint32_t slot = solidBrick;
+                if (c == BrickClass::Surface)
+                {
+                    std::lock_guard<std::mutex> lock(atlasMutex);
+                    slot = storeBrick(samples);
+                }
+                indexAt(bx, by, bz) = slot;
+            }
+        }
+    });
+}
+
+void SDFBrickVolume::rebuildBrick(const World& world, int32_t bx, int32_t by, int32_t bz)
+{
+    std::vector<int8_t> samples;
+    const auto c = computeBrick(world, bx, by, bz, samples);
+
+    uint32_t& slot = indexAt(bx, by, bz);
+    const bool wasAllocated = slot != emptyBrick && slot != solidBrick;
+
+    if (c == BrickClass::Surface)
+    {
+        if (wasAllocated)
+            std::copy(samples.begin(), samples.end(), atlas.begin() + size_t(slot) * samplesPerBrick);
+        else
+            slot = storeBrick(samples);
+        return;
+    }
+
+    if (wasAllocated)
+        releaseBrick(slot);
+    slot = c == BrickClass::Empty ? emptyBrick : solidBrick;
+}
+
+void SDFBrickVolume::updateVoxel(const World& world, int32_t x, int32_t y, int32_t z)
+{
+    // A sample only moves when the edited voxel is closer than band plus half a voxel, centre to centre
+    const float reach = band + 0.5f;
+    const int32_t margin = (int32_t)std::ceil(band);
+    const bool solid = world.voxelAt(x, y, z) != 0;
+    const int32_t p[3] = {x, y, z};
+    for(int a = 0; a < 3; ++a)
+        if (p[a] < 0 || p[a] >= gridSize[a] * brickSize)
+            return;
+
+    // The sample on the voxel centre is negative exactly when the voxel was solid, a colour change moves nothing
+    const uint32_t ownSlot = indexAt(x / brickSize, y / brickSize, z / brickSize);
+    bool wasSolid = ownSlot == solidBrick;
+    if (ownSlot != emptyBrick && ownSlot != solidBrick)
+    {
+        const int32_t local = x % brickSize + samplesPerAxis * (y % brickSize + samplesPerAxis * (z % brickSize));
+        wasSolid = atlas[size_t(ownSlot) * samplesPerBrick + local] < 0;
+    }
+    if (wasSolid == solid)
+        return;
+
+    int32_t first[3], last[3];
+    for(int a = 0; a < 3; ++a)
+    {
+        // Brick b holds the samples of voxels [b * brickSize, b * brickSize + brickSize]
+        first[a] = std::max(0, floorDiv(p[a] - margin - 1, brickSize));
+        last[a] = std::min(gridSize[a] - 1, floorDiv(p[a] + margin, brickSize));
+    }
+
+    for(int32_t bz = first[2]; bz <= last[2]; ++bz)
+    {
+        for(int32_t by = first[1]; by <= last[1]; ++by)
+        {
+            for(int32_t bx = first[0]; bx <= last[0]; ++bx)
+            {
+                // Filling a solid brick or carving an empty one only pushes its samples further past the band
+                const uint32_t slot = indexAt(bx, by, bz);
+                if (slot == (solid ? solidBrick : emptyBrick))
+                    continue;
+
+                // Corner bricks of the margin box can be out of reach of the voxel
+                const int32_t b[3] = {bx, by, bz};
+                float distanceSq = 0;
+                for(int a = 0; a < 3; ++a)
+                {
+                    const float offset = float(p[a] - std::clamp(p[a], b[a] * brickSize, b[a] * brickSize + brickSize));
+                    distanceSq += offset * offset;
+                }
+                if (distanceSq >= reach * reach)
+                    continue;
+
+                rebuildBrick(world, bx, by, bz);
+            }
+        }
+    }
+}
+
+float SDFBrickVolume::distance(const float3& p) const
+{
+    uint32_t slot;
+    return lookup(p, slot);
+}
+
+float SDFBrickVolume::lookup(const float3& p, uint32_t& slot) const
+{
+    // Sample space, samples sit on voxel centres
+    float3 s = p - float3(0.5f, 0.5f, 0.5f);
+    int32_t b[3];
+    for(int a = 0; a < 3; ++a)
+    {
+        const float size = float(gridSize[a] * brickSize);
+        // Rays clipped to the world start on its bounds, give them some slack for the rounding of t
+        if (p[a] < -1e-2f || p[a] > size + 1e-2f)
+        {
+            slot = emptyBrick;
+            return band;
+        }
+        s[a] = std::clamp(s[a], 0.0f, size - 1e-3f);
+        b[a] = std::min(gridSize[a] - 1, int32_t(s[a]) / brickSize);
+    }
+
+    slot = indexAt(b[0], b[1], b[2]);
+    if (slot == emptyBrick)
+        return band;
+    if (slot == solidBrick)
+        return -band;
+
+    const int8_t* brick = atlas.data() + size_t(slot) * samplesPerBrick;
+    int32_t i[3];
+    float f[3];
+    for(int a = 0; a < 3; ++a)
+    {
+        const float local = s[a] - float(b[a] * brickSize);
+        i[a] = std::min(brickSize - 1, int32_t(local));
+        f[a] = local - float(i[a]);
+    }
+
+    auto sample = [&](int32_t dx, int32_t dy, int32_t dz)
+    {
+        return (float)brick[(i[0] + dx) + samplesPerAxis * ((i[1] + dy) + samplesPerAxis * (i[2] + dz))];
+    };
+    const float c00 = sample(0, 0, 0) + (sample(1, 0, 0) - sample(0, 0, 0)) * f[0];
+    const float c10 = sample(0, 1, 0) + (sample(1, 1, 0) - sample(0, 1, 0)) * f[0];
+    const float c01 = sample(0, 0, 1) + (sample(1, 0, 1) - sample(0, 0, 1)) * f[0];
+    const float c11 = sample(0, 1, 1) + (sample(1, 1, 1) - sample(0, 1, 1)) * f[0];
+    const float c0 = c00 + (c10 - c00) * f[1];
+    const float c1 = c01 + (c11 - c01) * f[1];
+    return (c0 + (c1 - c0) * f[2]) * (band / 127.0f);
+}
+
+Hit SDFBrickVolume::trace(const World& world, const Ray& ray, float tMin, float tMax,
+                          uint32_t maxSteps, TraceStats* traceStats) const
+{
+    // Covers the quantization, the diagonal error of the centre to centre distance and the trilinear error
+    constexpr float safety = 1.0f;
+    constexpr float refineLength = (float)brickSize;
+
+    TraceStats localStats;
+    TraceStats& ts = traceStats ? *traceStats : localStats;
+
+    float tEnter, tExit;
+    if (!CPURaytracer::clipToWorld(world, ray, tMin, tMax, tEnter, tExit))
+        return {};
+
+    float t = tEnter;
+    for(uint32_t step = 0; step < maxSteps && t <= tExit; ++step)
+    {
+        ++ts.marchSteps;
+        const float3 p = ray.origin + ray.direction * t;
+        uint32_t slot;
+        const float d = lookup(p, slot) - safety;
+
+        if (d <= 0.0f)
+        {
+            const float tEnd = std::min(tExit, t + refineLength);
+            Hit hit = CPURaytracer::traceClosest(world, ray, t, tEnd);
+            ts.refineSteps += hit.steps;
+            if (hit.hit)
+            {
+                hit.steps = ts.marchSteps + ts.refineSteps;
+                return hit;
+            }
+            // Grazing ray, the surface was close but not along it
+            t = tEnd + 1e-3f;
+            continue;
+        }
+
+        // Empty bricks have no surface within band of any of their points, skip them entirely
+        if (slot == emptyBrick)
+        {
+            float exit = std::numeric_limits<float>::max();
+            for(int a = 0; a < 3; ++a)
+            {
+                const int32_t b = std::clamp(int32_t(std::floor((p[a] - 0.5f) / brickSize)), 0, gridSize[a] - 1);
+                const float boundary = ray.direction[a] > 0 ? float((b + 1) * brickSize) + 0.5f : float(b * brickSize) + 0.5f;
+                if (std::fabs(ray.direction[a]) > 1e-8f)
+                    exit = std::min(exit, (boundary - ray.origin[a]) / ray.direction[a]);
+            }
+            t = std::max(t + d, exit + 1e-3f);
+        }
+        else
+        {
+            t += d;
+        }
+    }
+
+    // Out of march steps (long grazing rays), the DDA finishes the job so the result stays exact
+    Hit hit;
+    if (t <= tExit)
+    {
+        hit = CPURaytracer::traceClosest(world, ray, t, tExit);
+        ts.refineSteps += hit.steps;
+    }
+    hit.steps = ts.marchSteps + ts.refineSteps;
+    return hit;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CPURaytracer.h"
+#include "MemoryTracker.h"
+
+class JobSystem;
+
+// Sparse narrow band signed distance field of the voxel world.
+// The world is cut in brickSize^3 bricks, an index grid maps each brick to a slot in the atlas or marks it
+// as empty (no surface within band) or solid. Allocated bricks store (brickSize + 1)^3 int8 samples taken at
+// voxel centres, the extra layer duplicating the first samples of the next brick so a trilinear lookup never
+// has to read two bricks.
+struct SDFBrickVolume
+{
+    static constexpr int32_t brickSize = 8;
+    static constexpr int32_t samplesPerAxis = brickSize + 1;
+    static constexpr int32_t samplesPerBrick = samplesPerAxis * samplesPerAxis * samplesPerAxis;
+
+    static constexpr uint32_t emptyBrick = UINT32_MAX;
+    static constexpr uint32_t solidBrick = UINT32_MAX - 1;
+
+    // Distances are clamped to [-band, band] voxels and quantized on 8 bits
+    float band = 4.0f;
+
+    int32_t gridSize[3] = {0, 0, 0};
+    TrackedVector<uint32_t, MemoryTag::Trees> brickIndex;
+    TrackedVector<int8_t, MemoryTag::Trees> atlas;
+    TrackedVector<uint32_t, MemoryTag::Trees> freeSlots;
+
+    struct TraceStats
+    {
+        uint32_t marchSteps = 0;
+        uint32_t refineSteps = 0;
+    };
+
+    // Builds every brick from the world, one job per row of bricks.
+    void build(const VoxelDataStructs::World& world, JobSystem* jobSystem = nullptr);
+
+    // Rebuilds the bricks holding a sample within band of the edited voxel. Nothing is rebuilt when the voxel
+    // kept its solidity, nor the solid bricks when it was filled or the empty ones when it was carved, as their
+    // samples stay clamped to the band.
+    void updateVoxel(const VoxelDataStructs::World& world, int32_t x, int32_t y, int32_t z);
+
+    void rebuildBrick(const VoxelDataStructs::World& world, int32_t bx, int32_t by, int32_t bz);
+
+    // Trilinear lookup, in voxels. Positive outside of the geometry.
+    float distance(const float3& p) const;
+
+    // Sphere traces the field until it is within a voxel of the surface, then finishes with a short DDA in
+    // the world so the hit voxel, normal and distance are exact.
+    Hit trace(const VoxelDataStructs::World& world, const Ray& ray, float tMin, float tMax,
+              uint32_t maxSteps = 256, TraceStats* traceStats = nullptr) const;
+
+    uint32_t allocatedBrickCount() const { return uint32_t(atlas.size() / samplesPerBrick - freeSlots.size()); }
+
+    size_t memoryBytes() const { return brickIndex.size() * sizeof(uint32_t) + atlas.size() + freeSlots.size() * sizeof(uint32_t); }
+
+    uint32_t& indexAt(int32_t bx, int32_t by, int32_t bz)
+    {
+        return brickIndex[bx + gridSize[0] * (by + gridSize[1] * bz)];
+    }
+
+    uint32_t indexAt(int32_t bx, int32_t by, int32_t bz) const
+    {
+        return brickIndex[bx + gridSize[0] * (by + gridSize[1] * bz)];
+    }
+
+private:
+    enum class BrickClass
+    {
+        Empty,
+        Solid,
+        Surface
+    };
+
+    float lookup(const float3& p, uint32_t& slot) const;
+
+    // Samples are only filled for surface bricks
+    BrickClass computeBrick(const VoxelDataStructs::World& world, int32_t bx, int32_t by, int32_t bz,
+                            std::vector<int8_t>& samples) const;
+
+    uint32_t storeBrick(const std::vector<int8_t>& samples);
+    void releaseBrick(uint32_t slot);
+};
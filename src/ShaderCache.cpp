@@ -0,0 +1,214 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    constexpr uint32_t entryMagic = 0x43535652; // "RVSC"
+
+    struct EntryHeader
+    {
+        uint32_t magic;
+        uint32_t size;
+        uint64_t key;
+    };
+
+    // FNV-1a 64
+    void hashBytes(uint64_t& h, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= bytes[i];
+            h *= 0x100000001b3ull;
+        }
+    }
+
+    void hashString(uint64_t& h, const std::string& s)
+    {
+        const uint64_t size = s.size();
+        hashBytes(h, &size, sizeof(size));
+        hashBytes(h, s.data(), s.size());
+    }
+
+    bool readFile(const std::filesystem::path& path, std::string& content)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        content = stream.str();
+        return true;
+    }
+
+    // Quoted includes only, as resolved by D3D_COMPILE_STANDARD_FILE_INCLUDE: relative to the including file.
+    // Includes behind an inactive #if are hashed too, which at worst costs a spurious miss.
+    bool hashIncludes(uint64_t& h, const std::filesystem::path& file, const std::string& source,
+                      std::vector<std::filesystem::path>& visited)
+    {
+        size_t pos = 0;
+        while ((pos = source.find("#include", pos)) != std::string::npos)
+        {
+            pos += 8;
+            const size_t open = source.find_first_of("\"<\n", pos);
+            if (open == std::string::npos || source[open] != '"')
+                continue;
+            const size_t close = source.find('"', open + 1);
+            if (close == std::string::npos)
+                return false;
+
+            const std::filesystem::path included =
+                    (file.parent_path() / source.substr(open + 1, close - open - 1)).lexically_normal();
+            if (std::find(visited.begin(), visited.end(), included) != visited.end())
+                continue;
+            visited.push_back(included);
+
+            std::string content;
+            if (!readFile(included, content))
+                return false;
+            hashString(h, included.filename().string());
+            hashString(h, content);
+            if (!hashIncludes(h, included, content, visited))
+                return false;
+        }
+        return true;
+    }
+
+    uint64_t computeKey(const ShaderDesc& desc, const std::string& source, const std::string& compilerVersion)
+    {
+        uint64_t h = 0xcbf29ce484222325ull;
+        hashString(h, compilerVersion);
+        hashString(h, desc.entryPoint);
+        hashString(h, desc.target);
+        for (const auto& [name, value] : desc.defines)
+        {
+            hashString(h, name);
+            hashString(h, value);
+        }
+        hashString(h, source);
+
+        std::vector<std::filesystem::path> visited{desc.file.lexically_normal()};
+        if (!hashIncludes(h, desc.file, source, visited))
+            return 0;
+        // 0 is kept for "could not hash"
+        return h ? h : 1;
+    }
+}
+
+ShaderCache::ShaderCache(std::filesystem::path directory, ShaderCompiler& compiler)
+        : directory(std::move(directory)), compiler(compiler)
+{
+}
+
+uint64_t ShaderCache::computeKey(const ShaderDesc& desc) const
+{
+    std::string source;
+    if (!readFile(desc.file, source))
+        return 0;
+    return ::computeKey(desc, source, compiler.version());
+}
+
+std::filesystem::path ShaderCache::entryPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key);
+    return directory / name;
+}
+
+bool ShaderCache::load(const ShaderDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors)
+{
+    std::string source;
+    if (!readFile(desc.file, source))
+    {
+        errors = "Shader file not found: " + desc.file.string();
+        return false;
+    }
+
+    const uint64_t key = ::computeKey(desc, source, compiler.version());
+    if (key == 0)
+    {
+        errors = "Missing include in " + desc.file.string();
+        return false;
+    }
+    usedKeys.push_back(key);
+
+    const std::filesystem::path path = entryPath(key);
+    std::string entry;
+    if (readFile(path, entry))
+    {
+        EntryHeader header;
+        if (entry.size() >= sizeof(header))
+            std::memcpy(&header, entry.data(), sizeof(header));
+        if (entry.size() >= sizeof(header) && header.magic == entryMagic && header.key == key &&
+            header.size == entry.size() - sizeof(header))
+        {
+            bytecode.assign(entry.begin() + sizeof(header), entry.end());
+            ++cacheStats.hits;
+            // Last use time for pruneOlderThan
+            std::error_code error;
+            std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+            return true;
+        }
+        ++cacheStats.corrupted;
+    }
+
+    ++cacheStats.misses;
+    if (!compiler.compile(desc, source, bytecode, errors))
+    {
+        ++cacheStats.compileFailures;
+        return false;
+    }
+
+    // Written aside then renamed, so another instance never reads half an entry. A failed write only
+    // costs a compile next time.
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    const std::filesystem::path temporary = path.string() + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        const EntryHeader header = {entryMagic, (uint32_t)bytecode.size(), key};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(bytecode.data()), (std::streamsize)bytecode.size());
+        if (!file)
+            return true;
+    }
+    std::filesystem::rename(temporary, path, error);
+    return true;
+}
+
+uint32_t ShaderCache::pruneOlderThan(std::chrono::hours maxAge)
+{
+    const auto oldest = std::filesystem::file_time_type::clock::now() - maxAge;
+    uint32_t removed = 0;
+    std::error_code error;
+    for (const auto& item : std::filesystem::directory_iterator(directory, error))
+    {
+        if (item.path().extension() != ".cso")
+            continue;
+        const auto lastUse = std::filesystem::last_write_time(item.path(), error);
+        if (!error && lastUse < oldest)
+            removed += std::filesystem::remove(item.path(), error);
+    }
+    return removed;
+}
+
+uint32_t ShaderCache::prune()
+{
+    uint32_t removed = 0;
+    std::error_code error;
+    for (const auto& item : std::filesystem::directory_iterator(directory, error))
+    {
+        if (item.path().extension() != ".cso")
+            continue;
+        const uint64_t key = std::strtoull(item.path().stem().string().c_str(), nullptr, 16);
+        if (std::find(usedKeys.begin(), usedKeys.end(), key) == usedKeys.end())
+            removed += std::filesystem::remove(item.path(), error);
+    }
+    return removed;
+}
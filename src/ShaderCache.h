@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct ShaderDesc
+{
+    std::filesystem::path file;
+    std::string entryPoint = "main";
+    std::string target;
+    // name, value
+    std::vector<std::pair<std::string, std::string>> defines;
+};
+
+// What the cache needs from a shader compiler, D3DCompile on Windows, a stub anywhere else.
+class ShaderCompiler
+{
+public:
+    virtual ~ShaderCompiler() = default;
+
+    // Part of every cache key, bump it when the compiler or its flags change.
+    virtual std::string version() const = 0;
+
+    // source is the content of desc.file, includes are resolved relative to it.
+    virtual bool compile(const ShaderDesc& desc, const std::string& source,
+                         std::vector<uint8_t>& bytecode, std::string& errors) = 0;
+};
+
+// On disk bytecode cache keyed by a hash of the source, of every file it includes (recursively), of the
+// defines, entry point, target and compiler version. A changed input gives another key, so stale entries
+// are never loaded, they are only left behind until pruneOlderThan() or prune().
+class ShaderCache
+{
+public:
+    struct Stats
+    {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        // Entries on disk that could not be read back (truncated, other key), recompiled
+        uint32_t corrupted = 0;
+        uint32_t compileFailures = 0;
+    };
+
+    ShaderCache(std::filesystem::path directory, ShaderCompiler& compiler);
+
+    // Bytecode from the cache, or compiled and stored. False when the source is missing or does not compile,
+    // with the reason in errors.
+    bool load(const ShaderDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors);
+
+    // 0 when a file is missing.
+    uint64_t computeKey(const ShaderDesc& desc) const;
+
+    std::filesystem::path entryPath(uint64_t key) const;
+
+    // Removes the entries that were not loaded nor stored for maxAge, by any instance sharing the directory.
+    // Loading an entry refreshes its time, so other configurations and late loaded shaders survive.
+    uint32_t pruneOlderThan(std::chrono::hours maxAge);
+
+    // Maintenance only: removes the entries that were neither loaded nor stored by this cache, returns how many.
+    // Everything another configuration or a shader not loaded yet uses is lost too.
+    uint32_t prune();
+
+    const Stats& stats() const { return cacheStats; }
+
+private:
+    std::filesystem::path directory;
+    ShaderCompiler& compiler;
+    std::vector<uint64_t> usedKeys;
+    Stats cacheStats;
+};
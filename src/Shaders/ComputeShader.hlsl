@@ -160,7 +160,15 @@ Hit RayIntersectsAABB(Ray ray, float3 boxMin, float3 boxMax)
     return result;
 }
 
-[numthreads(8, 8, 1)]
+// Set by DX12ComputeContext from threadGroupSizeX/Y, which also sizes the dispatch
+#ifndef THREAD_GROUP_SIZE_X
+#define THREAD_GROUP_SIZE_X 8
+#endif
+#ifndef THREAD_GROUP_SIZE_Y
+#define THREAD_GROUP_SIZE_Y 8
+#endif
+
+[numthreads(THREAD_GROUP_SIZE_X, THREAD_GROUP_SIZE_Y, 1)]
 void main(uint3 dt_id : SV_DispatchThreadID, uint3 group_id : SV_GroupID)
 {
     uint2 screen_coord = uint2(dt_id.x, dt_id.y);
@@ -0,0 +1,83 @@
+#include "SimulatedGpuQueue.h"
+
+SimulatedGpuQueue::SimulatedGpuQueue()
+{
+    thread = std::thread([this] { run(); });
+}
+
+SimulatedGpuQueue::~SimulatedGpuQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    workAvailable.notify_one();
+    thread.join();
+}
+
+void SimulatedGpuQueue::submit(std::chrono::microseconds duration)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back({duration, 0});
+    }
+    workAvailable.notify_one();
+}
+
+uint64_t SimulatedGpuQueue::signal()
+{
+    uint64_t value;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        value = ++lastSignaled;
+        items.push_back({std::chrono::microseconds(0), value});
+    }
+    workAvailable.notify_one();
+    return value;
+}
+
+uint64_t SimulatedGpuQueue::completedValue() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return completed;
+}
+
+void SimulatedGpuQueue::waitForValue(uint64_t value)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    fenceAdvanced.wait(lock, [&] { return completed >= value; });
+}
+
+double SimulatedGpuQueue::busySeconds() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return busy;
+}
+
+void SimulatedGpuQueue::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        workAvailable.wait(lock, [&] { return !items.empty() || !running; });
+        if (items.empty())
+            return;
+
+        const Item item = items.front();
+        items.pop_front();
+
+        if (item.fenceValue)
+        {
+            completed = item.fenceValue;
+            fenceAdvanced.notify_all();
+            continue;
+        }
+
+        lock.unlock();
+        const auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(item.duration);
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        lock.lock();
+        busy += elapsed;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "GpuTimeline.h"
+
+// Stand-in for a GPU queue: a thread that runs the submitted work in order, each item taking its
+// duration, and advances the fence when it reaches a signal. Lets frame pacing run without a GPU.
+class SimulatedGpuQueue : public GpuTimeline
+{
+public:
+    SimulatedGpuQueue();
+    ~SimulatedGpuQueue() override;
+
+    SimulatedGpuQueue(const SimulatedGpuQueue&) = delete;
+    SimulatedGpuQueue& operator=(const SimulatedGpuQueue&) = delete;
+
+    void submit(std::chrono::microseconds duration);
+
+    uint64_t signal() override;
+    uint64_t completedValue() const override;
+    void waitForValue(uint64_t value) override;
+
+    // Time spent running work since construction
+    double busySeconds() const;
+
+private:
+    struct Item
+    {
+        std::chrono::microseconds duration;
+        // 0 for work, the fence value to reach for signals
+        uint64_t fenceValue;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable fenceAdvanced;
+    std::deque<Item> items;
+    uint64_t lastSignaled = 0;
+    uint64_t completed = 0;
+    double busy = 0;
+    bool running = true;
+    std::thread thread;
+
+    void run();
+};
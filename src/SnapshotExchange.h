@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest state from one writer thread to one reader thread without locks nor waiting.
+// The writer fills its buffer and publishes it, the reader takes the most recent published one; each side
+// owns a buffer and the third one sits in between, so neither ever waits for the other and a slow reader
+// simply skips the snapshots it was too late for.
+template <typename T>
+class SnapshotExchange
+{
+public:
+    // Writer side
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish()
+    {
+        const uint8_t previous = middle.exchange(uint8_t(writeIndex | freshBit), std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Reader side. Returns false when nothing was published since the previous fetch, readBuffer is unchanged.
+    bool fetch()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit))
+            return false;
+        const uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr uint8_t indexMask = 3;
+    static constexpr uint8_t freshBit = 4;
+
+    T buffers[3]{};
+    uint8_t writeIndex = 0;
+    uint8_t readIndex = 1;
+    alignas(64) std::atomic<uint8_t> middle{2};
+};
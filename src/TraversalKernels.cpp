@@ -0,0 +1,346 @@
+#include "TraversalKernels.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+    using VoxelDataStructs::World;
+    using VoxelDataStructs::Chunk;
+    using VoxelDataStructs::chunkSize;
+
+    constexpr int log2i(int v)
+    {
+        int r = 0;
+        while ((1 << r) < v)
+            ++r;
+        return r;
+    }
+
+    // Moves bit i of v to bit 3 * i
+    constexpr uint32_t spreadBits(uint32_t v, int bits)
+    {
+        uint32_t r = 0;
+        for (int i = 0; i < bits; ++i)
+            r |= ((v >> i) & 1u) << (3 * i);
+        return r;
+    }
+
+    // Cell of a world voxel in the grid, everything known at compile time but the brick counts
+    template <int Dim, VoxelLayout Layout>
+    struct FixedIndexer
+    {
+        static constexpr int shift = log2i(Dim);
+        static_assert((1 << shift) == Dim, "Bricks are a power of two wide");
+
+        static constexpr std::array<uint32_t, Dim> morton = []
+        {
+            std::array<uint32_t, Dim> table{};
+            for (int i = 0; i < Dim; ++i)
+                table[i] = spreadBits(uint32_t(i), shift);
+            return table;
+        }();
+
+        int32_t bricksX;
+        int32_t bricksXY;
+
+        explicit FixedIndexer(const OccupancyGrid& grid)
+                : bricksX(grid.brickCount[0]), bricksXY(grid.brickCount[0] * grid.brickCount[1])
+        {
+        }
+
+        static uint32_t local(int32_t x, int32_t y, int32_t z)
+        {
+            if constexpr (Layout == VoxelLayout::Morton)
+                return morton[x] | morton[y] << 1 | morton[z] << 2;
+            else
+                return uint32_t(x + Dim * (y + Dim * z));
+        }
+
+        uint32_t operator()(int32_t x, int32_t y, int32_t z) const
+        {
+            const uint32_t brick = uint32_t((x >> shift) + bricksX * (y >> shift) + bricksXY * (z >> shift));
+            return brick << (3 * shift) | local(x & (Dim - 1), y & (Dim - 1), z & (Dim - 1));
+        }
+    };
+
+    // Same mapping with the brick size and layout read from the grid
+    struct RuntimeIndexer
+    {
+        int32_t dim;
+        int bits;
+        VoxelLayout layout;
+        int32_t bricksX;
+        int32_t bricksXY;
+
+        explicit RuntimeIndexer(const OccupancyGrid& grid)
+                : dim(grid.chunkDim), bits(log2i(grid.chunkDim)), layout(grid.layout),
+                  bricksX(grid.brickCount[0]), bricksXY(grid.brickCount[0] * grid.brickCount[1])
+        {
+        }
+
+        uint32_t local(int32_t x, int32_t y, int32_t z) const
+        {
+            if (layout == VoxelLayout::Morton)
+                return spreadBits(uint32_t(x), bits) | spreadBits(uint32_t(y), bits) << 1 | spreadBits(uint32_t(z), bits) << 2;
+            return uint32_t(x + dim * (y + dim * z));
+        }
+
+        uint32_t operator()(int32_t x, int32_t y, int32_t z) const
+        {
+            const uint32_t brick = uint32_t(x / dim + bricksX * (y / dim) + bricksXY * (z / dim));
+            return brick * uint32_t(dim * dim * dim) + local(x % dim, y % dim, z % dim);
+        }
+    };
+
+    void prepareGrid(const World& world, int32_t chunkDim, VoxelLayout layout, OccupancyGrid& grid)
+    {
+        assert(chunkDim > 0 && chunkSize % chunkDim == 0 && (chunkDim & (chunkDim - 1)) == 0);
+        grid.chunkDim = chunkDim;
+        grid.layout = layout;
+        for (int a = 0; a < 3; ++a)
+        {
+            grid.size[a] = world.sizeInVoxels(a);
+            grid.brickCount[a] = grid.size[a] / chunkDim;
+        }
+        grid.cells.assign(size_t(grid.size[0]) * grid.size[1] * grid.size[2], 0);
+        grid.revision = world.revision;
+    }
+
+    // One job per world chunk, a brick never straddles two of them so jobs write disjoint cells
+    template <class Indexer>
+    void fillGrid(const World& world, OccupancyGrid& grid, JobSystem* jobSystem)
+    {
+        const Indexer index(grid);
+        uint8_t* cells = grid.cells.data();
+
+        JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::get();
+        jobs.parallelFor((uint32_t)world.chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t c = begin; c < end; ++c)
+            {
+                const Chunk& chunk = world.chunks[c];
+                if (chunk.solidCount == 0)
+                    continue;
+                const uint32_t* voxels = chunk.voxels.data();
+                for (int32_t z = 0; z < chunkSize; ++z)
+                    for (int32_t y = 0; y < chunkSize; ++y)
+                        for (int32_t x = 0; x < chunkSize; ++x)
+                            cells[index(chunk.offsetPos[0] + x, chunk.offsetPos[1] + y, chunk.offsetPos[2] + z)] =
+                                    voxels[Chunk::index(x, y, z)] != 0;
+            }
+        });
+    }
+
+    template <int Dim, VoxelLayout Layout>
+    void buildFixed(const World& world, int32_t chunkDim, VoxelLayout layout, OccupancyGrid& grid, JobSystem* jobSystem)
+    {
+        assert(chunkDim == Dim && layout == Layout && "Kernel built with another configuration");
+        (void)chunkDim;
+        (void)layout;
+        prepareGrid(world, Dim, Layout, grid);
+        fillGrid<FixedIndexer<Dim, Layout>>(world, grid, jobSystem);
+    }
+
+    void buildGeneric(const World& world, int32_t chunkDim, VoxelLayout layout, OccupancyGrid& grid, JobSystem* jobSystem)
+    {
+        prepareGrid(world, chunkDim, layout, grid);
+        fillGrid<RuntimeIndexer>(world, grid, jobSystem);
+    }
+
+    // DDA state of one ray, same setup and stepping as CPURaytracer::traverse so the results match it
+    struct Lane
+    {
+        float3 dir;
+        int3 cell;
+        int3 step;
+        float3 tNext;
+        float3 tDelta;
+        float t;
+        float tExit;
+        int lastAxis;
+    };
+
+    bool setupLane(const Ray& ray, float tMin, float tMax, const int32_t size[3], Lane& lane)
+    {
+        float3 dir = ray.direction;
+        for (int a = 0; a < 3; ++a)
+        {
+            if (std::fabs(dir[a]) < 1e-8f)
+                dir[a] = std::copysign(1e-8f, dir[a]);
+        }
+        const float3 invDir = float3(1, 1, 1) / dir;
+        const float3 gridMax((float)size[0], (float)size[1], (float)size[2]);
+
+        const float3 t0s = (float3(0, 0, 0) - ray.origin) * invDir;
+        const float3 t1s = (gridMax - ray.origin) * invDir;
+        const float3 tsmaller = min(t0s, t1s);
+        const float3 tbigger = max(t0s, t1s);
+
+        lane.lastAxis = -1;
+        float tEnter = tMin;
+        for (int a = 0; a < 3; ++a)
+        {
+            if (tsmaller[a] > tEnter)
+            {
+                tEnter = tsmaller[a];
+                lane.lastAxis = a;
+            }
+        }
+        lane.tExit = std::min(tMax, std::min(tbigger.x, std::min(tbigger.y, tbigger.z)));
+        if (tEnter > lane.tExit)
+            return false;
+
+        const float3 p = ray.origin + ray.direction * tEnter;
+        for (int a = 0; a < 3; ++a)
+        {
+            lane.cell[a] = std::clamp((int32_t)std::floor(p[a]), 0, size[a] - 1);
+            lane.step[a] = dir[a] > 0 ? 1 : -1;
+            lane.tDelta[a] = std::fabs(invDir[a]);
+            lane.tNext[a] = ((float)lane.cell[a] + (lane.step[a] > 0 ? 1.0f : 0.0f) - ray.origin[a]) * invDir[a];
+        }
+        lane.dir = dir;
+        lane.t = tEnter;
+        return true;
+    }
+
+    // Visits one cell, returns false once the lane is done
+    template <class Indexer>
+    bool stepLane(Lane& lane, const Indexer& index, const uint8_t* cells, const int32_t size[3], const Ray& ray, Hit& hit)
+    {
+        if (lane.t > lane.tExit)
+            return false;
+        ++hit.steps;
+
+        if (cells[index(lane.cell.x, lane.cell.y, lane.cell.z)])
+        {
+            hit.hit = true;
+            hit.distance = lane.t;
+            hit.hitPoint = ray.origin + ray.direction * lane.t;
+            hit.voxel = lane.cell;
+
+            int axis = lane.lastAxis;
+            if (axis < 0)
+            {
+                const float3 ad = abs(lane.dir);
+                axis = ad.x > ad.y ? (ad.x > ad.z ? 0 : 2) : (ad.y > ad.z ? 1 : 2);
+            }
+            hit.normal[axis] = (float)-lane.step[axis];
+            return false;
+        }
+
+        const int a = lane.tNext.x < lane.tNext.y ? (lane.tNext.x < lane.tNext.z ? 0 : 2) : (lane.tNext.y < lane.tNext.z ? 1 : 2);
+        lane.t = lane.tNext[a];
+        lane.cell[a] += lane.step[a];
+        lane.tNext[a] += lane.tDelta[a];
+        lane.lastAxis = a;
+        return lane.cell[a] >= 0 && lane.cell[a] < size[a];
+    }
+
+    // Width rays step in lockstep, a lane that is done idles until the whole packet is
+    template <class Indexer, int Width>
+    uint64_t tracePackets(const OccupancyGrid& grid, std::span<const Ray> rays, float tMin, float tMax, std::span<Hit> hits)
+    {
+        const Indexer index(grid);
+        const uint8_t* cells = grid.cells.data();
+        uint64_t steps = 0;
+
+        for (size_t first = 0; first < rays.size(); first += Width)
+        {
+            const size_t laneCount = std::min<size_t>(Width, rays.size() - first);
+            Lane lanes[Width];
+            Hit packetHits[Width];
+            bool active[Width];
+            bool anyActive = false;
+            for (int l = 0; l < Width; ++l)
+            {
+                active[l] = size_t(l) < laneCount && setupLane(rays[first + l], tMin, tMax, grid.size, lanes[l]);
+                anyActive |= active[l];
+            }
+
+            while (anyActive)
+            {
+                anyActive = false;
+                for (int l = 0; l < Width; ++l)
+                {
+                    if (active[l])
+                        active[l] = stepLane(lanes[l], index, cells, grid.size, rays[first + l], packetHits[l]);
+                    anyActive |= active[l];
+                }
+            }
+
+            for (size_t l = 0; l < laneCount; ++l)
+            {
+                steps += packetHits[l].steps;
+                hits[first + l] = packetHits[l];
+            }
+        }
+        return steps;
+    }
+
+    template <int Dim, VoxelLayout Layout, int Width>
+    constexpr TraversalKernel makeKernel(const char* name)
+    {
+        return {{Dim, Layout, uint32_t(Width)}, name, false,
+                &buildFixed<Dim, Layout>, &tracePackets<FixedIndexer<Dim, Layout>, Width>};
+    }
+
+    constexpr VoxelLayout Linear = VoxelLayout::Linear;
+    constexpr VoxelLayout Morton = VoxelLayout::Morton;
+
+    const TraversalKernel kernels[] = {
+        makeKernel<16, Linear, 1>("d16.linear.x1"),
+        makeKernel<16, Linear, 4>("d16.linear.x4"),
+        makeKernel<16, Linear, 8>("d16.linear.x8"),
+        makeKernel<16, Morton, 1>("d16.morton.x1"),
+        makeKernel<16, Morton, 4>("d16.morton.x4"),
+        makeKernel<16, Morton, 8>("d16.morton.x8"),
+        makeKernel<32, Linear, 1>("d32.linear.x1"),
+        makeKernel<32, Linear, 4>("d32.linear.x4"),
+        makeKernel<32, Linear, 8>("d32.linear.x8"),
+        makeKernel<32, Morton, 1>("d32.morton.x1"),
+        makeKernel<32, Morton, 4>("d32.morton.x4"),
+        makeKernel<32, Morton, 8>("d32.morton.x8"),
+        makeKernel<64, Linear, 1>("d64.linear.x1"),
+        makeKernel<64, Linear, 4>("d64.linear.x4"),
+        makeKernel<64, Linear, 8>("d64.linear.x8"),
+        makeKernel<64, Morton, 1>("d64.morton.x1"),
+        makeKernel<64, Morton, 4>("d64.morton.x4"),
+        makeKernel<64, Morton, 8>("d64.morton.x8"),
+    };
+
+    const TraversalKernel genericKernel = {{0, Linear, 1}, "generic", true, &buildGeneric, &tracePackets<RuntimeIndexer, 1>};
+}
+
+namespace TraversalKernels
+{
+    std::span<const TraversalKernel> registry()
+    {
+        return kernels;
+    }
+
+    const TraversalKernel* find(const KernelConfig& config)
+    {
+        for (const TraversalKernel& kernel : kernels)
+        {
+            if (kernel.config.chunkDim == config.chunkDim && kernel.config.layout == config.layout &&
+                kernel.config.packetWidth == config.packetWidth)
+                return &kernel;
+        }
+        return nullptr;
+    }
+
+    const TraversalKernel& generic()
+    {
+        return genericKernel;
+    }
+
+    const TraversalKernel& select(const KernelConfig& config)
+    {
+        const TraversalKernel* kernel = find(config);
+        return kernel ? *kernel : genericKernel;
+    }
+}
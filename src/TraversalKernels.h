@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "CPURaytracer.h"
+#include "MemoryTracker.h"
+
+class JobSystem;
+
+// Order of the voxels inside a brick. Morton keeps the 8 neighbours of a 2^3 block on one cache line.
+enum class VoxelLayout : uint8_t
+{
+    Linear,
+    Morton
+};
+
+// Occupancy of the world repacked in cubic bricks of chunkDim^3 bytes, 1 for a solid voxel.
+// Bricks are stored one after the other in x, y, z order; chunkDim must divide VoxelDataStructs::chunkSize.
+struct OccupancyGrid
+{
+    int32_t chunkDim = 0;
+    VoxelLayout layout = VoxelLayout::Linear;
+    int32_t brickCount[3] = {0, 0, 0};
+    int32_t size[3] = {0, 0, 0};
+    TrackedVector<uint8_t, MemoryTag::Trees> cells;
+    // World revision the grid was built from
+    uint64_t revision = 0;
+};
+
+struct KernelConfig
+{
+    int32_t chunkDim;
+    VoxelLayout layout;
+    // Rays traversed together, lane by lane in lockstep
+    uint32_t packetWidth;
+};
+
+// Build and closest hit traversal of one OccupancyGrid configuration. The specialised instances are
+// compiled with the brick size, layout and packet width as template parameters: index math is shifts,
+// masks and constant tables, and the per lane loops unroll. The generic one takes them at runtime.
+struct TraversalKernel
+{
+    KernelConfig config;
+    const char* name;
+    bool generic;
+
+    void (*build)(const VoxelDataStructs::World& world, int32_t chunkDim, VoxelLayout layout,
+                  OccupancyGrid& grid, JobSystem* jobSystem);
+
+    // Closest hit of every ray in [tMin, tMax], same cells and distances as CPURaytracer::traceClosest,
+    // without color. Single threaded, returns the total number of visited cells.
+    uint64_t (*trace)(const OccupancyGrid& grid, std::span<const Ray> rays, float tMin, float tMax, std::span<Hit> hits);
+};
+
+namespace TraversalKernels
+{
+    // Every specialised instance, chunk sizes 16, 32 and 64, both layouts, packets of 1, 4 and 8 rays.
+    std::span<const TraversalKernel> registry();
+
+    // nullptr when that configuration was not instantiated.
+    const TraversalKernel* find(const KernelConfig& config);
+
+    // Runtime sized kernel, packets of 1 ray: handles any configuration, for comparison and as a fallback.
+    const TraversalKernel& generic();
+
+    // Specialised kernel when there is one, the generic kernel otherwise.
+    const TraversalKernel& select(const KernelConfig& config);
+}
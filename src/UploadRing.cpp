@@ -0,0 +1,82 @@
+#include "UploadRing.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+UploadRing::UploadRing(uint8_t* base, uint64_t capacity, GpuTimeline& timeline)
+        : base(base), capacity(capacity), timeline(timeline)
+{
+}
+
+UploadRing::Allocation UploadRing::allocate(uint64_t size, uint64_t alignment)
+{
+    assert(capacity % alignment == 0 && "The ring capacity must be a multiple of the alignment");
+    if (size == 0 || size > capacity)
+    {
+        ++ringStats.failures;
+        return {};
+    }
+
+    bool stalled = false;
+    while (true)
+    {
+        uint64_t start = alignUp(head, alignment);
+        // Does not fit before the end of the buffer, continue at the start of the next lap
+        if (start % capacity + size > capacity)
+            start = alignUp(start, capacity);
+
+        if (start + size - tail <= capacity)
+        {
+            ringStats.wastedBytes += start - head;
+            head = start + size;
+
+            ++ringStats.allocations;
+            ringStats.allocatedBytes += size;
+            ringStats.stalls += stalled;
+            ringStats.peakUsedBytes = std::max(ringStats.peakUsedBytes, usedBytes());
+            return {base + start % capacity, start % capacity, size};
+        }
+
+        reclaim();
+        if (start + size - tail <= capacity)
+            continue;
+
+        // Still full: wait for the oldest frame, unless the space is held by the frame being recorded
+        if (pending.empty())
+        {
+            ++ringStats.failures;
+            return {};
+        }
+        timeline.waitForValue(pending.front().fenceValue);
+        stalled = true;
+    }
+}
+
+void UploadRing::finishFrame(uint64_t fenceValue)
+{
+    if (head != frameStart)
+        pending.push_back({fenceValue, head});
+    frameStart = head;
+    reclaim();
+}
+
+void UploadRing::reclaim()
+{
+    const uint64_t completed = timeline.completedValue();
+    while (!pending.empty() && pending.front().fenceValue <= completed)
+    {
+        tail = pending.front().end;
+        pending.pop_front();
+    }
+    // Nothing left in flight nor being recorded, restart from the beginning of a lap
+    if (tail == head && pending.empty())
+        tail = head = frameStart = alignUp(head, capacity);
+}
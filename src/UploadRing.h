@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "GpuTimeline.h"
+
+// Linear ring allocator over one persistently mapped upload buffer. Allocations are handed out
+// back to back and wrap around; every allocation made before finishFrame(fence) is given back
+// once the timeline reaches that fence. The memory is only a pointer and a size so the logic runs
+// on any buffer, mapped DX12 heap or plain CPU memory.
+class UploadRing
+{
+public:
+    // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+    static constexpr uint64_t constantBufferAlignment = 256;
+
+    struct Allocation
+    {
+        uint8_t* cpuAddress = nullptr;
+        // From the start of the buffer, add it to the buffer GPU address
+        uint64_t offset = 0;
+        uint64_t size = 0;
+
+        explicit operator bool() const { return cpuAddress != nullptr; }
+    };
+
+    struct Stats
+    {
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        // Bytes skipped at the end of the buffer when an allocation did not fit before wrapping
+        uint64_t wastedBytes = 0;
+        // Allocations that had to wait for the GPU, and those that could not fit at all
+        uint64_t stalls = 0;
+        uint64_t failures = 0;
+        uint64_t peakUsedBytes = 0;
+    };
+
+    // capacity must be a multiple of every alignment asked for.
+    UploadRing(uint8_t* base, uint64_t capacity, GpuTimeline& timeline);
+
+    // Returns an empty allocation when size does not fit even with the GPU idle.
+    Allocation allocate(uint64_t size, uint64_t alignment = constantBufferAlignment);
+
+    template <typename T>
+    Allocation upload(const T& data, uint64_t alignment = constantBufferAlignment)
+    {
+        Allocation allocation = allocate(sizeof(T), alignment);
+        if (allocation)
+            *reinterpret_cast<T*>(allocation.cpuAddress) = data;
+        return allocation;
+    }
+
+    // Every allocation since the previous call is in use by the GPU until the timeline reaches fenceValue.
+    void finishFrame(uint64_t fenceValue);
+
+    // Gives back the space of the frames the GPU is done with. Also done by finishFrame and by allocate when the ring is full.
+    void reclaim();
+
+    uint64_t usedBytes() const { return head - tail; }
+    uint64_t capacityBytes() const { return capacity; }
+    const Stats& stats() const { return ringStats; }
+
+private:
+    struct PendingFrame
+    {
+        uint64_t fenceValue;
+        uint64_t end;
+    };
+
+    uint8_t* base;
+    uint64_t capacity;
+    GpuTimeline& timeline;
+
+    // Monotonic byte positions, the physical offset is position % capacity
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    uint64_t frameStart = 0;
+    std::deque<PendingFrame> pending;
+
+    Stats ringStats;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// Small HLSL-like vector types used by the CPU kernels, so they can be ported
+// from the shaders almost line for line and built without DirectXMath.
+
+struct float3
+{
+    float x = 0, y = 0, z = 0;
+
+    float3() = default;
+    constexpr float3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+    float& operator[](int i) { return (&x)[i]; }
+    float operator[](int i) const { return (&x)[i]; }
+
+    float3 operator-() const { return {-x, -y, -z}; }
+    float3& operator+=(const float3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+    float3& operator-=(const float3& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+    float3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+};
+
+struct int3
+{
+    int32_t x = 0, y = 0, z = 0;
+
+    int32_t& operator[](int i) { return (&x)[i]; }
+    int32_t operator[](int i) const { return (&x)[i]; }
+
+    bool operator==(const int3& o) const { return x == o.x && y == o.y && z == o.z; }
+    bool operator!=(const int3& o) const { return !(*this == o); }
+};
+
+inline float3 operator+(const float3& a, const float3& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline float3 operator-(const float3& a, const float3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline float3 operator*(const float3& a, const float3& b) { return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+inline float3 operator*(const float3& a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+inline float3 operator*(float s, const float3& a) { return a * s; }
+inline float3 operator/(const float3& a, const float3& b) { return {a.x / b.x, a.y / b.y, a.z / b.z}; }
+inline float3 operator/(const float3& a, float s) { return a * (1.0f / s); }
+
+inline float dot(const float3& a, const float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline float3 cross(const float3& a, const float3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline float length(const float3& v) { return std::sqrt(dot(v, v)); }
+inline float3 normalize(const float3& v) { return v / length(v); }
+
+inline float3 abs(const float3& v) { return {std::fabs(v.x), std::fabs(v.y), std::fabs(v.z)}; }
+inline float3 min(const float3& a, const float3& b) { return {std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)}; }
+inline float3 max(const float3& a, const float3& b) { return {std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)}; }
+inline float3 floor(const float3& v) { return {std::floor(v.x), std::floor(v.y), std::floor(v.z)}; }
+
+inline float radians(float degrees) { return degrees * 0.017453292f; }
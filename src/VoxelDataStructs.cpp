@@ -1,4 +1,9 @@
+
 #include "VoxelDataStructs.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <cmath>
 #include <random>
 
 namespace VoxelDataStructs
@@ -15,7 +20,65 @@ namespace VoxelDataStructs
         }
     }
 
-    static std::vector<Voxel> generateChunk_debug()
+    void Chunk::set(int32_t x, int32_t y, int32_t z, uint32_t color)
+    {
+        if (voxels.empty())
+        {
+            if (color == 0)
+                return;
+            voxels.assign(chunkSize * chunkSize * chunkSize, 0);
+        }
+
+        uint32_t& v = voxels[index(x, y, z)];
+        solidCount += (color != 0) - (v != 0);
+        v = color;
+    }
+
+    void World::init(int32_t countX, int32_t countY, int32_t countZ)
+    {
+        chunkCount[0] = countX;
+        chunkCount[1] = countY;
+        chunkCount[2] = countZ;
+
+        chunks.clear();
+        chunks.resize(size_t(countX) * countY * countZ);
+
+        for(int32_t cz = 0; cz < countZ; ++cz)
+        {
+            for(int32_t cy = 0; cy < countY; ++cy)
+            {
+                for(int32_t cx = 0; cx < countX; ++cx)
+                {
+                    Chunk& chunk = chunkAt(cx, cy, cz);
+                    chunk.offsetPos[0] = cx * chunkSize;
+                    chunk.offsetPos[1] = cy * chunkSize;
+                    chunk.offsetPos[2] = cz * chunkSize;
+                }
+            }
+        }
+        ++revision;
+    }
+
+    void World::setVoxel(int32_t x, int32_t y, int32_t z, uint32_t color)
+    {
+        if (!contains(x, y, z))
+            return;
+        chunkAt(x / chunkSize, y / chunkSize, z / chunkSize).set(x % chunkSize, y % chunkSize, z % chunkSize, color);
+        ++revision;
+    }
+
+    void World::insertChunk(int32_t cx, int32_t cy, int32_t cz, const std::vector<Voxel>& voxelList)
+    {
+        Chunk& chunk = chunkAt(cx, cy, cz);
+        for(const Voxel& v : voxelList)
+        {
+            // Alpha is forced to opaque so that a stored 0 always means an empty cell
+            chunk.set(v.pos[0], v.pos[1], v.pos[2], v.color | 0xFF000000u);
+        }
+        ++revision;
+    }
+
+    std::vector<Voxel> generateChunk_debug()
     {
         std::vector<Voxel> list;
 
@@ -36,4 +99,76 @@ namespace VoxelDataStructs
 
         return list;
     }
+
+    namespace
+    {
+        float hashToUnit(int32_t x, int32_t z, uint32_t seed)
+        {
+            uint32_t h = uint32_t(x) * 0x8da6b343u ^ uint32_t(z) * 0xd8163841u ^ seed * 0xcb1ab31fu;
+            h ^= h >> 13;
+            h *= 0x5bd1e995u;
+            h ^= h >> 15;
+            return float(h & 0xFFFFFF) / float(0xFFFFFF);
+        }
+
+        float valueNoise(float x, float z, uint32_t seed)
+        {
+            const int32_t ix = (int32_t)std::floor(x);
+            const int32_t iz = (int32_t)std::floor(z);
+            float fx = x - (float)ix;
+            float fz = z - (float)iz;
+            fx = fx * fx * (3.0f - 2.0f * fx);
+            fz = fz * fz * (3.0f - 2.0f * fz);
+
+            const float a = hashToUnit(ix, iz, seed);
+            const float b = hashToUnit(ix + 1, iz, seed);
+            const float c = hashToUnit(ix, iz + 1, seed);
+            const float d = hashToUnit(ix + 1, iz + 1, seed);
+            return (a + (b - a) * fx) + ((c + (d - c) * fx) - (a + (b - a) * fx)) * fz;
+        }
+
+        uint32_t terrainColor(int32_t y, int32_t height)
+        {
+            if (y == height - 1)
+                return 0xFF3CA03Cu; // grass
+            if (y > height - 5)
+                return 0xFF285A8Cu; // dirt
+            return 0xFF787878u;     // stone
+        }
+    }
+
+    void generateTerrain(World& world, uint32_t seed, JobSystem* jobSystem)
+    {
+        RAYVOX_ZONE("generateTerrain");
+        const float maxHeight = (float)world.sizeInVoxels(1) * 0.75f;
+        const uint32_t chunkCount = (uint32_t)world.chunks.size();
+
+        JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::get();
+        jobs.parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t c = begin; c < end; ++c)
+            {
+                RAYVOX_ZONE("generate chunk");
+                Chunk& chunk = world.chunks[c];
+                for(int32_t z = 0; z < chunkSize; ++z)
+                {
+                    for(int32_t x = 0; x < chunkSize; ++x)
+                    {
+                        const float wx = float(chunk.offsetPos[0] + x);
+                        const float wz = float(chunk.offsetPos[2] + z);
+                        const float n = 0.6f * valueNoise(wx / 48.0f, wz / 48.0f, seed) +
+                                        0.3f * valueNoise(wx / 16.0f, wz / 16.0f, seed + 1) +
+                                        0.1f * valueNoise(wx / 4.0f, wz / 4.0f, seed + 2);
+                        const int32_t height = std::max(1, (int32_t)(n * maxHeight));
+
+                        const int32_t yEnd = std::min(chunkSize, height - chunk.offsetPos[1]);
+                        for(int32_t y = 0; y < yEnd; ++y)
+                            chunk.set(x, y, z, terrainColor(chunk.offsetPos[1] + y, height));
+                    }
+                }
+            }
+        });
+
+        ++world.revision;
+    }
 }
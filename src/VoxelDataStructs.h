@@ -1,10 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
+#include "MemoryTracker.h"
+
+class JobSystem;
+
 namespace VoxelDataStructs
 {
+    inline constexpr int32_t chunkSize = 64;
+
     struct Voxel
     {
         int32_t pos[3];
@@ -31,8 +38,87 @@ namespace VoxelDataStructs
     {
         int offsetPos[3];
         SVO SVO64_3;
+
+        // Dense chunkSize^3 grid of RGBA8 colors, 0 means empty.
+        // Index is x + chunkSize * (y + chunkSize * z), in chunk local coordinates.
+        TrackedVector<uint32_t, MemoryTag::Voxels> voxels;
+        uint32_t solidCount = 0;
+
+        static uint32_t index(int32_t x, int32_t y, int32_t z)
+        {
+            return uint32_t(x + chunkSize * (y + chunkSize * z));
+        }
+
+        uint32_t at(int32_t x, int32_t y, int32_t z) const
+        {
+            return voxels.empty() ? 0 : voxels[index(x, y, z)];
+        }
+
+        void set(int32_t x, int32_t y, int32_t z, uint32_t color);
     };
 
-    static std::vector<Voxel> generateChunk_debug();
-}
+    // Fixed size grid of chunks, origin at (0,0,0) in voxel units.
+    struct World
+    {
+        int32_t chunkCount[3] = {0, 0, 0};
+        TrackedVector<Chunk, MemoryTag::Voxels> chunks;
+
+        // Bumped on every edit, lets caches built from the world (render history, ...) invalidate themselves.
+        uint64_t revision = 0;
+
+        void init(int32_t countX, int32_t countY, int32_t countZ);
+
+        int32_t sizeInVoxels(int axis) const { return chunkCount[axis] * chunkSize; }
 
+        bool contains(int32_t x, int32_t y, int32_t z) const
+        {
+            return x >= 0 && y >= 0 && z >= 0 &&
+                   x < sizeInVoxels(0) && y < sizeInVoxels(1) && z < sizeInVoxels(2);
+        }
+
+        Chunk& chunkAt(int32_t cx, int32_t cy, int32_t cz)
+        {
+            return chunks[cx + chunkCount[0] * (cy + chunkCount[1] * cz)];
+        }
+
+        const Chunk& chunkAt(int32_t cx, int32_t cy, int32_t cz) const
+        {
+            return chunks[cx + chunkCount[0] * (cy + chunkCount[1] * cz)];
+        }
+
+        // World voxel coordinates, returns 0 outside of the world.
+        uint32_t voxelAt(int32_t x, int32_t y, int32_t z) const
+        {
+            if (!contains(x, y, z))
+                return 0;
+            const Chunk& chunk = chunkAt(x / chunkSize, y / chunkSize, z / chunkSize);
+            return chunk.at(x % chunkSize, y % chunkSize, z % chunkSize);
+        }
+
+        // Packs world voxel coordinates into a single id, unique inside the world bounds.
+        uint32_t voxelId(int32_t x, int32_t y, int32_t z) const
+        {
+            return uint32_t(x + sizeInVoxels(0) * (y + sizeInVoxels(1) * z));
+        }
+
+        // Voxel storage of the allocated chunks.
+        size_t memoryBytes() const
+        {
+            size_t bytes = chunks.capacity() * sizeof(Chunk);
+            for(const Chunk& chunk : chunks)
+                bytes += chunk.voxels.capacity() * sizeof(uint32_t);
+            return bytes;
+        }
+
+        void setVoxel(int32_t x, int32_t y, int32_t z, uint32_t color);
+
+        // Voxel positions are relative to the chunk (cx, cy, cz).
+        void insertChunk(int32_t cx, int32_t cy, int32_t cz, const std::vector<Voxel>& voxelList);
+    };
+
+    std::vector<Voxel> generateChunk_debug();
+
+    // Fills every chunk of an initialised world with a value noise heightmap, one job per chunk.
+    // Deterministic for a given seed. nullptr uses JobSystem::get().
+    void generateTerrain(World& world, uint32_t seed, JobSystem* jobSystem = nullptr);
+}
@@ -15,21 +15,20 @@ int CALLBACK wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdL
 
     RedirectIOToConsole();
 
+    ParseCommandLine();
     InitApp(hInstance);
 
     MSG msg = {};
 
-    while (msg.message != WM_QUIT)
+    // Simulation and rendering have their own threads, this one sleeps until a message comes in
+    while (::GetMessage(&msg, NULL, 0, 0) > 0)
     {
-
-        if (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-        {
-            ::TranslateMessage(&msg);
-            ::DispatchMessage(&msg);
-        }
+        ::TranslateMessage(&msg);
+        ::DispatchMessage(&msg);
     }
 
-    dx_cctx.flush();
+    ShutdownApp();
+    renderBackend->flush();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "Test.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "DeltaPacker.h"
+
+using namespace VoxelDataStructs;
+
+namespace
+{
+    // The GPU side of the copies: scatters the staged payload in a CPU copy of the mirror buffer
+    void applyCopies(std::vector<uint8_t>& mirror, const UploadRing::Allocation& staging,
+                     const std::vector<DeltaPacker::CopyRange>& copies)
+    {
+        for(const DeltaPacker::CopyRange& copy : copies)
+            std::memcpy(mirror.data() + copy.dstOffset, staging.cpuAddress + copy.srcOffset, copy.size);
+    }
+
+    bool mirrorMatches(const World& world, const std::vector<uint8_t>& mirror)
+    {
+        for(uint32_t c = 0; c < world.chunks.size(); ++c)
+        {
+            const Chunk& chunk = world.chunks[c];
+            const uint8_t* gpu = mirror.data() + DeltaPacker::gpuOffset(c, 0);
+            if (chunk.voxels.empty())
+            {
+                for(uint64_t i = 0; i < DeltaPacker::chunkBytes; ++i)
+                    if (gpu[i] != 0)
+                        return false;
+            }
+            else if (std::memcmp(gpu, chunk.voxels.data(), DeltaPacker::chunkBytes) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void Test::runDelta()
+{
+    World world;
+    world.init(2, 1, 1);
+    std::vector<uint8_t> mirror(world.chunks.size() * DeltaPacker::chunkBytes);
+
+    std::vector<uint8_t> stagingMemory(4 * 1024 * 1024);
+    ManualTimeline timeline;
+    UploadRing staging(stagingMemory.data(), stagingMemory.size(), timeline);
+    DeltaPacker packer;
+    std::vector<DeltaPacker::CopyRange> copies;
+
+    auto frame = [&]()
+    {
+        const UploadRing::Allocation allocation = packer.pack(world, staging, copies);
+        applyCopies(mirror, allocation, copies);
+        staging.finishFrame(timeline.signal());
+        timeline.complete(timeline.signaled);
+        return allocation;
+    };
+
+    TEST_CHECK("nothing marked packs nothing", !frame() && copies.empty());
+
+    packer.markVoxel(world, -1, 0, 0);
+    packer.markVoxel(world, 0, chunkSize, 0);
+    TEST_CHECK("voxels outside of the world are ignored", !packer.hasDirtyRanges());
+
+    // Two edits a few voxels apart along x share a copy, one in the other chunk gets its own
+    world.setVoxel(3, 5, 7, 0xFF0000FFu);
+    world.setVoxel(9, 5, 7, 0xFF00FF00u);
+    world.setVoxel(chunkSize + 1, 5, 7, 0xFFFF0000u);
+    packer.markVoxel(world, 3, 5, 7);
+    packer.markVoxel(world, 9, 5, 7);
+    packer.markVoxel(world, chunkSize + 1, 5, 7);
+    frame();
+    const DeltaPacker::FrameStats& stats = packer.lastFrame();
+    TEST_CHECK("close ranges of a chunk coalesce", stats.markedRanges == 3 && copies.size() == 2);
+    TEST_CHECK("the first copy spans both close edits", copies[0].dstOffset == DeltaPacker::gpuOffset(0, Chunk::index(3, 5, 7)) &&
+               copies[0].size == 7 * sizeof(uint32_t));
+    TEST_CHECK("copies target their chunk in the mirror", copies[1].dstOffset == DeltaPacker::gpuOffset(1, Chunk::index(1, 5, 7)));
+    TEST_CHECK("payload is the coalesced ranges only", stats.payloadBytes == 8 * sizeof(uint32_t));
+    TEST_CHECK("chunk re-upload cost counts each touched chunk once", stats.chunkUploadBytes == 2 * DeltaPacker::chunkBytes);
+    TEST_CHECK("the mirror matches the world after the edits", mirrorMatches(world, mirror));
+    TEST_CHECK("packed ranges are no longer dirty", !packer.hasDirtyRanges());
+
+    // The budget spreads a whole world upload over frames, splitting the range that crosses it
+    packer.maxFrameBytes = DeltaPacker::chunkBytes * 3 / 4;
+    std::fill(mirror.begin(), mirror.end(), 0xCD);
+    packer.markChunk(0);
+    packer.markChunk(1);
+    frame();
+    TEST_CHECK("the budget caps a frame", packer.lastFrame().payloadBytes == packer.maxFrameBytes);
+    TEST_CHECK("what does not fit is deferred", packer.hasDirtyRanges() && packer.lastFrame().deferredRanges == 2);
+    uint32_t frames = 1;
+    while (packer.hasDirtyRanges() && frames < 10)
+    {
+        frame();
+        ++frames;
+    }
+    TEST_CHECK("two chunks take three frames at 3/4 of a chunk each", frames == 3);
+    TEST_CHECK("the mirror matches the world after a split upload", mirrorMatches(world, mirror));
+
+    // A payload larger than the ring cannot be staged, every range stays dirty
+    packer.maxFrameBytes = stagingMemory.size() * 2;
+    for(uint32_t c = 0; c < 2; ++c)
+        packer.markChunk(c);
+    std::vector<uint8_t> smallMemory(1024 * 1024);
+    UploadRing small(smallMemory.data(), smallMemory.size(), timeline);
+    TEST_CHECK("a payload bigger than the ring fails", !packer.pack(world, small, copies) && copies.empty());
+    TEST_CHECK("a failed pack keeps its ranges dirty", packer.hasDirtyRanges());
+    frame();
+
+    // Random brush edits, packed every frame, keep the mirror in sync
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int32_t> px(0, world.sizeInVoxels(0) - 1), py(0, world.sizeInVoxels(1) - 1),
+                                           pz(0, world.sizeInVoxels(2) - 1);
+    for(uint32_t f = 0; f < 20; ++f)
+    {
+        const int32_t cx = px(gen), cy = py(gen), cz = pz(gen);
+        for(int32_t z = -3; z <= 3; ++z)
+            for(int32_t y = -3; y <= 3; ++y)
+                for(int32_t x = -3; x <= 3; ++x)
+                {
+                    world.setVoxel(cx + x, cy + y, cz + z, f % 2 ? 0u : 0xFF3366CCu);
+                    packer.markVoxel(world, cx + x, cy + y, cz + z);
+                }
+        frame();
+    }
+    TEST_CHECK("the mirror matches the world after brush edits", mirrorMatches(world, mirror));
+}
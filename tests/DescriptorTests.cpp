@@ -0,0 +1,50 @@
+#include "Test.h"
+
+#include "DescriptorAllocator.h"
+#include "GpuTimeline.h"
+
+// Step by step on a hand driven fence: reuse only after the fence, coalescing, growth and transient wrap
+void Test::runDescriptors()
+{
+    using Range = DescriptorAllocator::Range;
+
+    ManualTimeline timeline;
+    DescriptorAllocator allocator(8, 8, timeline);
+
+    const Range a = allocator.allocate(2);
+    const Range b = allocator.allocate(2);
+    const Range c = allocator.allocate(4);
+    TEST_CHECK("first fit packs ranges from 0", a.first == 0 && b.first == 2 && c.first == 4);
+    TEST_CHECK("full persistent region fails", !allocator.allocate(1));
+
+    // Released but still visible to the GPU
+    allocator.release(a);
+    allocator.release(c);
+    allocator.finishFrame(timeline.signal());
+    TEST_CHECK("released ranges wait for their fence", !allocator.allocate(1));
+
+    timeline.complete(1);
+    allocator.reclaim();
+    const DescriptorAllocator::Stats split = allocator.stats();
+    TEST_CHECK("reclaim frees both ranges apart", split.freeBlocks == 2 && split.largestFreeBlock == 4);
+    TEST_CHECK("fragmentation of 2 + 4 free is 1/3", allocator.fragmentation() > 0.3f && allocator.fragmentation() < 0.4f);
+
+    // b in between, once it is back everything merges in one block
+    allocator.release(b);
+    allocator.finishFrame(timeline.signal());
+    timeline.complete(2);
+    allocator.reclaim();
+    TEST_CHECK("neighbours coalesce in one block", allocator.stats().freeBlocks == 1 && allocator.fragmentation() == 0.0f);
+
+    TEST_CHECK("whole region allocates again", allocator.allocate(8).first == 0);
+    allocator.grow(16);
+    TEST_CHECK("grow appends after the old capacity", allocator.allocate(8).first == 8 && allocator.capacity() == 24);
+
+    // Transient ranges live after the persistent region and wrap rather than split a table
+    const Range t0 = allocator.allocateTransient(5);
+    TEST_CHECK("transient ranges follow the persistent region", t0.first == 16);
+    allocator.finishFrame(timeline.signal());
+    const Range t1 = allocator.allocateTransient(5);
+    TEST_CHECK("transient table wraps to the start", t1.first == 16);
+    TEST_CHECK("wrapping onto a live frame waits for its fence", timeline.waits == 1 && allocator.stats().stalls == 1);
+}
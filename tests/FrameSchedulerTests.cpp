@@ -0,0 +1,62 @@
+#include "Test.h"
+
+#include "FrameScheduler.h"
+#include "GpuTimeline.h"
+
+void Test::runFrameScheduler()
+{
+    for(uint32_t framesInFlight = 1; framesInFlight <= FrameScheduler::maxFramesInFlight; ++framesInFlight)
+    {
+        ManualTimeline timeline;
+        FrameScheduler scheduler(timeline, framesInFlight);
+
+        // The first N frames never wait, each one gets the next slot and fence
+        bool slotsRotate = true, fencesIncrease = true;
+        for(uint32_t frame = 0; frame < framesInFlight; ++frame)
+        {
+            slotsRotate &= scheduler.beginFrame() == frame;
+            fencesIncrease &= scheduler.endFrame() == frame + 1;
+        }
+        TEST_CHECK("first frames in flight get slots 0..N-1", slotsRotate);
+        TEST_CHECK("each frame signals the next fence", fencesIncrease);
+        TEST_CHECK("first frames in flight never wait", timeline.waits == 0 && scheduler.stats().stalledFrames == 0);
+
+        // Frame N+1 reuses slot 0 and blocks until frame 1 is done, and only until then
+        TEST_CHECK("frame N+1 reuses slot 0", scheduler.beginFrame() == 0);
+        TEST_CHECK("frame N+1 waits for frame 1", timeline.waits == 1 && timeline.completed == 1);
+        TEST_CHECK("frame N+1 is one stall", scheduler.stats().stalledFrames == 1);
+        scheduler.endFrame();
+
+        // GPU keeps up: completing each frame before its slot comes back never stalls
+        bool noWait = true;
+        for(uint32_t frame = 0; frame < 3 * framesInFlight; ++frame)
+        {
+            timeline.complete(timeline.signaled);
+            noWait &= scheduler.beginFrame() == (framesInFlight + 1 + frame) % framesInFlight;
+            scheduler.endFrame();
+        }
+        TEST_CHECK("slots keep rotating", noWait);
+        TEST_CHECK("completed frames never stall", timeline.waits == 1 && scheduler.stats().stalledFrames == 1);
+
+        // GPU stuck: nothing completes but what a wait completes, so every frame past the ones in flight stalls
+        timeline.complete(timeline.signaled);
+        const uint32_t forced = 5;
+        for(uint32_t frame = 0; frame < framesInFlight + forced; ++frame)
+        {
+            scheduler.beginFrame();
+            scheduler.endFrame();
+        }
+        TEST_CHECK("stalled frames count exactly the forced stalls", scheduler.stats().stalledFrames == 1 + forced);
+        TEST_CHECK("every stall is one wait", timeline.waits == 1 + forced);
+        TEST_CHECK("frame count covers every frame", scheduler.stats().frames == scheduler.frameCount() &&
+                                                     scheduler.frameCount() == 1 + 5 * framesInFlight + forced);
+
+        scheduler.waitIdle();
+        TEST_CHECK("waitIdle completes every frame", timeline.completed == timeline.signaled);
+    }
+
+    ManualTimeline timeline;
+    TEST_CHECK("frames in flight clamp to at least 1", FrameScheduler(timeline, 0).framesInFlight() == 1);
+    TEST_CHECK("frames in flight clamp to the maximum",
+               FrameScheduler(timeline, 9).framesInFlight() == FrameScheduler::maxFramesInFlight);
+}
@@ -0,0 +1,86 @@
+#include "Test.h"
+
+#include <atomic>
+#include <thread>
+
+#include "InputQueue.h"
+
+void Test::runInput()
+{
+    // Order, full ring, wrap around
+    SpscRing<uint32_t, 4> ring;
+    uint32_t value = 0;
+    bool pushed = true;
+    for(uint32_t i = 0; i < 4; ++i)
+        pushed &= ring.push(i);
+    TEST_CHECK("ring takes capacity items", pushed);
+    TEST_CHECK("full ring refuses a push", !ring.push(4) && ring.size() == 4);
+    bool fifo = true;
+    for(uint32_t round = 0; round < 10; ++round)
+    {
+        fifo &= ring.pop(value) && value == round;
+        fifo &= ring.push(round + 4);
+    }
+    TEST_CHECK("ring stays first in first out across wraps", fifo);
+    while (ring.pop(value)) {}
+    TEST_CHECK("drained ring is empty", ring.size() == 0);
+
+    // Coalescing: deltas add up, taps between two ticks are seen, key repeat is not a new press
+    InputQueue queue;
+    queue.pushMouseMove(3, -1);
+    queue.pushMouseMove(4, 2);
+    queue.pushKey(2, true);
+    queue.pushKey(2, true);
+    queue.pushKey(5, true);
+    queue.pushKey(5, false);
+    queue.pushWheel(1);
+    queue.pushWheel(1);
+    queue.pushWheel(-1);
+    FrameInput input = queue.drain();
+    TEST_CHECK("mouse and wheel deltas add up", input.mouseDeltaX == 7 && input.mouseDeltaY == 1 && input.wheelNotches == 1);
+    TEST_CHECK("held key ends held", input.held == (1u << 2));
+    TEST_CHECK("key repeat and tap are one press each", input.pressed == ((1u << 2) | (1u << 5)));
+    TEST_CHECK("tap between ticks is released", input.released == (1u << 5));
+    TEST_CHECK("every event is counted", input.eventCount == 9);
+
+    // Held keys carry over, an idle tick is empty
+    input = queue.drain();
+    TEST_CHECK("held key carries over an idle tick", input.isHeld(2) && input.pressed == 0);
+    TEST_CHECK("idle tick is empty", input.eventCount == 0 && input.mouseDeltaX == 0);
+    queue.pushKey(2, false);
+    input = queue.drain();
+    TEST_CHECK("key up releases a held key", !input.isHeld(2) && input.released == (1u << 2));
+
+    // Overflow drops and counts instead of blocking the window thread
+    for(uint32_t i = 0; i < InputQueue::capacity + 10; ++i)
+        queue.pushMouseMove(1, 0);
+    TEST_CHECK("overflow counts the dropped events", queue.droppedEvents() == 10);
+    TEST_CHECK("overflow keeps the queued events", queue.drain().mouseDeltaX == (int32_t)InputQueue::capacity);
+
+    // Window thread against simulation thread: every delta arrives exactly once or is counted as dropped
+    constexpr uint32_t eventCount = 200000;
+    InputQueue stressed;
+    std::atomic<bool> done{false};
+    std::thread producer([&]
+    {
+        for(uint32_t i = 0; i < eventCount; ++i)
+        {
+            stressed.pushMouseMove(1, 0);
+            if ((i & 255) == 0)
+                std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+    int64_t sumX = 0;
+    while (true)
+    {
+        const bool finished = done.load(std::memory_order_acquire);
+        const FrameInput drained = stressed.drain();
+        sumX += drained.mouseDeltaX;
+        if (finished && drained.eventCount == 0)
+            break;
+        std::this_thread::yield();
+    }
+    producer.join();
+    TEST_CHECK("concurrent deltas arrive once or are dropped", (uint64_t)sumX + stressed.droppedEvents() == eventCount);
+}
@@ -0,0 +1,154 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+
+namespace
+{
+    using Priority = JobSystem::Priority;
+
+    // Keeps the workers busy until released, so the test decides who runs what
+    struct Blocker
+    {
+        std::atomic<uint32_t> started{0};
+        std::atomic<bool> released{false};
+
+        void block(JobSystem& jobs, JobSystem::TaskGroup& group, uint32_t workerCount)
+        {
+            for(uint32_t i = 0; i < workerCount; ++i)
+            {
+                jobs.submit(group, [this]() {
+                    started.fetch_add(1);
+                    while (!released.load())
+                        std::this_thread::yield();
+                });
+            }
+            while (started.load() < workerCount)
+                std::this_thread::yield();
+        }
+    };
+
+    struct OrderLog
+    {
+        std::mutex mutex;
+        std::vector<int> order;
+
+        std::function<void()> record(int id)
+        {
+            return [this, id]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(id);
+            };
+        }
+    };
+}
+
+void Test::runJobSystem()
+{
+    // Own queue: highest priority first, newest first within a priority
+    {
+        JobSystem jobs(1);
+        JobSystem::TaskGroup blocked, group;
+        Blocker blocker;
+        blocker.block(jobs, blocked, 1);
+
+        OrderLog log;
+        jobs.submit(group, log.record(0), Priority::Low);
+        jobs.submit(group, log.record(1), Priority::Normal);
+        jobs.submit(group, log.record(2), Priority::Normal);
+        jobs.submit(group, log.record(3), Priority::High);
+        jobs.wait(group);
+        TEST_CHECK("own queue pops by priority then newest first", log.order == std::vector<int>({3, 2, 1, 0}));
+
+        blocker.released = true;
+        jobs.wait(blocked);
+    }
+
+    // Stolen work: highest priority first, oldest first within a priority, every task counted as a steal
+    {
+        JobSystem jobs(1);
+        JobSystem::TaskGroup blocked, group;
+        Blocker blocker;
+        blocker.block(jobs, blocked, 1);
+        jobs.resetCounters();
+
+        OrderLog log;
+        jobs.submit(group, log.record(0), Priority::Low);
+        jobs.submit(group, log.record(1), Priority::Normal);
+        jobs.submit(group, log.record(2), Priority::Normal);
+        jobs.submit(group, log.record(3), Priority::High);
+        TEST_CHECK("queued tasks are counted", jobs.stats().queueDepth == 4);
+
+        // The main thread does not help, only the worker runs them, stealing from the external queue
+        blocker.released = true;
+        while (group.pending.load() != 0 || blocked.pending.load() != 0)
+            std::this_thread::yield();
+        TEST_CHECK("steals go by priority then oldest first", log.order == std::vector<int>({3, 1, 2, 0}));
+        TEST_CHECK("every stolen task is one steal", jobs.stats().steals == 4);
+        TEST_CHECK("queue depth is back to zero", jobs.stats().queueDepth == 0);
+    }
+
+    // Tasks submitted from a worker land in its own queue, the other workers steal them
+    {
+        JobSystem jobs(4);
+        JobSystem::TaskGroup outer;
+        std::atomic<uint32_t> ran{0};
+        std::atomic<bool> innerDone{false};
+        std::atomic<bool> otherThreadRan{false};
+        jobs.resetCounters();
+
+        jobs.submit(outer, [&]() {
+            const std::thread::id owner = std::this_thread::get_id();
+            JobSystem::TaskGroup inner;
+            for(uint32_t i = 0; i < 256; ++i)
+            {
+                jobs.submit(inner, [&, owner]() {
+                    // Long enough for the idle workers to wake up and steal
+                    const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(50);
+                    while (std::chrono::steady_clock::now() < until) {}
+                    if (std::this_thread::get_id() != owner)
+                        otherThreadRan = true;
+                    ran.fetch_add(1);
+                });
+            }
+            jobs.wait(inner);
+            innerDone = true;
+        });
+
+        // Sampled while the counter moves: it must never wrap below zero
+        uint32_t maxDepth = 0;
+        while (outer.pending.load() != 0)
+            maxDepth = std::max(maxDepth, jobs.stats().queueDepth);
+        jobs.wait(outer);
+
+        const JobSystem::Stats stats = jobs.stats();
+        TEST_CHECK("nested tasks all run", ran == 256 && innerDone);
+        TEST_CHECK("other workers steal from a busy worker", otherThreadRan && stats.steals > 1);
+        TEST_CHECK("queue depth never wraps", maxDepth <= 257);
+        TEST_CHECK("queue depth ends at zero", stats.queueDepth == 0);
+        TEST_CHECK("every task is executed once", stats.executed == 257);
+    }
+
+    // parallelFor covers the range exactly once under contention
+    {
+        JobSystem jobs(3);
+        std::vector<std::atomic<uint32_t>> hits(10000);
+        for(uint32_t round = 0; round < 20; ++round)
+            jobs.parallelFor((uint32_t)hits.size(), 7, [&](uint32_t begin, uint32_t end) {
+                for(uint32_t i = begin; i < end; ++i)
+                    hits[i].fetch_add(1);
+            });
+        bool exact = true;
+        for(const auto& hit : hits)
+            exact &= hit.load() == 20;
+        TEST_CHECK("parallelFor runs every index once per call", exact);
+        TEST_CHECK("queue depth ends at zero after parallelFor", jobs.stats().queueDepth == 0);
+    }
+}
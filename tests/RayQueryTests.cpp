@@ -0,0 +1,89 @@
+#include "Test.h"
+
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "JobSystem.h"
+#include "RayQuery.h"
+#include "VoxelDataStructs.h"
+
+using namespace VoxelDataStructs;
+
+void Test::runRayQuery()
+{
+    JobSystem jobs(2);
+    World world;
+    world.init(2, 1, 2);
+    generateTerrain(world, 1, &jobs);
+
+    // Straight down from above the world always hits the terrain, at the same voxel whatever the direction scale
+    const float top = (float)world.sizeInVoxels(1) + 4.0f;
+    RayQuery::Request down;
+    down.origin = float3(20.5f, top, 20.5f);
+    down.direction = float3(0, -1, 0);
+    down.maxDistance = 1000.0f;
+    RayQuery::Request scaled = down;
+    scaled.direction = float3(0, -4, 0);
+    scaled.maxDistance = 250.0f;
+
+    RayQuery::Request requests[] = {down, scaled};
+    RayQuery::Result results[2];
+    RayQuery::cast(world, requests, results, &jobs);
+    TEST_CHECK("ray down hits the terrain", results[0].hit && results[0].normal.y == 1.0f);
+    TEST_CHECK("scaled direction hits the same voxel", results[1].hit && results[1].voxel.y == results[0].voxel.y);
+    TEST_CHECK("distance is in units of the direction length",
+               std::fabs(results[1].distance * 4.0f - results[0].distance) < 1e-3f);
+
+    // No direction: zero, denormal, underflowing, NaN and infinite lengths all miss
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const float3 degenerate[] = {float3(0, 0, 0), float3(0, -FLT_TRUE_MIN, 0), float3(0, -1e-30f, 0),
+                                 float3(nan, -1, 0), float3(0, -inf, 0)};
+    bool allMiss = true, finite = true;
+    for(const float3& direction : degenerate)
+    {
+        for(uint32_t flags : {(uint32_t)RayQuery::None, (uint32_t)RayQuery::AnyHit, (uint32_t)RayQuery::SkipOriginVoxel})
+        {
+            RayQuery::Request request = down;
+            request.direction = direction;
+            request.flags = flags;
+            RayQuery::Result result;
+            const RayQuery::BatchStats stats = RayQuery::cast(world, {&request, 1}, {&result, 1}, &jobs);
+            allMiss &= !result.hit && stats.hitCount == 0;
+            finite &= std::isfinite(result.distance) && result.distance == 0.0f;
+        }
+    }
+    TEST_CHECK("degenerate directions miss", allMiss);
+    TEST_CHECK("degenerate directions leave a zero distance", finite);
+
+    // Sorting for coherence only changes the order rays run in, never the results
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> gauss;
+    std::vector<RayQuery::Request> batch(2 * RayQuery::minRaysToSort);
+    for(RayQuery::Request& request : batch)
+    {
+        request.origin = float3(unit(gen) * (float)world.sizeInVoxels(0), unit(gen) * (float)world.sizeInVoxels(1),
+                                unit(gen) * (float)world.sizeInVoxels(2));
+        request.direction = float3(gauss(gen), gauss(gen), gauss(gen));
+        request.maxDistance = 64.0f;
+        request.flags = unit(gen) < 0.25f ? RayQuery::AnyHit : RayQuery::None;
+    }
+    std::vector<RayQuery::Result> unsorted(batch.size()), sorted(batch.size());
+    const RayQuery::BatchStats unsortedStats = RayQuery::cast(world, batch, unsorted, &jobs, false);
+    const RayQuery::BatchStats sortedStats = RayQuery::cast(world, batch, sorted, &jobs, true);
+    bool same = true;
+    for(size_t i = 0; i < batch.size(); ++i)
+    {
+        same &= sorted[i].hit == unsorted[i].hit && sorted[i].distance == unsorted[i].distance &&
+                sorted[i].voxel.x == unsorted[i].voxel.x && sorted[i].voxel.y == unsorted[i].voxel.y &&
+                sorted[i].voxel.z == unsorted[i].voxel.z;
+    }
+    TEST_CHECK("sorted batch returns the unsorted results in request order", same);
+    TEST_CHECK("sorted batch counts the same hits and steps",
+               sortedStats.hitCount == unsortedStats.hitCount && sortedStats.traversalSteps == unsortedStats.traversalSteps);
+    TEST_CHECK("batch hits some and misses some", unsortedStats.hitCount > 0 && unsortedStats.hitCount < batch.size());
+}
@@ -0,0 +1,92 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Group
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    const Group groups[] = {
+        {"desc", &Test::runDescriptors},
+        {"shaders", &Test::runShaderCache},
+        {"delta", &Test::runDelta},
+        {"input", &Test::runInput},
+        {"frames", &Test::runFrameScheduler},
+        {"jobs", &Test::runJobSystem},
+        {"rays", &Test::runRayQuery},
+        {"upload", &Test::runUploadRing},
+        {"renderer", &Test::runRenderer},
+    };
+
+    const char* currentGroup = "";
+    uint32_t checkCount = 0;
+    uint32_t failureCount = 0;
+
+    void printUsage()
+    {
+        std::printf("Usage: RayVox_Tests [group ...]\nGroups:");
+        for(const Group& group : groups)
+            std::printf(" %s", group.name);
+        std::printf("\nWithout group every one of them runs. Exits with 1 when a check failed.\n");
+    }
+}
+
+bool Test::check(bool condition, const char* name, const char* file, int line)
+{
+    ++checkCount;
+    if (!condition)
+    {
+        ++failureCount;
+        std::printf("FAILED   %-8s %s (%s:%d)\n", currentGroup, name, file, line);
+    }
+    return condition;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> selected;
+    for(int i = 1; i < argc; ++i)
+    {
+        if (!std::strcmp(argv[i], "--help"))
+        {
+            printUsage();
+            return 0;
+        }
+        if (argv[i][0] == '-')
+        {
+            printUsage();
+            return 1;
+        }
+        selected.emplace_back(argv[i]);
+    }
+
+    bool ranAny = false;
+    for(const Group& group : groups)
+    {
+        bool wanted = selected.empty();
+        for(const std::string& name : selected)
+            wanted |= name == group.name;
+        if (!wanted)
+            continue;
+
+        currentGroup = group.name;
+        const uint32_t checksBefore = checkCount, failuresBefore = failureCount;
+        group.run();
+        std::printf("%-8s %u checks, %u failed\n", group.name, checkCount - checksBefore, failureCount - failuresBefore);
+        ranAny = true;
+    }
+
+    if (!ranAny)
+    {
+        printUsage();
+        return 1;
+    }
+    return failureCount ? 1 : 0;
+}
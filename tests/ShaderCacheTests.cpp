@@ -0,0 +1,111 @@
+#include "Test.h"
+
+#include <fstream>
+
+#include "ShaderCache.h"
+
+namespace
+{
+    // Pretends to compile: the "bytecode" is the source behind a marker
+    class StubCompiler : public ShaderCompiler
+    {
+    public:
+        uint32_t compiles = 0;
+
+        std::string version() const override { return "stub_1"; }
+
+        bool compile(const ShaderDesc& desc, const std::string& source,
+                     std::vector<uint8_t>& bytecode, std::string& errors) override
+        {
+            ++compiles;
+            if (source.find("error") != std::string::npos)
+            {
+                errors = desc.file.string() + ": error";
+                return false;
+            }
+            bytecode.assign({'D', 'X', 'B', 'C'});
+            bytecode.insert(bytecode.end(), source.begin(), source.end());
+            return true;
+        }
+    };
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+}
+
+// Hit, miss and invalidation on every input of the key, against a fresh directory
+void Test::runShaderCache()
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "rayvox_shader_cache_test";
+    std::filesystem::remove_all(directory);
+    const std::filesystem::path shaders = directory / "src";
+    std::filesystem::create_directories(shaders);
+    writeFile(shaders / "Common.hlsli", "float4 shade();\n");
+    const std::string kernel = "#include \"Common.hlsli\"\n[numthreads(8,8,1)] void main() {}\n";
+    writeFile(shaders / "Kernel.hlsl", kernel);
+
+    StubCompiler compiler;
+    ShaderDesc desc;
+    desc.file = shaders / "Kernel.hlsl";
+    desc.target = "cs_5_0";
+
+    std::vector<uint8_t> bytecode;
+    std::string errors;
+    {
+        ShaderCache cache(directory / "cache", compiler);
+        TEST_CHECK("first load compiles", cache.load(desc, bytecode, errors) && compiler.compiles == 1);
+        TEST_CHECK("second load hits", cache.load(desc, bytecode, errors) && compiler.compiles == 1);
+    }
+
+    // Another instance, as after a restart: served from disk
+    ShaderCache cache(directory / "cache", compiler);
+    std::vector<uint8_t> reloaded;
+    TEST_CHECK("restart loads the same bytecode from disk",
+               cache.load(desc, reloaded, errors) && reloaded == bytecode && compiler.compiles == 1);
+
+    // Every part of the key invalidates the entry
+    desc.defines.push_back({"CHUNK_SIZE", "64"});
+    TEST_CHECK("a define changes the key", cache.load(desc, bytecode, errors) && compiler.compiles == 2);
+    desc.entryPoint = "trace";
+    TEST_CHECK("the entry point changes the key", cache.load(desc, bytecode, errors) && compiler.compiles == 3);
+    desc.target = "cs_5_1";
+    TEST_CHECK("the target changes the key", cache.load(desc, bytecode, errors) && compiler.compiles == 4);
+    writeFile(shaders / "Common.hlsli", "float4 shade(float3 p);\n");
+    TEST_CHECK("an included file changes the key", cache.load(desc, bytecode, errors) && compiler.compiles == 5);
+    TEST_CHECK("unchanged sources hit again", cache.load(desc, bytecode, errors) && compiler.compiles == 5);
+
+    // A truncated entry is recompiled rather than handed out
+    std::filesystem::resize_file(cache.entryPath(cache.computeKey(desc)), 10);
+    TEST_CHECK("a truncated entry is recompiled",
+               cache.load(desc, bytecode, errors) && compiler.compiles == 6 && cache.stats().corrupted == 1);
+
+    // Failures are not cached, the error comes back every time
+    writeFile(shaders / "Kernel.hlsl", kernel + "error\n");
+    TEST_CHECK("a compile error is reported", !cache.load(desc, bytecode, errors) && !errors.empty());
+    TEST_CHECK("a compile error is not cached", !cache.load(desc, bytecode, errors) && compiler.compiles == 8);
+
+    ShaderDesc broken = desc;
+    writeFile(shaders / "Broken.hlsl", "#include \"Missing.hlsli\"\n");
+    broken.file = shaders / "Broken.hlsl";
+    TEST_CHECK("a missing include fails before compiling", !cache.load(broken, bytecode, errors) && compiler.compiles == 8);
+
+    // Back to the last good sources, from a new instance
+    writeFile(shaders / "Kernel.hlsl", kernel);
+    ShaderCache restarted(directory / "cache", compiler);
+    TEST_CHECK("the last good entry survives the failures", restarted.load(desc, bytecode, errors) && compiler.compiles == 8);
+
+    // By age: a load keeps an entry whatever instance stored it, unused ones go
+    const std::filesystem::path entry = restarted.entryPath(restarted.computeKey(desc));
+    const auto old = std::filesystem::file_time_type::clock::now() - std::chrono::hours(48);
+    std::filesystem::last_write_time(entry, old);
+    TEST_CHECK("an old entry still hits", restarted.load(desc, bytecode, errors) && compiler.compiles == 8);
+    TEST_CHECK("a hit refreshes the entry time", restarted.pruneOlderThan(std::chrono::hours(24)) == 0);
+    std::filesystem::last_write_time(entry, old);
+    TEST_CHECK("pruneOlderThan removes the old entry", restarted.pruneOlderThan(std::chrono::hours(24)) == 1);
+    TEST_CHECK("a pruned entry is compiled again", restarted.load(desc, bytecode, errors) && compiler.compiles == 9);
+    TEST_CHECK("prune removes the 4 entries this instance did not use", restarted.prune() == 4);
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Shared helpers of RayVox_Tests. A group is one function, each TEST_CHECK in it is one named assertion.
+// A failed check prints the group, its name and its location, and the executable then exits with 1.
+namespace Test
+{
+    bool check(bool condition, const char* name, const char* file, int line);
+
+    void runDescriptors();
+    void runShaderCache();
+    void runDelta();
+    void runInput();
+    void runFrameScheduler();
+    void runJobSystem();
+    void runRayQuery();
+    void runUploadRing();
+    void runRenderer();
+}
+
+#define TEST_CHECK(name, condition) Test::check((condition), name, __FILE__, __LINE__)
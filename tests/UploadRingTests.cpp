@@ -0,0 +1,62 @@
+#include "Test.h"
+
+#include <vector>
+
+#include "GpuTimeline.h"
+#include "UploadRing.h"
+
+// Step by step run on a hand driven fence, the ring must give space back only once the fence passed
+void Test::runUploadRing()
+{
+    std::vector<uint8_t> memory(4096);
+    ManualTimeline timeline;
+    UploadRing ring(memory.data(), memory.size(), timeline);
+
+    bool allocated = true;
+    for(int i = 0; i < 8; ++i)
+        allocated &= (bool)ring.allocate(256);
+    ring.finishFrame(timeline.signal());
+    for(int i = 0; i < 8; ++i)
+        allocated &= (bool)ring.allocate(256);
+    ring.finishFrame(timeline.signal());
+    TEST_CHECK("two frames fill the ring", allocated && ring.usedBytes() == 4096 && timeline.waits == 0);
+
+    // Full, the first frame is still in flight: allocate has to wait for it, and only for it
+    const UploadRing::Allocation afterWait = ring.allocate(256);
+    TEST_CHECK("full ring waits for the oldest frame", afterWait && timeline.waits == 1 && timeline.completed == 1);
+    TEST_CHECK("space of the oldest frame is reused", afterWait.offset == 0 && ring.usedBytes() == 9 * 256);
+    TEST_CHECK("the wait is one stall", ring.stats().stalls == 1 && ring.stats().failures == 0);
+
+    // Bigger than what the open frame leaves: fails, but only after waiting for every frame in flight
+    TEST_CHECK("allocation held back by the open frame fails", !ring.allocate(4096) && ring.stats().failures == 1);
+    TEST_CHECK("failed allocation waited for every frame in flight", timeline.waits == 2 && timeline.completed == 2);
+
+    timeline.complete(2);
+    ring.finishFrame(timeline.signal());
+    timeline.complete(3);
+    ring.reclaim();
+    TEST_CHECK("completed frames are given back", ring.usedBytes() == 0);
+
+    // Wraps instead of splitting an allocation across the end of the buffer, but not over the open frame
+    TEST_CHECK("idle ring allocates from the start", ring.allocate(3000, 8).offset == 0);
+    TEST_CHECK("wrap over the open frame fails", !ring.allocate(2000, 8) && ring.stats().failures == 2);
+
+    // Once that frame is submitted the wrap waits for it and lands at the start
+    ring.finishFrame(timeline.signal());
+    const uint64_t waitsBefore = timeline.waits;
+    const UploadRing::Allocation wrapped = ring.allocate(2000, 8);
+    TEST_CHECK("wrap waits for the frame holding the start", timeline.waits == waitsBefore + 1 && timeline.completed == 4);
+    TEST_CHECK("wrapped allocation starts the buffer", wrapped && wrapped.offset == 0 && wrapped.size == 2000);
+    TEST_CHECK("wrap after an idle restart wastes nothing", ring.stats().wastedBytes == 0 && ring.usedBytes() == 2000);
+
+    // Completed before the wrap: no wait, the skipped end of the buffer counts as waste
+    ring.finishFrame(timeline.signal());
+    timeline.complete(timeline.signaled);
+    TEST_CHECK("next allocation follows the previous one", ring.allocate(1000, 8).offset == 2000);
+    const UploadRing::Allocation noWait = ring.allocate(2000, 8);
+    TEST_CHECK("wrap past completed frames does not wait", noWait.offset == 0 && timeline.waits == waitsBefore + 1);
+    TEST_CHECK("bytes skipped by the wrap are counted", ring.stats().wastedBytes == 4096 - 3000);
+
+    // Never fits
+    TEST_CHECK("empty and oversized allocations fail", !ring.allocate(0) && !ring.allocate(8192) && ring.stats().failures == 4);
+}